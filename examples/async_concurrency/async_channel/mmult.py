@@ -53,12 +53,11 @@ with air.mlir.ir.Context(), Location.unknown():
 
     # async dep
     pipeline = "builtin.module("+",".join([
-        "air-dependency",
-        "air-dependency-schedule-opt",
+        "func.func(air-dependency,air-dependency-schedule-opt)",
         # "air-specialize-dma-broadcast", # Uncomment to lower to specialized channels
         "air-dma-to-channel",
         "canonicalize", "cse",
-        "air-dependency-canonicalize",
+        "func.func(air-dependency-canonicalize)",
         "air-dependency-parse-graph{output-dir=dot_graphs/}"
     ])+')'
     pm = air.mlir.passmanager.PassManager.parse(pipeline)
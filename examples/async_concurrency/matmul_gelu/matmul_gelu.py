@@ -64,10 +64,9 @@ with air.mlir.ir.Context():
         f.write(str(air_module))
 
     pipeline = "builtin.module("+",".join([
-        "air-dependency",
-        "air-dependency-schedule-opt",
+        "func.func(air-dependency,air-dependency-schedule-opt)",
         "air-specialize-dma-broadcast",
-        "air-dependency-canonicalize",
+        "func.func(air-dependency-canonicalize)",
         "air-dependency-parse-graph{output-dir=dot_graphs/}",
     ])+')'
     pm = air.mlir.passmanager.PassManager.parse(pipeline)
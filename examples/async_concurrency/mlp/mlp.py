@@ -71,12 +71,11 @@ with air.mlir.ir.Context():
         f.write(str(air_module))
 
     lowering_pipeline = "builtin.module("+",".join([
-        "air-dependency",
-        "air-dependency-schedule-opt",
+        "func.func(air-dependency,air-dependency-schedule-opt)",
         "air-specialize-dma-broadcast",
         "air-dma-to-channel",
         "canonicalize", "cse",
-        "air-dependency-canonicalize",
+        "func.func(air-dependency-canonicalize)",
         "air-dependency-parse-graph{output-dir=dot_graphs/}",
     ])+')'
     pm = air.mlir.passmanager.PassManager.parse(lowering_pipeline)
@@ -54,17 +54,15 @@ with air.mlir.ir.Context(), Location.unknown():
 
     # generate dependency information for runner
     pipeline = "builtin.module("+",".join([
-        "air-dependency",
-        "air-dependency-schedule-opt",
+        "func.func(air-dependency,air-dependency-schedule-opt)",
         "air-specialize-dma-broadcast",
         "air-dma-to-channel",
         "canonicalize", "cse",
-        "air-dependency-canonicalize",
+        "func.func(air-dependency-canonicalize)",
         "air-dependency-parse-graph{output-dir=dot_graphs/}",
         "canonicalize", "cse",
         "air-place-herds{num-rows=2 num-cols=2 row-anchor=0 col-anchor=0}",
-        "air-label-scf-for-to-ping-pong",
-        "air-ping-pong-transform"
+        "func.func(air-label-scf-for-to-ping-pong,air-ping-pong-transform)"
     ])+')'
     pm = air.mlir.passmanager.PassManager.parse(pipeline)
     pm.run(air_module)
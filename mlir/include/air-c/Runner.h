@@ -10,6 +10,7 @@
 #define AIR_C_RUNNER_H
 
 #include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
 
 #include <string>
 
@@ -21,6 +22,109 @@ void airRunnerRun(MlirModule module, const char *json_file_name,
                   const char *output_file_name, const char *function,
                   const char *sim_granularity, bool verbose);
 
+//===---------------------------------------------------------------------===//
+// Simulation results
+//===---------------------------------------------------------------------===//
+
+// Summary of a simulation, owned by the caller
+typedef struct AirRunnerResults {
+  void *ptr;
+} AirRunnerResults;
+
+// Cycles during which the instances of an air.launch, air.segment or air.herd
+// ran. Strings are owned by the results.
+typedef struct AirRunnerSpan {
+  MlirStringRef name;
+  MlirStringRef kind;
+  int64_t id;
+  uint64_t instances;
+  uint64_t start;
+  uint64_t end;
+} AirRunnerSpan;
+
+// Cycles during which a du, tile or port of the device was reserved
+typedef struct AirRunnerResourceUsage {
+  MlirStringRef name;
+  MlirStringRef kind;
+  uint64_t busy_cycles;
+} AirRunnerResourceUsage;
+
+// Cycles that the channel ops of an air.channel symbol stalled
+typedef struct AirRunnerChannelStall {
+  MlirStringRef name;
+  uint64_t ops;
+  uint64_t stall_cycles;
+} AirRunnerChannelStall;
+
+// Simulate a function against the json architecture model given as a string.
+// The trace is written to `output_file_name`, unless it is null or empty.
+// Returns null results if the model or function cannot be found.
+AirRunnerResults airRunnerSimulate(MlirModule module, MlirStringRef json_model,
+                                   const char *output_file_name,
+                                   const char *function,
+                                   const char *sim_granularity, bool verbose);
+
+void airRunnerResultsDestroy(AirRunnerResults results);
+
+static inline bool airRunnerResultsIsNull(AirRunnerResults results) {
+  return !results.ptr;
+}
+
+uint64_t airRunnerResultsGetCycles(AirRunnerResults results);
+double airRunnerResultsGetLatencyUs(AirRunnerResults results);
+double airRunnerResultsGetDuUtilization(AirRunnerResults results);
+double airRunnerResultsGetTileUtilization(AirRunnerResults results);
+
+intptr_t airRunnerResultsGetNumSpans(AirRunnerResults results);
+AirRunnerSpan airRunnerResultsGetSpan(AirRunnerResults results, intptr_t pos);
+
+intptr_t airRunnerResultsGetNumResources(AirRunnerResults results);
+AirRunnerResourceUsage airRunnerResultsGetResource(AirRunnerResults results,
+                                                   intptr_t pos);
+
+intptr_t airRunnerResultsGetNumChannels(AirRunnerResults results);
+AirRunnerChannelStall airRunnerResultsGetChannel(AirRunnerResults results,
+                                                 intptr_t pos);
+
+// Print the full json report of the results, including data movement, memory
+// footprints and critical paths, through a callback
+void airRunnerResultsPrintReport(AirRunnerResults results,
+                                 MlirStringCallback callback, void *user_data);
+
+//===---------------------------------------------------------------------===//
+// Incremental simulation
+//===---------------------------------------------------------------------===//
+
+// A function whose dependency graphs are parsed once, and a runner simulating
+// it against a json model, owned by the caller. After the function is edited,
+// the next simulation only re-simulates the air.launch ops which changed.
+typedef struct AirRunnerSession {
+  void *ptr;
+} AirRunnerSession;
+
+// Parse a function of a module for simulation against the json architecture
+// model given as a string. Returns a null session if the model or function
+// cannot be found.
+AirRunnerSession airRunnerSessionCreate(MlirModule module,
+                                        MlirStringRef json_model,
+                                        const char *function,
+                                        const char *sim_granularity);
+
+void airRunnerSessionDestroy(AirRunnerSession session);
+
+static inline bool airRunnerSessionIsNull(AirRunnerSession session) {
+  return !session.ptr;
+}
+
+// Mark the air.launch ops containing the given ops as changed, after editing
+// the function. Pass the parent of any erased op.
+void airRunnerSessionInvalidate(AirRunnerSession session, intptr_t num_ops,
+                                MlirOperation *changed_ops);
+
+// Simulate the function, replaying the launches which did not change since
+// the last simulation
+AirRunnerResults airRunnerSessionSimulate(AirRunnerSession session);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "air/Dialect/AIR/AIRDialect.h"
+#include "air/Util/TransitiveReduction.h"
 #include "air/Util/Util.h"
 
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
@@ -24,6 +25,7 @@
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Transforms/RegionUtils.h"
 
+#include <memory>
 #include <numeric>
 #include <string>
 
@@ -33,7 +35,6 @@
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/graphviz.hpp>
 #include <boost/graph/subgraph.hpp>
-#include <boost/graph/transitive_reduction.hpp>
 
 using namespace mlir;
 
@@ -45,6 +46,12 @@ namespace air {
 //===----------------------------------------------------------------------===//
 
 bool areEqualIndices(mlir::Value index_0, mlir::Value index_1);
+bool areDisjointMemrefRegions(ArrayRef<Value> offsets_0,
+                              ArrayRef<Value> sizes_0,
+                              ArrayRef<Value> strides_0,
+                              ArrayRef<Value> offsets_1,
+                              ArrayRef<Value> sizes_1,
+                              ArrayRef<Value> strides_1);
 void traceDependentInductionVar(air::DmaMemcpyInterface async_op,
                                 SmallVector<Value, 1> &loop_dep_history,
                                 std::vector<Operation *> &op_history);
@@ -72,44 +79,71 @@ struct dependencyNodeEntry;
 struct dependencyGraph;
 class runnerNode;
 
+// Kind of async event represented by a dependency graph vertex
+enum class dependencyEventType : uint8_t {
+  Unknown = 0,
+  Start,
+  Dma,
+  Channel,
+  Hierarchy,
+  HierarchyTerminator,
+  Terminator,
+  ForLoop,
+  ParallelLoop,
+  Execute,
+  WaitAll,
+};
+
+std::string stringifyDependencyEventType(dependencyEventType type);
+dependencyEventType symbolizeDependencyEventType(llvm::StringRef type);
+
+// Visualization category of a vertex; GraphViz color and shape are derived
+// from it only when dumping dot files
+enum class dependencyNodeCategory : uint8_t {
+  None = 0,
+  Hierarchy,
+  Control,
+  Data,
+  Compute,
+};
+
+// Vertex names and descriptions repeat heavily across graphs, so vertices only
+// hold ids into a process-wide string pool
+unsigned internDependencyString(llvm::StringRef str);
+const std::string &getInternedDependencyString(unsigned id);
+
 // GraphViz node properties for visualization
 struct graphNodeProperties {
-  std::string color;
-  std::string shape;
+  dependencyNodeCategory category;
   std::string detailed_description;
 
-  graphNodeProperties(std::string color, std::string shape,
-                      std::string detailed_description)
-      : color(color), shape(shape), detailed_description(detailed_description) {
-  }
+  graphNodeProperties(dependencyNodeCategory category,
+                      std::string detailed_description = "")
+      : category(category), detailed_description(detailed_description) {}
   graphNodeProperties(std::string nodeType, std::string details = "") {
     detailed_description = details;
-    if (nodeType == "hierarchy") {
-      color = "yellow";
-      shape = "box";
-    } else if (nodeType == "control") {
-      color = "crimson";
-      shape = "box";
-    } else if (nodeType == "data") {
-      color = "cyan";
-      shape = "oval";
-    } else if (nodeType == "compute") {
-      color = "chartreuse";
-      shape = "oval";
-    } else {
-      color = "";
-      shape = "";
-    }
+    if (nodeType == "hierarchy")
+      category = dependencyNodeCategory::Hierarchy;
+    else if (nodeType == "control")
+      category = dependencyNodeCategory::Control;
+    else if (nodeType == "data")
+      category = dependencyNodeCategory::Data;
+    else if (nodeType == "compute")
+      category = dependencyNodeCategory::Compute;
+    else
+      category = dependencyNodeCategory::None;
   }
+
+  static std::string getColor(dependencyNodeCategory category);
+  static std::string getShape(dependencyNodeCategory category);
 };
 
 // Node entry for dependency graph
 struct dependencyNodeEntry {
-  std::string asyncEventName;
-  std::string asyncEventType;
-  std::string color;
-  std::string shape;
-  std::string detailed_description;
+  dependencyEventType asyncEventType;
+  dependencyNodeCategory category;
+  unsigned asyncEventNameId;
+  unsigned detailedDescriptionId;
   unsigned operationId;
   mlir::Operation *op;
   std::vector<dependencyGraph *> nextDependencyGraphs;
@@ -123,17 +157,31 @@ struct dependencyNodeEntry {
   bool is_started() { return (start_time != 0) && (end_time != 0); }
   bool is_done(uint64_t t) { return t >= end_time; }
 
-  dependencyNodeEntry(std::string asyncEventName = "",
-                      std::string asyncEventType = "", std::string color = "",
-                      std::string shape = "",
-                      std::string detailed_description = "",
-                      unsigned operationId = 0, mlir::Operation *op = nullptr,
-                      uint64_t start_time = 0, uint64_t end_time = 0,
-                      int token_count = 0)
-      : asyncEventName(asyncEventName), asyncEventType(asyncEventType),
-        color(color), shape(shape), detailed_description(detailed_description),
-        operationId(operationId), op(op), start_time(start_time),
-        end_time(end_time), token_count(token_count) {}
+  const std::string &getAsyncEventName() const {
+    return getInternedDependencyString(asyncEventNameId);
+  }
+  void setAsyncEventName(llvm::StringRef name) {
+    asyncEventNameId = internDependencyString(name);
+  }
+  const std::string &getDetailedDescription() const {
+    return getInternedDependencyString(detailedDescriptionId);
+  }
+  void setDetailedDescription(llvm::StringRef description) {
+    detailedDescriptionId = internDependencyString(description);
+  }
+
+  // Id 0 is always the empty string in the pool
+  dependencyNodeEntry(
+      dependencyEventType asyncEventType = dependencyEventType::Unknown,
+      dependencyNodeCategory category = dependencyNodeCategory::None,
+      unsigned asyncEventNameId = 0, unsigned detailedDescriptionId = 0,
+      unsigned operationId = 0, mlir::Operation *op = nullptr,
+      uint64_t start_time = 0, uint64_t end_time = 0, int token_count = 0)
+      : asyncEventType(asyncEventType), category(category),
+        asyncEventNameId(asyncEventNameId),
+        detailedDescriptionId(detailedDescriptionId), operationId(operationId),
+        op(op), start_time(start_time), end_time(end_time),
+        token_count(token_count) {}
 };
 
 // Boost dependency graph
@@ -154,16 +202,18 @@ struct dependencyGraph {
   Graph::vertex_descriptor terminator_vertex;
   std::vector<unsigned>
       position; // Position (coordinates) of each core in herd, if showing cores
+  // Positions of the other cores of the herd which are symmetric to this one,
+  // and whose simulation is folded into this core's, if folding cores
+  std::vector<std::vector<unsigned>> folded_positions;
 
   dependencyGraph(mlir::Operation *op = nullptr, bool initStartVertex = false) {
     g = Graph();
     hierarchyOp = op;
     if (initStartVertex) {
       auto v = add_vertex(g);
-      g[v].asyncEventType = "start";
-      g[v].asyncEventName = "start";
-      g[v].color = "yellow";
-      g[v].shape = "box";
+      g[v].asyncEventType = dependencyEventType::Start;
+      g[v].setAsyncEventName("start");
+      g[v].category = dependencyNodeCategory::Hierarchy;
       start_vertex = v;
     }
   }
@@ -172,6 +222,7 @@ struct dependencyGraph {
     g.clear();
     subgraphs.clear();
     position.clear();
+    folded_positions.clear();
   }
 };
 
@@ -182,6 +233,7 @@ typedef std::map<std::pair<std::string, unsigned>, dependencyGraph *>
     operation_to_graph_map;
 typedef std::map<Graph::vertex_descriptor, Graph::vertex_descriptor>
     vertex_to_vertex_map;
+typedef std::map<dependencyGraph *, dependencyGraph *> graph_to_graph_map;
 
 struct vertex_to_vertex_map_tree {
   vertex_to_vertex_map a_to_b;
@@ -202,6 +254,8 @@ struct dependencyContext {
   uint64_t TerminatorID;
   operation_to_vertex_map op_to_v;
   operation_to_graph_map op_to_g;
+  // Channel declarations, puts and gets of the module whose graphs are parsed
+  std::shared_ptr<ChannelSymbolUses> channel_uses;
 
   dependencyContext()
       : ExecuteOpID(0), DmaOpID(0), ChannelOpID(0), HierarchyOpID(0),
@@ -233,13 +287,22 @@ typedef std::map<std::string,
 
 class dependencyCanonicalizer {
 
-  typedef std::tuple<bool, bool, bool, bool> graphGranularityProperties;
+  typedef std::tuple<bool, bool, bool, bool, bool> graphGranularityProperties;
 
 public:
   void parseCommandGraphs(func::FuncOp &toplevel, dependencyGraph &global_graph,
                           dependencyContext &dep_ctx,
                           std::string granularity = "herd",
-                          bool dump_dot = false, std::string dump_dir = "");
+                          bool dump_dot = false, std::string dump_dir = "",
+                          bool fold_cores = false);
+  // Rebuild the graph of `launch` in place after ops under it were edited,
+  // keeping the host graph and the graphs of the other launches. The channel
+  // index of `dep_ctx` must be up to date. Returns false if `global_graph` has
+  // no graph for `launch`.
+  bool reparseLaunchGraph(air::LaunchOp launch, dependencyGraph &global_graph,
+                          dependencyContext &dep_ctx,
+                          std::string granularity = "herd",
+                          bool fold_cores = false);
   void canonicalizeGraphs(dependencyGraph &global_graph,
                           dependencyGraph &tr_graph,
                           vertex_to_vertex_map_tree &g_to_tr,
@@ -248,15 +311,16 @@ public:
   void removeDepListRepetition(func::FuncOp func);
   void removeUnusedExecuteOp(func::FuncOp func);
   void removeRedundantWaitAllOps(func::FuncOp func);
-  void dumpDotGraphFiles(dependencyGraph global_graph,
+  void dumpDotGraphFiles(dependencyGraph &global_graph,
                          std::string dump_dir = "");
+  void copyDependencyGraph(dependencyGraph &src, dependencyGraph &dst);
   void copyDependencyGraphToFlatGraphAndVisualize(func::FuncOp &toplevel,
                                                   dependencyGraph &global_graph,
                                                   dependencyContext &dep_ctx,
                                                   bool dump_dot = false,
                                                   std::string dump_dir = "");
   std::pair<Graph::vertex_descriptor, dependencyGraph *>
-  getVertexFromOp(Operation *op, dependencyContext dep_ctx,
+  getVertexFromOp(Operation *op, dependencyContext &dep_ctx,
                   std::string front_or_back = "front");
   // CDFG show cores in herd
   unsigned getTripCountInHierarchyOp(air::HierarchyInterface hier);
@@ -266,20 +330,28 @@ public:
   unsigned getIteratorFromPosition(std::vector<unsigned> position,
                                    Operation *hier_op);
   void redoDepTraceIfDepOnHier(func::FuncOp func);
+  std::vector<std::vector<unsigned>> getSymmetricCoreClasses(air::HerdOp herd);
 
 private:
+  LogicalResult getGraphGranularity(Operation *op, std::string granularity,
+                                    bool fold_cores,
+                                    graphGranularityProperties &expandHier);
   void addVerticesInHerd(std::deque<dependencyGraph> &herd_subgraphs,
                          air::HerdOp herd, dependencyContext &dep_ctx,
-                         graphGranularityProperties expandHier = {true, true,
-                                                                  true, false});
+                         graphGranularityProperties expandHier = {
+                             true, true, true, false, false});
   void addVerticesInSegment(std::deque<dependencyGraph> &part_subgraphs,
                             air::SegmentOp segment, dependencyContext &dep_ctx,
                             graphGranularityProperties expandHier = {
-                                true, true, true, false});
+                                true, true, true, false, false});
   void addVerticesInLaunch(std::deque<dependencyGraph> &launch_subgraphs,
                            air::LaunchOp launch, dependencyContext &dep_ctx,
                            graphGranularityProperties expandHier = {
-                               true, true, true, false});
+                               true, true, true, false, false});
+  void addVerticesInLaunchGraph(dependencyGraph *launch_graph,
+                                air::LaunchOp launch,
+                                dependencyContext &dep_ctx,
+                                graphGranularityProperties expandHier);
   Graph::vertex_descriptor addVertexFromOpImpls(Operation *op,
                                                 dependencyGraph *G,
                                                 dependencyContext &dep_ctx);
@@ -311,44 +383,50 @@ private:
                                                   dependencyContext &dep_ctx);
   std::pair<std::string, unsigned> getTypeIdPairFromOp(Operation *op);
   std::string getOpTypeFromOpImpls(Operation *op);
-  void parseDependencyEdgesInGraph(Graph &g, dependencyContext dep_ctx);
-  void copyFromDependencyGraphToFlatGraph(Graph g_src,
+  void parseDependencyEdgesInGraph(Graph &g, dependencyContext &dep_ctx);
+  void copyFromDependencyGraphToFlatGraph(Graph &g_src,
                                           std::vector<unsigned> position,
                                           FlatGraph &g_dst,
                                           vertex_to_flat_vertex_map &map,
                                           bool copyEdges = false);
-  void updateSubgraphFromDependencyGraph(Graph subg_src,
+  void updateSubgraphFromDependencyGraph(Graph &subg_src,
                                          std::vector<unsigned> position,
                                          FlatGraph &subg_dst,
-                                         vertex_to_flat_vertex_map map,
+                                         vertex_to_flat_vertex_map &map,
                                          bool copyEdges = false);
   void connectOpToItsDepListImpls(Operation *op, Graph &g,
-                                  dependencyContext dep_ctx);
-  void connectOpToItsDepList(Operation *op, SmallVector<Value, 1> dep_list,
-                             Graph &g, dependencyContext dep_ctx);
+                                  dependencyContext &dep_ctx);
+  void connectOpToItsDepList(Operation *op, SmallVector<Value, 1> &dep_list,
+                             Graph &g, dependencyContext &dep_ctx);
   std::vector<Operation *> traceOpFromToken(Operation *op, Value dep_token);
   void connectTerminatorInGraph(Graph &g);
+  void connectHierarchyGraph(dependencyGraph &parent, dependencyGraph &G,
+                             dependencyContext &dep_ctx);
   void connectStartNodeInCommandGraph(dependencyGraph &G);
   void updatePointerFromGraphToHierarchyTerminator(dependencyGraph &G);
   void updatePointerFromHierarchyTerminatorToGraph(dependencyGraph &G,
                                                    dependencyGraph &subG);
   void updatePointerFromHierarchyOpToGraph(dependencyGraph &G);
-  void dump_graph(std::string filename, Graph G);
+  void copyDependencyGraphImpl(dependencyGraph &src, dependencyGraph &dst,
+                               graph_to_graph_map &graph_map);
+  void redirectPointersBetweenGraphs(dependencyGraph &G,
+                                     graph_to_graph_map &graph_map);
+  void dump_graph(std::string filename, Graph &G);
   void boostTransitiveReductionImpl(Graph &asyncExecuteGraph,
                                     Graph &asyncExecuteGraphTR,
                                     vertex_to_vertex_map &g_to_tr,
                                     vertex_to_vertex_map &tr_to_g);
   void purgeAIRDepList(dependencyGraph &graph);
   void fillAIRDepListUsingGraphTR(dependencyGraph &graph);
-  void collectAIRChannelPutAndGetInGraph(Graph g,
+  void collectAIRChannelPutAndGetInGraph(Graph &g,
                                          std::vector<unsigned> position,
-                                         vertex_to_flat_vertex_map map,
+                                         vertex_to_flat_vertex_map &map,
                                          ChannelMap &channel_map);
   void updateSubgraphFromDependencyGraphAsGraphVizCluster(
       dependencyGraph &G, FlatGraph &flat_subg, vertex_to_flat_vertex_map map,
       unsigned global_idx, unsigned &subg_idx, std::string hier_name = "");
   std::vector<Graph::vertex_descriptor>
-  getVerticesWithAffineIf(Graph g, std::vector<unsigned> position);
+  getVerticesWithAffineIf(Graph &g, std::vector<unsigned> position);
 };
 
 //===----------------------------------------------------------------------===//
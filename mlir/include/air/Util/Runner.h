@@ -9,25 +9,236 @@
 #ifndef AIR_UTIL_RUNNER_H
 #define AIR_UTIL_RUNNER_H
 
+#include "air/Util/CostModel.h"
 #include "air/Util/Dependency.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/JSON.h"
 
 namespace xilinx {
 namespace air {
 
+// Dependency graphs of a function, canonicalized once so that the same program
+// can be simulated against several architecture models. A runner which
+// simulates the program again only re-simulates the air.launch ops which
+// changed since its last simulation.
+struct AIRRunnerProgram {
+
+  AIRRunnerProgram(mlir::func::FuncOp &toplevel,
+                   std::string sim_granularity = "herd",
+                   bool fold_cores = false);
+
+  // Update the dependency graphs after the function was edited. The
+  // air.launch ops containing any of `changed_ops`, or any op which differs
+  // from when they were last parsed, are marked as changed and only their
+  // graphs are rebuilt; pass the parent of any erased op. Edits outside of
+  // the launches rebuild all graphs and mark every launch as changed.
+  void invalidate(llvm::ArrayRef<mlir::Operation *> changed_ops);
+
+  mlir::func::FuncOp toplevel;
+  std::string sim_granularity;
+  // Simulate one core per class of symmetric cores in each herd, if
+  // simulating cores
+  bool fold_cores;
+  dependencyGraph hostGraph;
+  dependencyContext dep_ctx;
+  // Version of each air.launch, renewed whenever it changes. Versions are
+  // unique across programs, and runners cache launches by version.
+  std::map<mlir::Operation *, uint64_t> launch_versions;
+  // Hash of the ops of each air.launch, and of the ops outside of the
+  // hierarchy ops, as last parsed. An op allocated at the address of an
+  // erased one hashes differently, so it is not mistaken for it.
+  std::map<mlir::Operation *, llvm::hash_code> launch_fingerprints;
+  llvm::hash_code host_fingerprint = 0;
+  // Op counts of the linalg op of each air.execute. Counting builds IR, so
+  // it is done once here and read by every runner simulating the program.
+  std::map<mlir::Operation *, CostModel::OpCountMap> op_counts;
+};
+
+// Count the ops of the linalg op of each air.execute under `root`
+void countExecuteLinalgOps(
+    mlir::Operation *root,
+    std::map<mlir::Operation *, CostModel::OpCountMap> &op_counts);
+
+// Cycles during which a du, tile or port of the device was reserved
+struct AIRRunnerResourceUsage {
+  // Path of the resource in the device, e.g. "du[0]/tile[1]/L1_inbound_0"
+  std::string name;
+  // One of "du", "tile" or "port"
+  std::string kind;
+  uint64_t busy_cycles = 0;
+};
+
+// Cycles during which the instances of an air.launch, air.segment or air.herd
+// ran, from the start of the op to the end of its terminator
+struct AIRRunnerSpan {
+  std::string name;
+  // One of "launch", "segment" or "herd"
+  std::string kind;
+  int64_t id = 0;
+  // Number of times the op ran, e.g. once per launch iteration
+  uint64_t instances = 0;
+  // Start of the first instance and end of the last
+  uint64_t start = 0;
+  uint64_t end = 0;
+};
+
+// Cycles that the channel ops of an air.channel symbol spent waiting for
+// their counterpart or for ports, after their ssa dependencies were met
+struct AIRRunnerChannelStall {
+  std::string name;
+  uint64_t ops = 0;
+  uint64_t stall_cycles = 0;
+};
+
+// Occupancy of the FIFO of an air.channel symbol over a simulation, counting
+// buffered transfers and the transfer whose puts are in progress
+struct AIRRunnerChannelOccupancy {
+  std::string name;
+  unsigned depth = 1;
+  unsigned peak = 0;
+  // Cycles spent at each occupancy, in increasing order of occupancy
+  std::vector<std::pair<unsigned, uint64_t>> cycles;
+};
+
+// Footprint changes of a memory which repeat periodically, e.g. over the
+// iterations of an air.launch past its steady state. The timeline entries from
+// `begin` up to `end` recur `count` more times, each `period` cycles after the
+// previous occurrence.
+struct AIRRunnerFootprintRepeat {
+  uint64_t begin = 0;
+  uint64_t end = 0;
+  uint64_t period = 0;
+  uint64_t count = 0;
+};
+
+// Footprint of an L2 or L1 memory over a simulation
+struct AIRRunnerMemoryUsage {
+  // Path of the memory in the device, e.g. "du[0]/tile[1]/L1"
+  std::string name;
+  std::string memory_space;
+  double capacity_bytes = 0;
+  double peak_bytes = 0;
+  // Live bytes from each simulated time stamp at which they changed
+  std::vector<std::pair<uint64_t, double>> timeline;
+  // Repeats of parts of the timeline, which are not copied into it
+  std::vector<AIRRunnerFootprintRepeat> repeats;
+};
+
+// Cycles that allocations in a memory space waited for memory to be freed
+struct AIRRunnerAllocationStall {
+  std::string memory_space;
+  uint64_t allocs = 0;
+  uint64_t stall_cycles = 0;
+};
+
+// Bytes moved by the simulated data movement ops between two memory spaces
+struct AIRRunnerTransfer {
+  std::string src;
+  std::string dst;
+  double bytes = 0;
+};
+
+// Cycles taken by the data movement or compute ops of the same name, e.g.
+// "LinalgOp(linalg.matmul)"
+struct AIRRunnerOpCycles {
+  std::string name;
+  uint64_t instances = 0;
+  // Cycles summed over the instances
+  uint64_t cycles = 0;
+};
+
+// An op on the critical path of a launch
+struct AIRRunnerCriticalPathOp {
+  std::string name;
+  // Id of the air.launch, air.segment or air.herd running the op
+  int64_t runner = 0;
+  uint64_t start = 0;
+  uint64_t end = 0;
+};
+
+// Chain of ops which determined the latency of the last simulated iteration
+// of an air.launch, each op being started by the last dependency to finish
+struct AIRRunnerCriticalPath {
+  std::string launch;
+  uint64_t cycles = 0;
+  std::vector<AIRRunnerCriticalPathOp> ops;
+};
+
+// Iterations of an air.launch which were simulated, and which were
+// extrapolated past a periodic steady state reached by the simulated ones
+struct AIRRunnerLaunchIterations {
+  std::string name;
+  int64_t id = 0;
+  uint64_t iterations = 0;
+  uint64_t simulated_iterations = 0;
+  uint64_t fast_forwarded_iterations = 0;
+  // Cycles taken by each extrapolated iteration, or 0 if the launch never
+  // reached a steady state
+  uint64_t period_cycles = 0;
+  // Whether the launch was replayed from its last simulation, since it did
+  // not change, rather than simulated
+  bool replayed = false;
+};
+
+// Work done by the runner to simulate a program, which is independent of the
+// machine running the simulation
+struct AIRRunnerSimulationStats {
+  // Lookups of the cost of a linalg op which found it in the cost cache, and
+  // which modelled it
+  uint64_t compute_cost_hits = 0;
+  uint64_t compute_cost_misses = 0;
+  // Events started by the scheduler, and vertices and edges of the dependency
+  // graphs looked at while gathering candidate events. Their ratio stays flat
+  // as long as scheduling time grows linearly with the number of events.
+  uint64_t events = 0;
+  uint64_t vertex_visits = 0;
+  std::vector<AIRRunnerLaunchIterations> launches;
+};
+
+// Summary of a simulation
+struct AIRRunnerResults {
+  // End-to-end latency
+  uint64_t cycles = 0;
+  double latency_us = 0;
+  // Fraction of the device's dus and tiles reserved by air.segment and
+  // air.herd, averaged over the simulated time
+  double du_utilization = 0;
+  double tile_utilization = 0;
+  std::vector<AIRRunnerSpan> spans;
+  std::vector<AIRRunnerResourceUsage> resources;
+  std::vector<AIRRunnerChannelStall> channels;
+  std::vector<AIRRunnerChannelOccupancy> channel_occupancy;
+  std::vector<AIRRunnerTransfer> transfers;
+  std::vector<AIRRunnerMemoryUsage> memories;
+  std::vector<AIRRunnerAllocationStall> allocation_stalls;
+  std::vector<AIRRunnerOpCycles> ops;
+  std::vector<AIRRunnerCriticalPath> critical_paths;
+  AIRRunnerSimulationStats simulation;
+};
+
+// Write the utilization, channel stall, data movement, memory footprint, op
+// cycles, critical path and simulation work report of a simulation as json
+void writeRunnerReport(llvm::raw_ostream &os, const AIRRunnerResults &results);
+
 struct AIRRunner {
 
   AIRRunner(llvm::raw_ostream &trace_stream, llvm::json::Value &json_model,
-            std::string sim_granularity = "herd", bool verbose = false);
+            std::string sim_granularity = "herd", bool verbose = false,
+            bool full_simulation = false, bool parallel_segments = false,
+            std::string trace_format = "json", std::string trace_level = "all",
+            bool fold_cores = false);
   ~AIRRunner();
 
   void emitTraceStart(llvm::raw_ostream &s);
   void emitTraceEnd(llvm::raw_ostream &s);
 
   void scheduleFunction(mlir::func::FuncOp &toplevel);
+  void scheduleFunction(AIRRunnerProgram &program);
+
+  const AIRRunnerResults &getResults();
 
 private:
   class AIRRunner_impl;
@@ -44,7 +255,6 @@ std::string to_string(mlir::Type t);
 std::string getElementTypeAsString(const mlir::Type ty);
 std::string lookUpMemorySpaceFromInt(unsigned memory_space);
 unsigned lookUpMemorySpaceIntFromString(std::string memory_space);
-template <typename T> void push_back_if_unique(std::vector<T> &vec, T entry);
 
 } // namespace air
 } // namespace xilinx
@@ -0,0 +1,150 @@
+//===- TransitiveReduction.h ------------------------------------*- C++ -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+//===- TransitiveReduction.h - Transitive reduction of async DAGs ---------===//
+//
+// Drop-in replacement for boost::transitive_reduction on the dependency graphs
+// of async ops. boost::transitive_reduction keeps a dense V x V closure matrix
+// and scans every vertex for each vertex, which does not scale past tens of
+// thousands of vertices. Here, reachability is computed in topological order,
+// for one chunk of target vertices at a time, so that memory stays within a
+// budget and only the vertices between a chunk and its earliest predecessor are
+// visited for it.
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/topological_sort.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace xilinx {
+namespace air {
+
+// Default memory budget of the reachability bitsets, in bytes
+constexpr size_t defaultTransitiveReductionBudget = 64 << 20;
+
+// Transitive reduction of a directed acyclic graph `g` with vecS vertex
+// storage. Vertices are added to `tr` and edges are kept in the same order as
+// boost::transitive_reduction, and `g_to_tr` maps the vertices of `g` to
+// those of `tr`. Vertex properties are left to the caller.
+template <typename Graph, typename GraphTR, typename VertexMap>
+void transitiveReduction(
+    const Graph &g, GraphTR &tr, VertexMap &g_to_tr,
+    size_t memory_budget = defaultTransitiveReductionBudget) {
+  typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex;
+  const size_t num_verts = num_vertices(g);
+  if (num_verts == 0)
+    return;
+
+  // Topological order; position 0 is a source
+  std::vector<vertex> topo_order;
+  topo_order.reserve(num_verts);
+  boost::topological_sort(g, std::back_inserter(topo_order));
+  std::reverse(topo_order.begin(), topo_order.end());
+  std::vector<size_t> pos(num_verts);
+  for (size_t i = 0; i < num_verts; i++)
+    pos[topo_order[i]] = i;
+  for (auto v : topo_order)
+    g_to_tr[v] = add_vertex(tr);
+
+  // Distinct successors of each vertex, by position and in ascending order.
+  // Successors are kept as a flat list indexed by `succ_begin`.
+  std::vector<size_t> succ_begin(num_verts + 1, 0);
+  std::vector<size_t> succ;
+  for (size_t i = 0; i < num_verts; i++) {
+    succ_begin[i] = succ.size();
+    typename boost::graph_traits<Graph>::out_edge_iterator oi, oi_end;
+    for (boost::tie(oi, oi_end) = out_edges(topo_order[i], g); oi != oi_end;
+         ++oi)
+      succ.push_back(pos[target(*oi, g)]);
+    std::sort(succ.begin() + succ_begin[i], succ.end());
+    succ.erase(std::unique(succ.begin() + succ_begin[i], succ.end()),
+               succ.end());
+  }
+  succ_begin[num_verts] = succ.size();
+  std::vector<bool> redundant(succ.size(), false);
+
+  // Furthest position reachable from each vertex; vertices ending before a
+  // chunk cannot reach it
+  std::vector<size_t> max_reach(num_verts);
+  for (size_t i = num_verts; i-- > 0;) {
+    max_reach[i] = i;
+    for (size_t e = succ_begin[i]; e < succ_begin[i + 1]; e++)
+      max_reach[i] = std::max(max_reach[i], max_reach[succ[e]]);
+  }
+  // Earliest predecessor of each vertex. Only the vertices from the earliest
+  // predecessor of a chunk onwards have edges into it to decide, and their
+  // reachability only depends on later vertices.
+  std::vector<size_t> min_pred(num_verts);
+  std::iota(min_pred.begin(), min_pred.end(), 0);
+  for (size_t i = 0; i < num_verts; i++)
+    for (size_t e = succ_begin[i]; e < succ_begin[i + 1]; e++)
+      min_pred[succ[e]] = std::min(min_pred[succ[e]], i);
+
+  // Bitsets of the targets reachable from each vertex, restricted to a chunk
+  // of positions. A chunk spans at least one word.
+  const size_t words = std::max<size_t>(
+      1, std::min((num_verts + 63) / 64,
+                  memory_budget / (num_verts * sizeof(uint64_t))));
+  const size_t chunk_size = words * 64;
+  std::vector<uint64_t> reach(num_verts * words);
+  std::vector<bool> reaches_chunk(num_verts);
+
+  for (size_t chunk_begin = 0; chunk_begin < num_verts;
+       chunk_begin += chunk_size) {
+    size_t chunk_end = std::min(num_verts, chunk_begin + chunk_size);
+    size_t first = *std::min_element(min_pred.begin() + chunk_begin,
+                                     min_pred.begin() + chunk_end);
+    // Vertices after the chunk cannot reach it, since edges point forward
+    for (size_t i = chunk_end; i-- > first;) {
+      reaches_chunk[i] = false;
+      if (max_reach[i] < chunk_begin)
+        continue;
+      uint64_t *row = &reach[i * words];
+      std::fill(row, row + words, 0);
+      // A successor is redundant if an earlier successor reaches it
+      for (size_t e = succ_begin[i]; e < succ_begin[i + 1]; e++) {
+        size_t j = succ[e];
+        if (j >= chunk_end)
+          break;
+        if (j >= chunk_begin) {
+          size_t bit = j - chunk_begin;
+          if (row[bit / 64] & (uint64_t(1) << (bit % 64))) {
+            redundant[e] = true;
+            continue;
+          }
+          row[bit / 64] |= uint64_t(1) << (bit % 64);
+          reaches_chunk[i] = true;
+        }
+        if (!reaches_chunk[j])
+          continue;
+        const uint64_t *succ_row = &reach[j * words];
+        for (size_t w = 0; w < words; w++)
+          row[w] |= succ_row[w];
+        reaches_chunk[i] = true;
+      }
+    }
+  }
+
+  // Add the kept edges, from the last vertex in topological order back to the
+  // first, as boost::transitive_reduction does
+  for (size_t i = num_verts; i-- > 0;)
+    for (size_t e = succ_begin[i]; e < succ_begin[i + 1]; e++)
+      if (!redundant[e])
+        add_edge(g_to_tr[topo_order[i]], g_to_tr[topo_order[succ[e]]], tr);
+}
+
+} // namespace air
+} // namespace xilinx
@@ -15,6 +15,7 @@
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "llvm/ADT/StringMap.h"
 
 using namespace mlir;
 
@@ -64,17 +65,60 @@ mlir::AffineIfOp getAffineIfInBlock(mlir::Block *block);
 // Returns the first air.dma op in block; nullptr otherwise
 DmaMemcpyNdOp getAIRDmaInBlock(mlir::Block *block);
 
-// Get channel declaration through channel symbol
-ChannelOp getChannelDeclarationThroughSymbol(ChannelInterface op);
-// Get ChannelPutOps from ChannelOp
+// Index of the air.channel declarations under an op, and of the channel puts
+// and gets of each channel symbol, built in a single walk. As an analysis,
+// e.g. from getAnalysis<ChannelSymbolUses>(), it is invalidated once a pass
+// modifies the IR; code which creates or erases channel ops while holding it
+// records them with insert() and erase().
+class ChannelSymbolUses {
+public:
+  // Index the channel ops under `root`. With `enclosingDeclarations`, the
+  // channel declarations of the symbol tables enclosing `root` are indexed
+  // too, without walking the ops next to `root`, so that a function can be
+  // indexed while its sibling functions are transformed.
+  ChannelSymbolUses(Operation *root, bool enclosingDeclarations = false);
+
+  // Get the declaration of the channel symbol of a channel op
+  ChannelOp getChannel(ChannelInterface op) const;
+  // Get the puts or gets of a channel symbol, in program order, under `scope`
+  // if given
+  std::vector<ChannelPutOp> getPuts(ChannelOp channel,
+                                    Operation *scope = nullptr) const;
+  std::vector<ChannelGetOp> getGets(ChannelOp channel,
+                                    Operation *scope = nullptr) const;
+
+  void insert(Operation *op);
+  void erase(Operation *op);
+
+private:
+  Operation *root;
+  llvm::StringMap<std::vector<ChannelOp>> channels;
+  llvm::StringMap<std::vector<ChannelPutOp>> puts;
+  llvm::StringMap<std::vector<ChannelGetOp>> gets;
+};
+
+// Get channel declaration through channel symbol. The symbol is looked up in
+// `uses`, if given, instead of the symbol tables.
+ChannelOp
+getChannelDeclarationThroughSymbol(ChannelInterface op,
+                                   const ChannelSymbolUses *uses = nullptr);
+// Get ChannelPutOps from ChannelOp, from `uses` if given instead of walking
+// `scope`
 std::vector<ChannelPutOp>
-getChannelPutOpThroughSymbol(ChannelOp channel, Operation *scope = nullptr);
-// Get ChannelGetOps from ChannelOp
+getChannelPutOpThroughSymbol(ChannelOp channel, Operation *scope = nullptr,
+                             const ChannelSymbolUses *uses = nullptr);
+// Get ChannelGetOps from ChannelOp, from `uses` if given instead of walking
+// `scope`
 std::vector<ChannelGetOp>
-getChannelGetOpThroughSymbol(ChannelOp channel, Operation *scope = nullptr);
+getChannelGetOpThroughSymbol(ChannelOp channel, Operation *scope = nullptr,
+                             const ChannelSymbolUses *uses = nullptr);
 // Get the other channel op through channel symbol
-std::vector<ChannelGetOp> getTheOtherChannelOpThroughSymbol(ChannelPutOp put);
-std::vector<ChannelPutOp> getTheOtherChannelOpThroughSymbol(ChannelGetOp get);
+std::vector<ChannelGetOp>
+getTheOtherChannelOpThroughSymbol(ChannelPutOp put,
+                                  const ChannelSymbolUses *uses = nullptr);
+std::vector<ChannelPutOp>
+getTheOtherChannelOpThroughSymbol(ChannelGetOp get,
+                                  const ChannelSymbolUses *uses = nullptr);
 void getSizesFromIntegerSet(MLIRContext *ctx, IntegerSet int_set,
                             SmallVector<int, 2> &lbs_int,
                             SmallVector<int, 2> &ubs_int);
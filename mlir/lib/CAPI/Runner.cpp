@@ -12,12 +12,71 @@
 
 #include "mlir/CAPI/IR.h"
 #include "mlir/CAPI/Support.h"
+#include "mlir/CAPI/Utils.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/Support/FileUtilities.h"
 
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ToolOutputFile.h"
 
+namespace {
+
+// Simulate a function against a json model, writing its trace to `trace_os`,
+// if given
+std::optional<xilinx::air::AIRRunnerResults>
+runSimulation(mlir::ModuleOp moduleOp, llvm::StringRef json_str,
+              llvm::raw_ostream *trace_os, const char *topLevelFunction,
+              const char *simGranularity, bool verbose) {
+  auto jsonModel = llvm::json::parse(json_str);
+  if (!jsonModel) {
+    llvm::consumeError(jsonModel.takeError());
+    llvm::errs() << "failed to parse model json\n";
+    return std::nullopt;
+  }
+
+  auto toplevel = moduleOp.lookupSymbol<mlir::func::FuncOp>(topLevelFunction);
+  if (!toplevel) {
+    llvm::errs() << "Function not supported.\n";
+    return std::nullopt;
+  }
+
+  // Without a trace stream, skip formatting trace events altogether
+  xilinx::air::AIRRunner runner(trace_os ? *trace_os : llvm::nulls(),
+                                *jsonModel, simGranularity, verbose, false,
+                                false, "json", trace_os ? "all" : "none");
+
+  if (trace_os)
+    runner.emitTraceStart(*trace_os);
+  runner.scheduleFunction(toplevel);
+  if (trace_os)
+    runner.emitTraceEnd(*trace_os);
+
+  return runner.getResults();
+}
+
+xilinx::air::AIRRunnerResults &unwrap(AirRunnerResults results) {
+  return *static_cast<xilinx::air::AIRRunnerResults *>(results.ptr);
+}
+
+// The model outlives the runner, which refers to it
+struct RunnerSession {
+  llvm::json::Value model;
+  xilinx::air::AIRRunnerProgram program;
+  xilinx::air::AIRRunner runner;
+
+  RunnerSession(llvm::json::Value json_model, mlir::func::FuncOp toplevel,
+                std::string sim_granularity)
+      : model(std::move(json_model)), program(toplevel, sim_granularity),
+        runner(llvm::nulls(), model, sim_granularity, false, false, false,
+               "json", "none") {}
+};
+
+RunnerSession &unwrap(AirRunnerSession session) {
+  return *static_cast<RunnerSession *>(session.ptr);
+}
+
+} // namespace
+
 void airRunnerRun(MlirModule module, const char *jsonFileName,
                   const char *outputFileName, const char *topLevelFunction,
                   const char *simGranularity, bool verbose) {
@@ -35,27 +94,135 @@ void airRunnerRun(MlirModule module, const char *jsonFileName,
     return;
   }
 
-  std::string json_str = json_file->getBuffer().str();
-  llvm::StringRef sr(json_str);
-  auto jsonModel = llvm::json::parse(sr);
-  if (!jsonModel) {
-    llvm::errs() << "failed to parse model json\n";
+  if (!runSimulation(moduleOp, json_file->getBuffer(), &output->os(),
+                     topLevelFunction, simGranularity, verbose))
     return;
+
+  output->keep();
+  return;
+}
+
+AirRunnerResults airRunnerSimulate(MlirModule module, MlirStringRef json_model,
+                                   const char *outputFileName,
+                                   const char *topLevelFunction,
+                                   const char *simGranularity, bool verbose) {
+  std::unique_ptr<llvm::ToolOutputFile> output;
+  if (outputFileName && *outputFileName) {
+    std::string errorMessage;
+    output = mlir::openOutputFile(outputFileName, &errorMessage);
+    if (!output) {
+      llvm::errs() << errorMessage << "\n";
+      return {nullptr};
+    }
   }
 
-  xilinx::air::AIRRunner runner(output->os(), *jsonModel, simGranularity,
-                                verbose);
+  auto results =
+      runSimulation(unwrap(module), unwrap(json_model),
+                    output ? &output->os() : nullptr, topLevelFunction,
+                    simGranularity, verbose);
+  if (!results)
+    return {nullptr};
 
-  auto toplevel = moduleOp.lookupSymbol<mlir::func::FuncOp>(topLevelFunction);
+  if (output)
+    output->keep();
+  return {new xilinx::air::AIRRunnerResults(std::move(*results))};
+}
+
+void airRunnerResultsDestroy(AirRunnerResults results) {
+  delete static_cast<xilinx::air::AIRRunnerResults *>(results.ptr);
+}
+
+uint64_t airRunnerResultsGetCycles(AirRunnerResults results) {
+  return unwrap(results).cycles;
+}
+
+double airRunnerResultsGetLatencyUs(AirRunnerResults results) {
+  return unwrap(results).latency_us;
+}
+
+double airRunnerResultsGetDuUtilization(AirRunnerResults results) {
+  return unwrap(results).du_utilization;
+}
+
+double airRunnerResultsGetTileUtilization(AirRunnerResults results) {
+  return unwrap(results).tile_utilization;
+}
+
+intptr_t airRunnerResultsGetNumSpans(AirRunnerResults results) {
+  return unwrap(results).spans.size();
+}
+
+AirRunnerSpan airRunnerResultsGetSpan(AirRunnerResults results,
+                                      intptr_t pos) {
+  auto &span = unwrap(results).spans[pos];
+  return {wrap(llvm::StringRef(span.name)), wrap(llvm::StringRef(span.kind)),
+          span.id, span.instances, span.start, span.end};
+}
+
+intptr_t airRunnerResultsGetNumResources(AirRunnerResults results) {
+  return unwrap(results).resources.size();
+}
+
+AirRunnerResourceUsage airRunnerResultsGetResource(AirRunnerResults results,
+                                                   intptr_t pos) {
+  auto &resource = unwrap(results).resources[pos];
+  return {wrap(llvm::StringRef(resource.name)),
+          wrap(llvm::StringRef(resource.kind)), resource.busy_cycles};
+}
+
+intptr_t airRunnerResultsGetNumChannels(AirRunnerResults results) {
+  return unwrap(results).channels.size();
+}
+
+AirRunnerChannelStall airRunnerResultsGetChannel(AirRunnerResults results,
+                                                 intptr_t pos) {
+  auto &channel = unwrap(results).channels[pos];
+  return {wrap(llvm::StringRef(channel.name)), channel.ops,
+          channel.stall_cycles};
+}
+
+void airRunnerResultsPrintReport(AirRunnerResults results,
+                                 MlirStringCallback callback,
+                                 void *user_data) {
+  mlir::detail::CallbackOstream stream(callback, user_data);
+  xilinx::air::writeRunnerReport(stream, unwrap(results));
+}
+
+AirRunnerSession airRunnerSessionCreate(MlirModule module,
+                                        MlirStringRef json_model,
+                                        const char *topLevelFunction,
+                                        const char *simGranularity) {
+  auto jsonModel = llvm::json::parse(unwrap(json_model));
+  if (!jsonModel) {
+    llvm::consumeError(jsonModel.takeError());
+    llvm::errs() << "failed to parse model json\n";
+    return {nullptr};
+  }
+
+  auto toplevel =
+      unwrap(module).lookupSymbol<mlir::func::FuncOp>(topLevelFunction);
   if (!toplevel) {
     llvm::errs() << "Function not supported.\n";
-    return;
+    return {nullptr};
   }
 
-  runner.emitTraceStart(output->os());
-  runner.scheduleFunction(toplevel);
-  runner.emitTraceEnd(output->os());
+  return {new RunnerSession(std::move(*jsonModel), toplevel, simGranularity)};
+}
 
-  output->keep();
-  return;
+void airRunnerSessionDestroy(AirRunnerSession session) {
+  delete static_cast<RunnerSession *>(session.ptr);
+}
+
+void airRunnerSessionInvalidate(AirRunnerSession session, intptr_t num_ops,
+                                MlirOperation *changed_ops) {
+  std::vector<mlir::Operation *> ops;
+  for (intptr_t i = 0; i < num_ops; i++)
+    ops.push_back(unwrap(changed_ops[i]));
+  unwrap(session).program.invalidate(ops);
+}
+
+AirRunnerResults airRunnerSessionSimulate(AirRunnerSession session) {
+  auto &s = unwrap(session);
+  s.runner.scheduleFunction(s.program);
+  return {new xilinx::air::AIRRunnerResults(s.runner.getResults())};
 }
@@ -447,7 +447,9 @@ public:
 class AIRChannelPutToAIRRtConversion
     : public OpConversionPattern<xilinx::air::ChannelPutOp> {
 public:
-  using OpConversionPattern<xilinx::air::ChannelPutOp>::OpConversionPattern;
+  AIRChannelPutToAIRRtConversion(TypeConverter &converter, MLIRContext *ctx,
+                                 const air::ChannelSymbolUses &channel_uses)
+      : OpConversionPattern(converter, ctx), channel_uses(channel_uses) {}
 
   LogicalResult
   matchAndRewrite(xilinx::air::ChannelPutOp op, OpAdaptor adaptor,
@@ -469,7 +471,7 @@ public:
       rewriter.create<xilinx::airrt::WaitAllOp>(
           op->getLoc(), xilinx::airrt::EventType::get(op->getContext()), deps);
 
-    auto getOps = getTheOtherChannelOpThroughSymbol(op);
+    auto getOps = getTheOtherChannelOpThroughSymbol(op, &channel_uses);
     if (getOps.size() > 1)
       return failure();
     auto getOp = getOps[0];
@@ -568,12 +570,17 @@ public:
     rewriter.replaceOp(op, airrtOp->getResults());
     return success();
   }
+
+private:
+  const air::ChannelSymbolUses &channel_uses;
 };
 
 class AIRChannelGetToAIRRtConversion
     : public OpConversionPattern<xilinx::air::ChannelGetOp> {
 public:
-  using OpConversionPattern<xilinx::air::ChannelGetOp>::OpConversionPattern;
+  AIRChannelGetToAIRRtConversion(TypeConverter &converter, MLIRContext *ctx,
+                                 const air::ChannelSymbolUses &channel_uses)
+      : OpConversionPattern(converter, ctx), channel_uses(channel_uses) {}
 
   LogicalResult
   matchAndRewrite(xilinx::air::ChannelGetOp op, OpAdaptor adaptor,
@@ -595,7 +602,7 @@ public:
       rewriter.create<xilinx::airrt::WaitAllOp>(
           op->getLoc(), xilinx::airrt::EventType::get(op->getContext()), deps);
 
-    auto putOps = getTheOtherChannelOpThroughSymbol(op);
+    auto putOps = getTheOtherChannelOpThroughSymbol(op, &channel_uses);
     if (putOps.size() > 1)
       return failure();
     auto putOp = putOps[0];
@@ -694,6 +701,9 @@ public:
     rewriter.replaceOp(op, airrtOp->getResults());
     return success();
   }
+
+private:
+  const air::ChannelSymbolUses &channel_uses;
 };
 
 class L2AllocToAIRRtConversion : public ConversionPattern {
@@ -1066,9 +1076,11 @@ public:
                                                                    converter);
 
     air_patterns
-        .add<AIRDmaMemcpyNdToAIRRtConversion, AIRChannelPutToAIRRtConversion,
-             AIRChannelGetToAIRRtConversion, AIRWaitAllToAIRRtConversion>(
+        .add<AIRDmaMemcpyNdToAIRRtConversion, AIRWaitAllToAIRRtConversion>(
             converter, context);
+    air_patterns
+        .add<AIRChannelPutToAIRRtConversion, AIRChannelGetToAIRRtConversion>(
+            converter, context, getAnalysis<air::ChannelSymbolUses>());
 
     if (failed(
             applyPartialConversion(module, target, std::move(air_patterns)))) {
@@ -989,8 +989,10 @@ void rewriteChannelDeallocs(PatternRewriter &rewriter, MyOp op,
 struct LowerAIRChannelsPattern : public OpRewritePattern<air::ChannelOp> {
   using OpRewritePattern<air::ChannelOp>::OpRewritePattern;
 
-  LowerAIRChannelsPattern(MLIRContext *ctx, ShimTileAllocator &shimTileAlloc)
-      : OpRewritePattern(ctx), shimTileAlloc(shimTileAlloc) {}
+  LowerAIRChannelsPattern(MLIRContext *ctx, ShimTileAllocator &shimTileAlloc,
+                          ChannelSymbolUses &channel_uses)
+      : OpRewritePattern(ctx), shimTileAlloc(shimTileAlloc),
+        channel_uses(channel_uses) {}
 
   LogicalResult matchAndRewrite(air::ChannelOp channel,
                                 PatternRewriter &rewriter) const override {
@@ -1007,9 +1009,9 @@ struct LowerAIRChannelsPattern : public OpRewritePattern<air::ChannelOp> {
       return failure();
 
     std::vector<ChannelPutOp> channelPuts =
-        getChannelPutOpThroughSymbol(channel, device);
+        getChannelPutOpThroughSymbol(channel, device, &channel_uses);
     std::vector<ChannelGetOp> channelGets =
-        getChannelGetOpThroughSymbol(channel, device);
+        getChannelGetOpThroughSymbol(channel, device, &channel_uses);
 
     // put/get come in pairs, if one is missing then it's L3
     MemRefType srcMemref;
@@ -1127,18 +1129,22 @@ struct LowerAIRChannelsPattern : public OpRewritePattern<air::ChannelOp> {
     }
     // erase channel puts and gets
     for (auto get : channelGets) {
+      channel_uses.erase(get);
       rewriter.eraseOp(get);
     }
     for (auto put : channelPuts) {
+      channel_uses.erase(put);
       rewriter.eraseOp(put);
     }
     // erase the channel
+    channel_uses.erase(channel);
     rewriter.eraseOp(channel);
     return success();
   }
 
 private:
   ShimTileAllocator &shimTileAlloc;
+  ChannelSymbolUses &channel_uses;
 };
 
 // This function replaces ChannelPutOp/ChannelGetOp with AIE_CreateObjectFifoOps
@@ -1147,8 +1153,9 @@ private:
 // memref deallocs with ObjectFifoReleaseOps.
 void lowerAIRChannels(AIE::DeviceOp &d, ShimTileAllocator &a) {
   auto ctx = d->getContext();
+  ChannelSymbolUses channel_uses(d);
   RewritePatternSet patterns(ctx);
-  patterns.insert<LowerAIRChannelsPattern>(ctx, a);
+  patterns.insert<LowerAIRChannelsPattern>(ctx, a, channel_uses);
   (void)applyPatternsAndFoldGreedily(d, std::move(patterns));
 }
 
@@ -1156,7 +1163,9 @@ struct SpecializeChannelBundlePattern
     : public OpRewritePattern<air::ChannelOp> {
   using OpRewritePattern<air::ChannelOp>::OpRewritePattern;
 
-  SpecializeChannelBundlePattern(MLIRContext *ctx) : OpRewritePattern(ctx) {}
+  SpecializeChannelBundlePattern(MLIRContext *ctx,
+                                 ChannelSymbolUses &channel_uses)
+      : OpRewritePattern(ctx), channel_uses(channel_uses) {}
 
   LogicalResult matchAndRewrite(air::ChannelOp channel,
                                 PatternRewriter &rewriter) const override {
@@ -1169,9 +1178,9 @@ struct SpecializeChannelBundlePattern
       return failure();
 
     std::vector<ChannelPutOp> channelPuts =
-        getChannelPutOpThroughSymbol(channel, device);
+        getChannelPutOpThroughSymbol(channel, device, &channel_uses);
     std::vector<ChannelGetOp> channelGets =
-        getChannelGetOpThroughSymbol(channel, device);
+        getChannelGetOpThroughSymbol(channel, device, &channel_uses);
 
     // Walk through each element in a channel bundle
     auto bundle_size = extractFromI64ArrayAttr(channel.getSize());
@@ -1182,6 +1191,7 @@ struct SpecializeChannelBundlePattern
       SmallVector<int64_t, 2> channel_sizes = {1, 1};
       auto new_chan = rewriter.create<air::ChannelOp>(
           channel->getLoc(), cname, rewriter.getI64ArrayAttr(channel_sizes));
+      channel_uses.insert(new_chan);
       std::vector<unsigned> position =
           getMDVectorFromIterator(bundle_size_stdvec, iter);
       for (auto put : channelPuts) {
@@ -1191,6 +1201,7 @@ struct SpecializeChannelBundlePattern
           rewriter.setInsertionPoint(put);
           auto new_put =
               createChannelPutGetWithoutBundle(rewriter, new_chan, put);
+          channel_uses.insert(new_put);
           if (put.getAsyncToken()) {
             replaceAllUsesInRegionWith(put.getAsyncToken(),
                                        new_put.getAsyncToken(),
@@ -1205,6 +1216,7 @@ struct SpecializeChannelBundlePattern
           rewriter.setInsertionPoint(get);
           auto new_get =
               createChannelPutGetWithoutBundle(rewriter, new_chan, get);
+          channel_uses.insert(new_get);
           if (get.getAsyncToken()) {
             replaceAllUsesInRegionWith(get.getAsyncToken(),
                                        new_get.getAsyncToken(),
@@ -1216,17 +1228,22 @@ struct SpecializeChannelBundlePattern
 
     // Erase bundled channel ops and their corresponding put/get ops
     for (auto put : channelPuts) {
+      channel_uses.erase(put);
       rewriter.eraseOp(put);
     }
     for (auto get : channelGets) {
+      channel_uses.erase(get);
       rewriter.eraseOp(get);
     }
+    channel_uses.erase(channel);
     rewriter.eraseOp(channel);
 
     return success();
   }
 
 private:
+  ChannelSymbolUses &channel_uses;
+
   bool areIdenticalVectors(std::vector<unsigned> a,
                            std::vector<unsigned> b) const {
     if (a.empty())
@@ -1301,8 +1318,9 @@ private:
 // removes air.channel bundled representation in a aie.device op.
 void specializeChannelBundle(AIE::DeviceOp &d) {
   auto ctx = d->getContext();
+  ChannelSymbolUses channel_uses(d);
   RewritePatternSet patterns(ctx);
-  patterns.insert<SpecializeChannelBundlePattern>(ctx);
+  patterns.insert<SpecializeChannelBundlePattern>(ctx, channel_uses);
   (void)applyPatternsAndFoldGreedily(d, std::move(patterns));
 }
 
@@ -1905,14 +1923,16 @@ public:
         builder.getUnknownLoc(),
         AIE::AIEDeviceAttr::get(builder.getContext(), *device));
     ShimTileAllocator shimTileAlloc(deviceOp.getTargetModel());
+    ChannelSymbolUses channel_uses(m);
     if (clTestPatterns.find("lower-air-channels") != std::string::npos) {
-      patterns.insert<LowerAIRChannelsPattern>(ctx, shimTileAlloc);
+      patterns.insert<LowerAIRChannelsPattern>(ctx, shimTileAlloc,
+                                               channel_uses);
     }
     if (clTestPatterns.find("lower-air-ping-pong") != std::string::npos) {
       patterns.insert<LowerAIRPingPongPattern>(ctx);
     }
     if (clTestPatterns.find("specialize-channel-bundle") != std::string::npos) {
-      patterns.insert<SpecializeChannelBundlePattern>(ctx);
+      patterns.insert<SpecializeChannelBundlePattern>(ctx, channel_uses);
     }
 
     if (patterns.getNativePatterns().size())
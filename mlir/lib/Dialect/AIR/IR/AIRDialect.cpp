@@ -1210,6 +1210,15 @@ static LogicalResult FoldChannel(ChannelOp op, PatternRewriter &rewriter) {
   return failure();
 }
 
+LogicalResult ChannelOp::verify() {
+  if (auto attr = getOperation()->getAttr("buffer_depth")) {
+    auto depth = attr.dyn_cast<IntegerAttr>();
+    if (!depth || depth.getInt() < 1)
+      return emitOpError() << "expects 'buffer_depth' to be a positive integer";
+  }
+  return success();
+}
+
 void ChannelOp::getCanonicalizationPatterns(RewritePatternSet &patterns,
                                             MLIRContext *context) {
   patterns.add(FoldChannel);
@@ -30,6 +30,8 @@
 #include "mlir/Transforms/InliningUtils.h"
 #include "mlir/Transforms/RegionUtils.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 
@@ -53,7 +55,6 @@ void boost::throw_exception(std::exception const &e,
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/graphviz.hpp>
-#include <boost/graph/transitive_reduction.hpp>
 
 #include <algorithm>
 #include <map>
@@ -91,11 +92,6 @@ typedef boost::graph_traits<Graph>::vertex_iterator vertex_iterator;
 typedef std::map<Graph::vertex_descriptor, Graph::vertex_descriptor> vertex_map;
 typedef std::map<unsigned, Graph::vertex_descriptor> operation_id_to_vertex_map;
 
-static uint64_t ExecuteOpID;
-static uint64_t HierarchyOpID;
-static uint64_t WaitAllOpID;
-static uint64_t ChannelOpID;
-
 class AIRDependency : public AIRDependencyBase<AIRDependency> {
 
 public:
@@ -107,471 +103,466 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
+    auto f = getOperation();
+
+    // The pass instance is reused across the functions it is scheduled on
+    resetState();
 
     // Preprocessing: renumber the air dma op ids
-    for (auto f : module.getOps<func::FuncOp>()) {
-      xilinx::air::renumberDmaOps(f, "global");
-    }
+    xilinx::air::renumberDmaOps(f, "global");
 
     // 1st traversal: create async ops with empty dep list.
 
-    OpBuilder module_builder(module);
+    OpBuilder func_builder(f);
 
-    ExecuteOpID = 0;
-    HierarchyOpID = 0;
-    WaitAllOpID = 0;
-    ChannelOpID = 0;
+    f.walk([&](Operation *op) {
+      // Create async interface for air.dmamemcpy ops
+      if (mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(op))
+        createAsyncDMA(func_builder, op);
 
-    for (auto f : module.getOps<func::FuncOp>()) {
-      f.walk([&](Operation *op) {
-        // Create async interface for air.dmamemcpy ops
-        if (mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(op))
-          createAsyncDMA(module_builder, op);
-
-        // Create async interface for air.channel ops
-        else if (mlir::dyn_cast<xilinx::air::ChannelInterface>(op))
-          createAsyncChannel(module_builder, op, ChannelOpID);
-
-        // Create async execute region for linalg.matmul
-        else if (dyn_cast<linalg::MatmulOp>(op))
-          createAsyncExecute(module_builder, op, "linalg::matmul", ExecuteOpID);
-
-        // Create async execute region for linalg.fill
-        else if (dyn_cast<linalg::FillOp>(op))
-          createAsyncExecute(module_builder, op, "linalg::fill", ExecuteOpID);
-
-        // Create async execute region for linalg.copy
-        else if (dyn_cast<linalg::CopyOp>(op))
-          createAsyncExecute(module_builder, op, "linalg::copy", ExecuteOpID);
-
-        // Create async execute region for linalg op
-        else if (mlir::dyn_cast<linalg::LinalgOp>(op))
-          createAsyncExecute(module_builder, op, "linalg::unknown",
-                             ExecuteOpID);
-
-        // Create async execute region for memref.alloc
-        else if (auto memalloc_op = dyn_cast<memref::AllocOp>(op))
-          createAsyncExecute(module_builder, op, "memref::alloc", ExecuteOpID,
-                             memalloc_op.getMemref().getType());
-
-        // Create async execute region for memref.alloc
-        else if (auto memcast_op = dyn_cast<memref::CastOp>(op))
-          createAsyncExecute(module_builder, op, "memref::cast", ExecuteOpID,
-                             memcast_op.getDest().getType());
-
-        // Create async execute region for memref.dealloc
-        else if (dyn_cast<memref::DeallocOp>(op))
-          createAsyncExecute(module_builder, op, "memref::dealloc",
-                             ExecuteOpID);
-
-        // Create async execute region for memref.copy
-        else if (dyn_cast<memref::CopyOp>(op))
-          createAsyncExecute(module_builder, op, "memref::copy", ExecuteOpID);
-
-        // Create async execute region for arith.muli
-        else if (auto arith_op = dyn_cast<arith::MulIOp>(op)) {
-          if (arith_op.getResult().getType().isa<IndexType>()) {
-            createAsyncExecute(module_builder, op, "arith::muli", ExecuteOpID,
-                               arith_op.getResult().getType());
-          }
+      // Create async interface for air.channel ops
+      else if (mlir::dyn_cast<xilinx::air::ChannelInterface>(op))
+        createAsyncChannel(func_builder, op, ChannelOpID);
+
+      // Create async execute region for linalg.matmul
+      else if (dyn_cast<linalg::MatmulOp>(op))
+        createAsyncExecute(func_builder, op, "linalg::matmul", ExecuteOpID);
+
+      // Create async execute region for linalg.fill
+      else if (dyn_cast<linalg::FillOp>(op))
+        createAsyncExecute(func_builder, op, "linalg::fill", ExecuteOpID);
+
+      // Create async execute region for linalg.copy
+      else if (dyn_cast<linalg::CopyOp>(op))
+        createAsyncExecute(func_builder, op, "linalg::copy", ExecuteOpID);
+
+      // Create async execute region for linalg op
+      else if (mlir::dyn_cast<linalg::LinalgOp>(op))
+        createAsyncExecute(func_builder, op, "linalg::unknown", ExecuteOpID);
+
+      // Create async execute region for memref.alloc
+      else if (auto memalloc_op = dyn_cast<memref::AllocOp>(op))
+        createAsyncExecute(func_builder, op, "memref::alloc", ExecuteOpID,
+                           memalloc_op.getMemref().getType());
+
+      // Create async execute region for memref.alloc
+      else if (auto memcast_op = dyn_cast<memref::CastOp>(op))
+        createAsyncExecute(func_builder, op, "memref::cast", ExecuteOpID,
+                           memcast_op.getDest().getType());
+
+      // Create async execute region for memref.dealloc
+      else if (dyn_cast<memref::DeallocOp>(op))
+        createAsyncExecute(func_builder, op, "memref::dealloc", ExecuteOpID);
+
+      // Create async execute region for memref.copy
+      else if (dyn_cast<memref::CopyOp>(op))
+        createAsyncExecute(func_builder, op, "memref::copy", ExecuteOpID);
+
+      // Create async execute region for arith.muli
+      else if (auto arith_op = dyn_cast<arith::MulIOp>(op)) {
+        if (arith_op.getResult().getType().isa<IndexType>()) {
+          createAsyncExecute(func_builder, op, "arith::muli", ExecuteOpID,
+                             arith_op.getResult().getType());
         }
+      }
 
-        // Create async execute region for arith.addi
-        else if (auto arith_op = dyn_cast<arith::AddIOp>(op)) {
-          if (arith_op.getResult().getType().isa<IndexType>()) {
-            createAsyncExecute(module_builder, op, "arith::addi", ExecuteOpID,
-                               arith_op.getResult().getType());
-          }
+      // Create async execute region for arith.addi
+      else if (auto arith_op = dyn_cast<arith::AddIOp>(op)) {
+        if (arith_op.getResult().getType().isa<IndexType>()) {
+          createAsyncExecute(func_builder, op, "arith::addi", ExecuteOpID,
+                             arith_op.getResult().getType());
         }
+      }
 
-        // Create async execute region for affine.apply
-        else if (auto apply_op = dyn_cast<mlir::AffineApplyOp>(op))
-          createAsyncExecute(module_builder, op, "affine::apply", ExecuteOpID,
-                             apply_op.getResult().getType());
+      // Create async execute region for affine.apply
+      else if (auto apply_op = dyn_cast<mlir::AffineApplyOp>(op))
+        createAsyncExecute(func_builder, op, "affine::apply", ExecuteOpID,
+                           apply_op.getResult().getType());
 
-        // Create async execute region for air hierarchy ops (air.launch and
-        // air.segment, TODO: air.herd).
-        else if (auto hierarchy_op = dyn_cast<air::HierarchyInterface>(op)) {
-          createAsyncHierarchyImpls(module_builder, hierarchy_op,
-                                    HierarchyOpID);
-        }
+      // Create async execute region for air hierarchy ops (air.launch and
+      // air.segment, TODO: air.herd).
+      else if (auto hierarchy_op = dyn_cast<air::HierarchyInterface>(op)) {
+        createAsyncHierarchyImpls(func_builder, hierarchy_op, HierarchyOpID);
+      }
 
-        // Create async execute region for an unknown op which has memref or
-        // index-type operands
-        else {
-          bool isCandidateExecute = false;
-          for (auto operand : op->getOperands()) {
-            if (operand.getType().isa<MemRefType>() ||
-                operand.getType().isa<IndexType>()) {
-              isCandidateExecute = true;
-            }
-          }
-          // No air execute for loop ops
-          if (mlir::dyn_cast<mlir::LoopLikeOpInterface>(op))
-            isCandidateExecute = false;
-          // No air execute for subview ops
-          if (mlir::dyn_cast<mlir::OffsetSizeAndStrideOpInterface>(op))
-            isCandidateExecute = false;
-          // No air execute for terminators
-          if (op->mightHaveTrait<OpTrait::IsTerminator>()) {
-            isCandidateExecute = false;
-          }
-          // No air execute in linalg.generic
-          if (op->getParentOfType<mlir::linalg::GenericOp>()) {
-            isCandidateExecute = false;
-          }
-          if (isCandidateExecute) {
-            if (op->getNumResults())
-              createAsyncExecute(module_builder, op, "unknown", ExecuteOpID,
-                                 op->getResults().front().getType());
-            else
-              createAsyncExecute(module_builder, op, "unknown", ExecuteOpID);
+      // Create async execute region for an unknown op which has memref or
+      // index-type operands
+      else {
+        bool isCandidateExecute = false;
+        for (auto operand : op->getOperands()) {
+          if (operand.getType().isa<MemRefType>() ||
+              operand.getType().isa<IndexType>()) {
+            isCandidateExecute = true;
           }
         }
-      });
-    }
+        // No air execute for loop ops
+        if (mlir::dyn_cast<mlir::LoopLikeOpInterface>(op))
+          isCandidateExecute = false;
+        // No air execute for subview ops
+        if (mlir::dyn_cast<mlir::OffsetSizeAndStrideOpInterface>(op))
+          isCandidateExecute = false;
+        // No air execute for terminators
+        if (op->mightHaveTrait<OpTrait::IsTerminator>()) {
+          isCandidateExecute = false;
+        }
+        // No air execute in linalg.generic
+        if (op->getParentOfType<mlir::linalg::GenericOp>()) {
+          isCandidateExecute = false;
+        }
+        if (isCandidateExecute) {
+          if (op->getNumResults())
+            createAsyncExecute(func_builder, op, "unknown", ExecuteOpID,
+                               op->getResults().front().getType());
+          else
+            createAsyncExecute(func_builder, op, "unknown", ExecuteOpID);
+        }
+      }
+    });
 
     // 2nd traversal: trace deps among async execute regions; build a boost dep
     // graph.
 
-    for (auto f : module.getOps<func::FuncOp>()) {
-      f.walk([&](Operation *op) {
-        Operation *sink_op = nullptr;
-        if (auto async_execute_op = dyn_cast<air::ExecuteOp>(op)) {
-          for (auto &bb : async_execute_op.getBody()) {
-            for (auto &child_op : bb.getOperations()) {
-              if (!dyn_cast<air::ExecuteTerminatorOp>(child_op))
-                sink_op = &child_op;
-            }
+    f.walk([&](Operation *op) {
+      Operation *sink_op = nullptr;
+      if (auto async_execute_op = dyn_cast<air::ExecuteOp>(op)) {
+        for (auto &bb : async_execute_op.getBody()) {
+          for (auto &child_op : bb.getOperations()) {
+            if (!dyn_cast<air::ExecuteTerminatorOp>(child_op))
+              sink_op = &child_op;
           }
-        } else if (mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(op)) {
-          sink_op = op;
-        } else if (mlir::dyn_cast<xilinx::air::ChannelInterface>(op)) {
-          sink_op = op;
-        } else if (dyn_cast<air::HierarchyInterface>(op)) {
-          sink_op = op;
-        } else
-          return;
-
-        SmallVector<partialMemref, 1> sink_op_memref_reads;
-        SmallVector<partialMemref, 1> sink_op_memref_writes;
-        SmallVector<Value, 1> sink_op_scalar_ins;
-        SmallVector<Value, 1> sink_op_scalar_outs;
-
-        // If the sink op is linalg op
-        if (auto sink_op_linalgop = dyn_cast<linalg::LinalgOp>(sink_op)) {
-          for (auto linalg_ins : sink_op_linalgop.getDpsInputOperands()) {
-            auto ins_value = linalg_ins->get();
-            if (ins_value.getType().isa<MemRefType>()) {
-              unsigned memRefRank =
-                  ins_value.getType().cast<MemRefType>().getRank();
-              partialMemref tile = createPartialMemref(ins_value, memRefRank);
-              sink_op_memref_reads.push_back(tile);
-            } else if (ins_value.getType().isa<IndexType>()) {
-              sink_op_scalar_ins.push_back(ins_value);
-            }
+        }
+      } else if (mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(op)) {
+        sink_op = op;
+      } else if (mlir::dyn_cast<xilinx::air::ChannelInterface>(op)) {
+        sink_op = op;
+      } else if (dyn_cast<air::HierarchyInterface>(op)) {
+        sink_op = op;
+      } else
+        return;
+
+      SmallVector<partialMemref, 1> sink_op_memref_reads;
+      SmallVector<partialMemref, 1> sink_op_memref_writes;
+      SmallVector<Value, 1> sink_op_scalar_ins;
+      SmallVector<Value, 1> sink_op_scalar_outs;
+
+      // If the sink op is linalg op
+      if (auto sink_op_linalgop = dyn_cast<linalg::LinalgOp>(sink_op)) {
+        for (auto linalg_ins : sink_op_linalgop.getDpsInputOperands()) {
+          auto ins_value = linalg_ins->get();
+          if (ins_value.getType().isa<MemRefType>()) {
+            unsigned memRefRank =
+                ins_value.getType().cast<MemRefType>().getRank();
+            partialMemref tile = createPartialMemref(ins_value, memRefRank);
+            sink_op_memref_reads.push_back(tile);
+          } else if (ins_value.getType().isa<IndexType>()) {
+            sink_op_scalar_ins.push_back(ins_value);
+          }
+        }
+        for (auto linalg_outs : sink_op_linalgop.getDpsInitOperands()) {
+          auto outs_value = linalg_outs->get();
+          if (outs_value.getType().isa<MemRefType>()) {
+            unsigned memRefRank =
+                outs_value.getType().cast<MemRefType>().getRank();
+            partialMemref tile = createPartialMemref(outs_value, memRefRank);
+            sink_op_memref_reads.push_back(
+                tile); // linalg op both reads and writes the output memref
+            sink_op_memref_writes.push_back(tile);
+          } else if (outs_value.getType().isa<IndexType>()) {
+            sink_op_scalar_ins.push_back(
+                outs_value); // linalg op both reads and writes the output
+                             // memref
+            sink_op_scalar_outs.push_back(outs_value);
           }
-          for (auto linalg_outs : sink_op_linalgop.getDpsInitOperands()) {
-            auto outs_value = linalg_outs->get();
-            if (outs_value.getType().isa<MemRefType>()) {
+        }
+        if (sink_op_linalgop->getNumResults()) {
+          for (auto linalg_results : sink_op_linalgop->getResults()) {
+            if (linalg_results.getType().isa<MemRefType>()) {
               unsigned memRefRank =
-                  outs_value.getType().cast<MemRefType>().getRank();
-              partialMemref tile = createPartialMemref(outs_value, memRefRank);
-              sink_op_memref_reads.push_back(
-                  tile); // linalg op both reads and writes the output memref
+                  linalg_results.getType().cast<MemRefType>().getRank();
+              partialMemref tile =
+                  createPartialMemref(linalg_results, memRefRank);
               sink_op_memref_writes.push_back(tile);
-            } else if (outs_value.getType().isa<IndexType>()) {
-              sink_op_scalar_ins.push_back(
-                  outs_value); // linalg op both reads and writes the output
-                               // memref
-              sink_op_scalar_outs.push_back(outs_value);
-            }
-          }
-          if (sink_op_linalgop->getNumResults()) {
-            for (auto linalg_results : sink_op_linalgop->getResults()) {
-              if (linalg_results.getType().isa<MemRefType>()) {
-                unsigned memRefRank =
-                    linalg_results.getType().cast<MemRefType>().getRank();
-                partialMemref tile =
-                    createPartialMemref(linalg_results, memRefRank);
-                sink_op_memref_writes.push_back(tile);
-              } else if (linalg_results.getType().isa<IndexType>()) {
-                sink_op_scalar_outs.push_back(linalg_results);
-              }
+            } else if (linalg_results.getType().isa<IndexType>()) {
+              sink_op_scalar_outs.push_back(linalg_results);
             }
           }
         }
+      }
 
-        // If the sink op is memref::dealloc
-        else if (auto sink_op_memdealloc =
-                     dyn_cast<memref::DeallocOp>(sink_op)) {
-          unsigned memRefRank = sink_op_memdealloc.getMemref()
-                                    .getType()
-                                    .cast<MemRefType>()
-                                    .getRank();
-          partialMemref tile =
-              createPartialMemref(sink_op_memdealloc.getMemref(), memRefRank);
-          sink_op_memref_reads.push_back(tile);
-          sink_op_memref_writes.push_back(
-              tile); // dealloc erases (i.e. writes to) output memref
-        }
+      // If the sink op is memref::dealloc
+      else if (auto sink_op_memdealloc = dyn_cast<memref::DeallocOp>(sink_op)) {
+        unsigned memRefRank = sink_op_memdealloc.getMemref()
+                                  .getType()
+                                  .cast<MemRefType>()
+                                  .getRank();
+        partialMemref tile =
+            createPartialMemref(sink_op_memdealloc.getMemref(), memRefRank);
+        sink_op_memref_reads.push_back(tile);
+        sink_op_memref_writes.push_back(
+            tile); // dealloc erases (i.e. writes to) output memref
+      }
 
-        // If the sink op is memref::copy
-        else if (auto sink_op_memref_copy = dyn_cast<memref::CopyOp>(sink_op)) {
-          unsigned memRefRankSrc = sink_op_memref_copy.getSource()
-                                       .getType()
-                                       .cast<MemRefType>()
-                                       .getRank();
-          partialMemref tileSrc = createPartialMemref(
-              sink_op_memref_copy.getSource(), memRefRankSrc);
-          sink_op_memref_reads.push_back(tileSrc);
-          unsigned memRefRankDst = sink_op_memref_copy.getTarget()
-                                       .getType()
-                                       .cast<MemRefType>()
-                                       .getRank();
-          partialMemref tileDst = createPartialMemref(
-              sink_op_memref_copy.getTarget(), memRefRankDst);
-          sink_op_memref_reads.push_back(tileDst);
-          sink_op_memref_writes.push_back(tileDst);
-        }
+      // If the sink op is memref::copy
+      else if (auto sink_op_memref_copy = dyn_cast<memref::CopyOp>(sink_op)) {
+        unsigned memRefRankSrc = sink_op_memref_copy.getSource()
+                                     .getType()
+                                     .cast<MemRefType>()
+                                     .getRank();
+        partialMemref tileSrc = createPartialMemref(
+            sink_op_memref_copy.getSource(), memRefRankSrc);
+        sink_op_memref_reads.push_back(tileSrc);
+        unsigned memRefRankDst = sink_op_memref_copy.getTarget()
+                                     .getType()
+                                     .cast<MemRefType>()
+                                     .getRank();
+        partialMemref tileDst = createPartialMemref(
+            sink_op_memref_copy.getTarget(), memRefRankDst);
+        sink_op_memref_reads.push_back(tileDst);
+        sink_op_memref_writes.push_back(tileDst);
+      }
 
-        // If the sink op is an air::DmaMemcpy op
-        else if (auto sink_op_dma =
-                     mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(sink_op)) {
-          SmallVector<Value, 2> src_indices;
-          SmallVector<Value, 2> dst_indices;
-          unsigned numDimsSrc = sink_op_dma.getNumDims();
-          unsigned numDimsDst = sink_op_dma.getNumDims();
-          // air.dmamemcpynd op has unknown # of dims (thus numdims defaults to
-          // 0)
-          if (numDimsSrc == 0) {
-            numDimsSrc = sink_op_dma.getSrcMemref()
-                             .getType()
-                             .cast<MemRefType>()
-                             .getRank();
-            numDimsDst = sink_op_dma.getDstMemref()
-                             .getType()
-                             .cast<MemRefType>()
-                             .getRank();
-          }
-          // Special case with ND DMA op
-          if (auto sink_op_nddma = dyn_cast<air::DmaMemcpyNdOp>(sink_op)) {
-            // air.dmamemcpynd op has extra scalar operands
-            for (unsigned i = 0; i < sink_op_nddma.getDstOffsets().size(); i++)
-              sink_op_scalar_outs.push_back(sink_op_nddma.getDstOffsets()[i]);
-            for (unsigned i = 0; i < sink_op_nddma.getDstSizes().size(); i++)
-              sink_op_scalar_outs.push_back(sink_op_nddma.getDstSizes()[i]);
-            for (unsigned i = 0; i < sink_op_nddma.getDstStrides().size(); i++)
-              sink_op_scalar_outs.push_back(sink_op_nddma.getDstStrides()[i]);
-            for (unsigned i = 0; i < sink_op_nddma.getSrcOffsets().size(); i++)
-              sink_op_scalar_ins.push_back(sink_op_nddma.getSrcOffsets()[i]);
-            for (unsigned i = 0; i < sink_op_nddma.getSrcSizes().size(); i++)
-              sink_op_scalar_ins.push_back(sink_op_nddma.getSrcSizes()[i]);
-            for (unsigned i = 0; i < sink_op_nddma.getSrcStrides().size(); i++)
-              sink_op_scalar_ins.push_back(sink_op_nddma.getSrcStrides()[i]);
-            if (sink_op_nddma.getSrcOffsets().size()) {
-              for (unsigned i = 0; i < numDimsSrc; i++) {
-                src_indices.push_back(sink_op_nddma.getSrcOffsets()[i]);
-              }
-            } else {
-              for (unsigned i = 0; i < numDimsSrc; i++) {
-                src_indices.push_back(nullptr);
-              }
-            }
-            if (sink_op_nddma.getDstOffsets().size()) {
-              for (unsigned i = 0; i < numDimsDst; i++) {
-                dst_indices.push_back(sink_op_nddma.getDstOffsets()[i]);
-              }
-            } else {
-              for (unsigned i = 0; i < numDimsDst; i++) {
-                dst_indices.push_back(nullptr);
-              }
-            }
-          } else {
-            for (unsigned i = 0; i < numDimsSrc; i++) {
-              sink_op_scalar_ins.push_back(sink_op_dma.getSrcMemrefDim(i));
-              src_indices.push_back(sink_op_dma.getSrcMemrefDim(i));
-            }
-            for (unsigned i = 0; i < numDimsDst; i++) {
-              sink_op_scalar_outs.push_back(sink_op_dma.getDstMemrefDim(i));
-              dst_indices.push_back(sink_op_dma.getDstMemrefDim(i));
-            }
-          }
-          partialMemref tile_in = createPartialMemref(
-              sink_op_dma.getSrcMemref(), numDimsSrc, src_indices);
-          sink_op_memref_reads.push_back(tile_in);
-          partialMemref tile_out = createPartialMemref(
-              sink_op_dma.getDstMemref(), numDimsDst, dst_indices);
-          sink_op_memref_writes.push_back(tile_out);
+      // If the sink op is an air::DmaMemcpy op
+      else if (auto sink_op_dma =
+                   mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(sink_op)) {
+        SmallVector<Value, 2> src_indices;
+        SmallVector<Value, 2> dst_indices;
+        unsigned numDimsSrc = sink_op_dma.getNumDims();
+        unsigned numDimsDst = sink_op_dma.getNumDims();
+        // air.dmamemcpynd op has unknown # of dims (thus numdims defaults to
+        // 0)
+        if (numDimsSrc == 0) {
+          numDimsSrc = sink_op_dma.getSrcMemref()
+                           .getType()
+                           .cast<MemRefType>()
+                           .getRank();
+          numDimsDst = sink_op_dma.getDstMemref()
+                           .getType()
+                           .cast<MemRefType>()
+                           .getRank();
         }
-
-        // If the sink op is channel put
-        else if (auto sink_op_channel_put =
-                     dyn_cast<air::ChannelPutOp>(sink_op)) {
-          unsigned numDimsSrc = sink_op_channel_put.getSrc()
-                                    .getType()
-                                    .cast<MemRefType>()
-                                    .getRank();
-          for (unsigned i = 0; i < sink_op_channel_put.getSrcOffsets().size();
-               i++)
-            sink_op_scalar_ins.push_back(
-                sink_op_channel_put.getSrcOffsets()[i]);
-          for (unsigned i = 0; i < sink_op_channel_put.getSrcSizes().size();
-               i++)
-            sink_op_scalar_ins.push_back(sink_op_channel_put.getSrcSizes()[i]);
-          for (unsigned i = 0; i < sink_op_channel_put.getSrcStrides().size();
-               i++)
-            sink_op_scalar_ins.push_back(
-                sink_op_channel_put.getSrcStrides()[i]);
-          SmallVector<Value, 2> src_indices;
-          if (sink_op_channel_put.getSrcOffsets().size()) {
+        // Special case with ND DMA op
+        if (auto sink_op_nddma = dyn_cast<air::DmaMemcpyNdOp>(sink_op)) {
+          // air.dmamemcpynd op has extra scalar operands
+          for (unsigned i = 0; i < sink_op_nddma.getDstOffsets().size(); i++)
+            sink_op_scalar_outs.push_back(sink_op_nddma.getDstOffsets()[i]);
+          for (unsigned i = 0; i < sink_op_nddma.getDstSizes().size(); i++)
+            sink_op_scalar_outs.push_back(sink_op_nddma.getDstSizes()[i]);
+          for (unsigned i = 0; i < sink_op_nddma.getDstStrides().size(); i++)
+            sink_op_scalar_outs.push_back(sink_op_nddma.getDstStrides()[i]);
+          for (unsigned i = 0; i < sink_op_nddma.getSrcOffsets().size(); i++)
+            sink_op_scalar_ins.push_back(sink_op_nddma.getSrcOffsets()[i]);
+          for (unsigned i = 0; i < sink_op_nddma.getSrcSizes().size(); i++)
+            sink_op_scalar_ins.push_back(sink_op_nddma.getSrcSizes()[i]);
+          for (unsigned i = 0; i < sink_op_nddma.getSrcStrides().size(); i++)
+            sink_op_scalar_ins.push_back(sink_op_nddma.getSrcStrides()[i]);
+          if (sink_op_nddma.getSrcOffsets().size()) {
             for (unsigned i = 0; i < numDimsSrc; i++) {
-              src_indices.push_back(sink_op_channel_put.getSrcOffsets()[i]);
+              src_indices.push_back(sink_op_nddma.getSrcOffsets()[i]);
             }
           } else {
             for (unsigned i = 0; i < numDimsSrc; i++) {
               src_indices.push_back(nullptr);
             }
           }
-          partialMemref tile_in = createPartialMemref(
-              sink_op_channel_put.getSrc(), numDimsSrc, src_indices);
-          sink_op_memref_reads.push_back(tile_in);
-        }
-
-        // If the sink op is channel get
-        else if (auto sink_op_channel_get =
-                     dyn_cast<air::ChannelGetOp>(sink_op)) {
-          unsigned numDimsDst = sink_op_channel_get.getDst()
-                                    .getType()
-                                    .cast<MemRefType>()
-                                    .getRank();
-          for (unsigned i = 0; i < sink_op_channel_get.getDstOffsets().size();
-               i++)
-            sink_op_scalar_outs.push_back(
-                sink_op_channel_get.getDstOffsets()[i]);
-          for (unsigned i = 0; i < sink_op_channel_get.getDstSizes().size();
-               i++)
-            sink_op_scalar_outs.push_back(sink_op_channel_get.getDstSizes()[i]);
-          for (unsigned i = 0; i < sink_op_channel_get.getDstStrides().size();
-               i++)
-            sink_op_scalar_outs.push_back(
-                sink_op_channel_get.getDstStrides()[i]);
-          SmallVector<Value, 2> dst_indices;
-          if (sink_op_channel_get.getDstOffsets().size()) {
+          if (sink_op_nddma.getDstOffsets().size()) {
             for (unsigned i = 0; i < numDimsDst; i++) {
-              dst_indices.push_back(sink_op_channel_get.getDstOffsets()[i]);
+              dst_indices.push_back(sink_op_nddma.getDstOffsets()[i]);
             }
           } else {
             for (unsigned i = 0; i < numDimsDst; i++) {
               dst_indices.push_back(nullptr);
             }
           }
-          partialMemref tile_out = createPartialMemref(
-              sink_op_channel_get.getDst(), numDimsDst, dst_indices);
-          sink_op_memref_writes.push_back(tile_out);
+        } else {
+          for (unsigned i = 0; i < numDimsSrc; i++) {
+            sink_op_scalar_ins.push_back(sink_op_dma.getSrcMemrefDim(i));
+            src_indices.push_back(sink_op_dma.getSrcMemrefDim(i));
+          }
+          for (unsigned i = 0; i < numDimsDst; i++) {
+            sink_op_scalar_outs.push_back(sink_op_dma.getDstMemrefDim(i));
+            dst_indices.push_back(sink_op_dma.getDstMemrefDim(i));
+          }
         }
-
-        // If the sink op is arith::MulIOp
-        else if (auto sink_op_arith = dyn_cast<arith::MulIOp>(sink_op)) {
-          sink_op_scalar_ins.push_back(sink_op_arith.getLhs());
-          sink_op_scalar_ins.push_back(sink_op_arith.getRhs());
-          sink_op_scalar_outs.push_back(sink_op_arith.getResult());
+        partialMemref tile_in = createPartialMemref(
+            sink_op_dma.getSrcMemref(), numDimsSrc, src_indices);
+        partialMemref tile_out = createPartialMemref(
+            sink_op_dma.getDstMemref(), numDimsDst, dst_indices);
+        if (auto sink_op_nddma = dyn_cast<air::DmaMemcpyNdOp>(sink_op)) {
+          setPartialMemrefRegion(tile_in, sink_op_nddma.getSrcOffsets(),
+                                 sink_op_nddma.getSrcSizes(),
+                                 sink_op_nddma.getSrcStrides());
+          setPartialMemrefRegion(tile_out, sink_op_nddma.getDstOffsets(),
+                                 sink_op_nddma.getDstSizes(),
+                                 sink_op_nddma.getDstStrides());
         }
+        sink_op_memref_reads.push_back(tile_in);
+        sink_op_memref_writes.push_back(tile_out);
+      }
 
-        // If the sink op is arith::AddIOp
-        else if (auto sink_op_arith = dyn_cast<arith::AddIOp>(sink_op)) {
-          sink_op_scalar_ins.push_back(sink_op_arith.getLhs());
-          sink_op_scalar_ins.push_back(sink_op_arith.getRhs());
-          sink_op_scalar_outs.push_back(sink_op_arith.getResult());
+      // If the sink op is channel put
+      else if (auto sink_op_channel_put =
+                   dyn_cast<air::ChannelPutOp>(sink_op)) {
+        unsigned numDimsSrc = sink_op_channel_put.getSrc()
+                                  .getType()
+                                  .cast<MemRefType>()
+                                  .getRank();
+        for (unsigned i = 0; i < sink_op_channel_put.getSrcOffsets().size();
+             i++)
+          sink_op_scalar_ins.push_back(sink_op_channel_put.getSrcOffsets()[i]);
+        for (unsigned i = 0; i < sink_op_channel_put.getSrcSizes().size(); i++)
+          sink_op_scalar_ins.push_back(sink_op_channel_put.getSrcSizes()[i]);
+        for (unsigned i = 0; i < sink_op_channel_put.getSrcStrides().size();
+             i++)
+          sink_op_scalar_ins.push_back(sink_op_channel_put.getSrcStrides()[i]);
+        SmallVector<Value, 2> src_indices;
+        if (sink_op_channel_put.getSrcOffsets().size()) {
+          for (unsigned i = 0; i < numDimsSrc; i++) {
+            src_indices.push_back(sink_op_channel_put.getSrcOffsets()[i]);
+          }
+        } else {
+          for (unsigned i = 0; i < numDimsSrc; i++) {
+            src_indices.push_back(nullptr);
+          }
         }
+        partialMemref tile_in = createPartialMemref(
+            sink_op_channel_put.getSrc(), numDimsSrc, src_indices);
+        setPartialMemrefRegion(tile_in, sink_op_channel_put.getSrcOffsets(),
+                               sink_op_channel_put.getSrcSizes(),
+                               sink_op_channel_put.getSrcStrides());
+        sink_op_memref_reads.push_back(tile_in);
+      }
 
-        // If the sink op is mlir::AffineApplyOp
-        else if (auto sink_op_apply = dyn_cast<mlir::AffineApplyOp>(sink_op)) {
-          for (auto applyop_operand : sink_op_apply.getMapOperands()) {
-            sink_op_scalar_ins.push_back(applyop_operand);
+      // If the sink op is channel get
+      else if (auto sink_op_channel_get =
+                   dyn_cast<air::ChannelGetOp>(sink_op)) {
+        unsigned numDimsDst = sink_op_channel_get.getDst()
+                                  .getType()
+                                  .cast<MemRefType>()
+                                  .getRank();
+        for (unsigned i = 0; i < sink_op_channel_get.getDstOffsets().size();
+             i++)
+          sink_op_scalar_outs.push_back(sink_op_channel_get.getDstOffsets()[i]);
+        for (unsigned i = 0; i < sink_op_channel_get.getDstSizes().size(); i++)
+          sink_op_scalar_outs.push_back(sink_op_channel_get.getDstSizes()[i]);
+        for (unsigned i = 0; i < sink_op_channel_get.getDstStrides().size();
+             i++)
+          sink_op_scalar_outs.push_back(sink_op_channel_get.getDstStrides()[i]);
+        SmallVector<Value, 2> dst_indices;
+        if (sink_op_channel_get.getDstOffsets().size()) {
+          for (unsigned i = 0; i < numDimsDst; i++) {
+            dst_indices.push_back(sink_op_channel_get.getDstOffsets()[i]);
+          }
+        } else {
+          for (unsigned i = 0; i < numDimsDst; i++) {
+            dst_indices.push_back(nullptr);
           }
-          sink_op_scalar_outs.push_back(sink_op_apply.getResult());
         }
+        partialMemref tile_out = createPartialMemref(
+            sink_op_channel_get.getDst(), numDimsDst, dst_indices);
+        setPartialMemrefRegion(tile_out, sink_op_channel_get.getDstOffsets(),
+                               sink_op_channel_get.getDstSizes(),
+                               sink_op_channel_get.getDstStrides());
+        sink_op_memref_writes.push_back(tile_out);
+      }
+
+      // If the sink op is arith::MulIOp
+      else if (auto sink_op_arith = dyn_cast<arith::MulIOp>(sink_op)) {
+        sink_op_scalar_ins.push_back(sink_op_arith.getLhs());
+        sink_op_scalar_ins.push_back(sink_op_arith.getRhs());
+        sink_op_scalar_outs.push_back(sink_op_arith.getResult());
+      }
+
+      // If the sink op is arith::AddIOp
+      else if (auto sink_op_arith = dyn_cast<arith::AddIOp>(sink_op)) {
+        sink_op_scalar_ins.push_back(sink_op_arith.getLhs());
+        sink_op_scalar_ins.push_back(sink_op_arith.getRhs());
+        sink_op_scalar_outs.push_back(sink_op_arith.getResult());
+      }
 
-        // If the sink op is an unknown op
-        else {
-          for (auto sink_op_op : sink_op->getOperands()) {
-            if (sink_op_op.getType().isa<MemRefType>()) {
+      // If the sink op is mlir::AffineApplyOp
+      else if (auto sink_op_apply = dyn_cast<mlir::AffineApplyOp>(sink_op)) {
+        for (auto applyop_operand : sink_op_apply.getMapOperands()) {
+          sink_op_scalar_ins.push_back(applyop_operand);
+        }
+        sink_op_scalar_outs.push_back(sink_op_apply.getResult());
+      }
+
+      // If the sink op is an unknown op
+      else {
+        for (auto sink_op_op : sink_op->getOperands()) {
+          if (sink_op_op.getType().isa<MemRefType>()) {
+            unsigned memRefRank =
+                sink_op_op.getType().cast<MemRefType>().getRank();
+            partialMemref tile = createPartialMemref(sink_op_op, memRefRank);
+            sink_op_memref_reads.push_back(
+                tile); // Assuming all operands are both read and written to
+            sink_op_memref_writes.push_back(tile);
+          } else if (sink_op_op.getType().isa<IndexType>()) {
+            sink_op_scalar_ins.push_back(
+                sink_op_op); // Assuming all operands are both read and
+                             // written to
+            sink_op_scalar_outs.push_back(sink_op_op);
+          }
+        }
+        if (sink_op->getNumResults()) {
+          for (auto sink_op_results : sink_op->getResults()) {
+            if (sink_op_results.getType().isa<MemRefType>()) {
               unsigned memRefRank =
-                  sink_op_op.getType().cast<MemRefType>().getRank();
-              partialMemref tile = createPartialMemref(sink_op_op, memRefRank);
-              sink_op_memref_reads.push_back(
-                  tile); // Assuming all operands are both read and written to
+                  sink_op_results.getType().cast<MemRefType>().getRank();
+              partialMemref tile =
+                  createPartialMemref(sink_op_results, memRefRank);
               sink_op_memref_writes.push_back(tile);
-            } else if (sink_op_op.getType().isa<IndexType>()) {
-              sink_op_scalar_ins.push_back(
-                  sink_op_op); // Assuming all operands are both read and
-                               // written to
-              sink_op_scalar_outs.push_back(sink_op_op);
-            }
-          }
-          if (sink_op->getNumResults()) {
-            for (auto sink_op_results : sink_op->getResults()) {
-              if (sink_op_results.getType().isa<MemRefType>()) {
-                unsigned memRefRank =
-                    sink_op_results.getType().cast<MemRefType>().getRank();
-                partialMemref tile =
-                    createPartialMemref(sink_op_results, memRefRank);
-                sink_op_memref_writes.push_back(tile);
-              } else if (sink_op_results.getType().isa<IndexType>()) {
-                sink_op_scalar_outs.push_back(sink_op_results);
-              }
+            } else if (sink_op_results.getType().isa<IndexType>()) {
+              sink_op_scalar_outs.push_back(sink_op_results);
             }
           }
         }
+      }
 
-        // Detect dependencies
-        if (auto async_execute_op = dyn_cast<air::ExecuteOp>(op)) {
-          // Detect RAW deps
-          traceDeps<air::ExecuteOp>(sink_op_memref_reads, async_execute_op,
-                                    "RAW");
-          // Detect WAW and WAR deps
-          traceDeps<air::ExecuteOp>(sink_op_memref_writes, async_execute_op,
-                                    "WAW/WAR");
-          // Detect tile index deps
-          traceTileIndices(sink_op_memref_reads, sink_op_memref_writes,
-                           sink_op_scalar_ins, sink_op_scalar_outs,
-                           async_execute_op);
-          // Keep track of processed async execute region ops. Deps should point
-          // to the past, not future.
-          async_execute_op_history.push_back(async_execute_op);
-        } else if (auto dma_op =
-                       mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(op)) {
-          traceDeps<air::DmaMemcpyInterface>(sink_op_memref_reads, dma_op,
-                                             "RAW");
-          traceDeps<air::DmaMemcpyInterface>(sink_op_memref_writes, dma_op,
-                                             "WAW/WAR");
-          traceTileIndices(sink_op_memref_reads, sink_op_memref_writes,
-                           sink_op_scalar_ins, sink_op_scalar_outs, dma_op);
-          dma_op_history.push_back(dma_op);
-        } else if (auto channel_op =
-                       mlir::dyn_cast<xilinx::air::ChannelInterface>(op)) {
-          traceDeps<air::ChannelInterface>(sink_op_memref_reads, channel_op,
-                                           "RAW");
-          traceDeps<air::ChannelInterface>(sink_op_memref_writes, channel_op,
+      // Detect dependencies
+      if (auto async_execute_op = dyn_cast<air::ExecuteOp>(op)) {
+        // Detect RAW deps
+        traceDeps<air::ExecuteOp>(sink_op_memref_reads, async_execute_op,
+                                  "RAW");
+        // Detect WAW and WAR deps
+        traceDeps<air::ExecuteOp>(sink_op_memref_writes, async_execute_op,
+                                  "WAW/WAR");
+        // Detect tile index deps
+        traceTileIndices(sink_op_memref_reads, sink_op_memref_writes,
+                         sink_op_scalar_ins, sink_op_scalar_outs,
+                         async_execute_op);
+        // Keep track of processed async execute region ops. Deps should point
+        // to the past, not future.
+        async_execute_op_history.push_back(async_execute_op);
+        indexMemrefAccesses(op);
+      } else if (auto dma_op =
+                     mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(op)) {
+        traceDeps<air::DmaMemcpyInterface>(sink_op_memref_reads, dma_op, "RAW");
+        traceDeps<air::DmaMemcpyInterface>(sink_op_memref_writes, dma_op,
                                            "WAW/WAR");
-          traceTileIndices(sink_op_memref_reads, sink_op_memref_writes,
-                           sink_op_scalar_ins, sink_op_scalar_outs, channel_op);
-          channel_op_history.push_back(channel_op);
-        } else if (auto hier_op = dyn_cast<air::HierarchyInterface>(op)) {
-          hier_op_history.push_back(hier_op);
-        }
-      });
-    }
+        traceTileIndices(sink_op_memref_reads, sink_op_memref_writes,
+                         sink_op_scalar_ins, sink_op_scalar_outs, dma_op);
+        dma_op_history.push_back(dma_op);
+        indexMemrefAccesses(op);
+      } else if (auto channel_op =
+                     mlir::dyn_cast<xilinx::air::ChannelInterface>(op)) {
+        traceDeps<air::ChannelInterface>(sink_op_memref_reads, channel_op,
+                                         "RAW");
+        traceDeps<air::ChannelInterface>(sink_op_memref_writes, channel_op,
+                                         "WAW/WAR");
+        traceTileIndices(sink_op_memref_reads, sink_op_memref_writes,
+                         sink_op_scalar_ins, sink_op_scalar_outs, channel_op);
+        channel_op_history.push_back(channel_op);
+        indexMemrefAccesses(op);
+      } else if (auto hier_op = dyn_cast<air::HierarchyInterface>(op)) {
+        hier_op_history.push_back(hier_op);
+        indexMemrefAccesses(op);
+      }
+    });
 
     // 3rd traversal: perform transitive reduction on dependency graph.
 
-    std::vector<size_t> id_map(num_vertices(asyncExecuteGraph));
-    std::iota(id_map.begin(), id_map.end(), 0u);
-
-    transitive_reduction(asyncExecuteGraph, asyncExecuteGraphTR,
-                         make_assoc_property_map(g_to_tr), id_map.data());
+    transitiveReduction(asyncExecuteGraph, asyncExecuteGraphTR, g_to_tr);
 
     for (vertex_map::iterator i = g_to_tr.begin(); i != g_to_tr.end(); ++i) {
       // Copy over graph properties
@@ -587,104 +578,99 @@ public:
       tr_to_g[i->second] = i->first;
     }
 
-    for (auto f : module.getOps<func::FuncOp>()) {
-      f.walk([&](Operation *op) {
-        // Fill dep list of air execute ops
-        if (auto async_execute_op = dyn_cast<air::ExecuteOp>(op)) {
-          fillAIRDepListUsingGraphTR<air::ExecuteOp>(async_execute_op);
-        }
-        // Fill dep list of air dmamemcpy2d ops
-        else if (auto dma_op = dyn_cast<air::DmaMemcpyInterface>(op)) {
-          fillAIRDepListUsingGraphTR<air::DmaMemcpyInterface>(dma_op);
-        }
-        // Fill dep list of air channel ops
-        else if (auto channel_op = dyn_cast<air::ChannelInterface>(op)) {
-          fillAIRDepListUsingGraphTR<air::ChannelInterface>(channel_op);
-        }
-        // Fill dep list of air hierarchy ops
-        else if (auto hier_op = dyn_cast<air::HierarchyInterface>(op)) {
-          fillAIRDepListUsingGraphTR<air::HierarchyInterface>(hier_op);
-        }
-      });
-    }
+    f.walk([&](Operation *op) {
+      // Fill dep list of air execute ops
+      if (auto async_execute_op = dyn_cast<air::ExecuteOp>(op)) {
+        fillAIRDepListUsingGraphTR<air::ExecuteOp>(async_execute_op);
+      }
+      // Fill dep list of air dmamemcpy2d ops
+      else if (auto dma_op = dyn_cast<air::DmaMemcpyInterface>(op)) {
+        fillAIRDepListUsingGraphTR<air::DmaMemcpyInterface>(dma_op);
+      }
+      // Fill dep list of air channel ops
+      else if (auto channel_op = dyn_cast<air::ChannelInterface>(op)) {
+        fillAIRDepListUsingGraphTR<air::ChannelInterface>(channel_op);
+      }
+      // Fill dep list of air hierarchy ops
+      else if (auto hier_op = dyn_cast<air::HierarchyInterface>(op)) {
+        fillAIRDepListUsingGraphTR<air::HierarchyInterface>(hier_op);
+      }
+    });
 
     // 4th traversal: loop-carried deps.
     // Add wait_all events to collect sinks in loop bodies. Add iter_args to scp
     // for loops representing loop-carried deps.
 
-    for (auto f : module.getOps<func::FuncOp>()) {
-      f.walk([&](Operation *op) {
-        if (scf::ForOp for_op = dyn_cast<scf::ForOp>(op)) {
+    f.walk([&](Operation *op) {
+      if (scf::ForOp for_op = dyn_cast<scf::ForOp>(op)) {
 
-          bool hasAsyncTokensInBody = false;
-          SmallVector<Value, 1> yielded_tokens_in_for_op;
+        bool hasAsyncTokensInBody = false;
+        SmallVector<Value, 1> yielded_tokens_in_for_op;
 
-          // Conservative loop-carried dependency: no pipelining
-          // TODO: loop pipelining support
-          for (auto async_op : for_op.getOps<air::AsyncOpInterface>()) {
-            hasAsyncTokensInBody = true;
-            auto token = async_op.getOperation()->getResult(0);
-            if (!isNotLoopCarriedOp(async_op) &&
-                isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody())) {
-              yielded_tokens_in_for_op.push_back(token);
-            }
+        // Conservative loop-carried dependency: no pipelining
+        // TODO: loop pipelining support
+        for (auto async_op : for_op.getOps<air::AsyncOpInterface>()) {
+          hasAsyncTokensInBody = true;
+          auto token = async_op.getOperation()->getResult(0);
+          if (!isNotLoopCarriedOp(async_op) &&
+              isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody())) {
+            yielded_tokens_in_for_op.push_back(token);
           }
-          for (auto child_for_op : for_op.getOps<scf::ForOp>()) {
-            hasAsyncTokensInBody = true;
-            if (auto token = child_for_op.getResult(0)) {
-              if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
-                yielded_tokens_in_for_op.push_back(token);
-            }
+        }
+        for (auto child_for_op : for_op.getOps<scf::ForOp>()) {
+          hasAsyncTokensInBody = true;
+          if (auto token = child_for_op.getResult(0)) {
+            if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
+              yielded_tokens_in_for_op.push_back(token);
           }
-          for (auto child_parallel_op : for_op.getOps<scf::ParallelOp>()) {
-            hasAsyncTokensInBody = true;
-            if (auto token = child_parallel_op.getResult(0)) {
-              if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
-                yielded_tokens_in_for_op.push_back(token);
-            }
+        }
+        for (auto child_parallel_op : for_op.getOps<scf::ParallelOp>()) {
+          hasAsyncTokensInBody = true;
+          if (auto token = child_parallel_op.getResult(0)) {
+            if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
+              yielded_tokens_in_for_op.push_back(token);
           }
+        }
 
-          if (hasAsyncTokensInBody) {
-            insertLoopCarriedDeps(module_builder, for_op,
-                                  yielded_tokens_in_for_op);
-          }
+        if (hasAsyncTokensInBody) {
+          insertLoopCarriedDeps(func_builder, for_op, yielded_tokens_in_for_op);
         }
+      }
 
-        else if (scf::ParallelOp for_op = dyn_cast<scf::ParallelOp>(op)) {
+      else if (scf::ParallelOp for_op = dyn_cast<scf::ParallelOp>(op)) {
 
-          bool hasAsyncTokensInBody = false;
-          SmallVector<Value, 1> yielded_tokens_in_parallel_op;
+        bool hasAsyncTokensInBody = false;
+        SmallVector<Value, 1> yielded_tokens_in_parallel_op;
 
-          for (auto async_op : for_op.getOps<air::AsyncOpInterface>()) {
-            hasAsyncTokensInBody = true;
-            auto token = async_op.getOperation()->getResult(0);
-            if (!isNotLoopCarriedOp(async_op) &&
-                isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody())) {
-              yielded_tokens_in_parallel_op.push_back(token);
-            }
+        for (auto async_op : for_op.getOps<air::AsyncOpInterface>()) {
+          hasAsyncTokensInBody = true;
+          auto token = async_op.getOperation()->getResult(0);
+          if (!isNotLoopCarriedOp(async_op) &&
+              isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody())) {
+            yielded_tokens_in_parallel_op.push_back(token);
           }
-          for (auto child_for_op : for_op.getOps<scf::ForOp>()) {
-            hasAsyncTokensInBody = true;
-            if (auto token = child_for_op.getResult(0)) {
-              if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
-                yielded_tokens_in_parallel_op.push_back(token);
-            }
+        }
+        for (auto child_for_op : for_op.getOps<scf::ForOp>()) {
+          hasAsyncTokensInBody = true;
+          if (auto token = child_for_op.getResult(0)) {
+            if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
+              yielded_tokens_in_parallel_op.push_back(token);
           }
-          for (auto child_parallel_op : for_op.getOps<scf::ParallelOp>()) {
-            hasAsyncTokensInBody = true;
-            if (auto token = child_parallel_op.getResult(0)) {
-              if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
-                yielded_tokens_in_parallel_op.push_back(token);
-            }
+        }
+        for (auto child_parallel_op : for_op.getOps<scf::ParallelOp>()) {
+          hasAsyncTokensInBody = true;
+          if (auto token = child_parallel_op.getResult(0)) {
+            if (isOnlyUsedByNoLoopCarryOpsInBlock(token, for_op.getBody()))
+              yielded_tokens_in_parallel_op.push_back(token);
           }
+        }
 
-          if (hasAsyncTokensInBody) {
-            insertLoopCarriedDeps(module_builder, for_op,
-                                  yielded_tokens_in_parallel_op);
-          }
+        if (hasAsyncTokensInBody) {
+          insertLoopCarriedDeps(func_builder, for_op,
+                                yielded_tokens_in_parallel_op);
         }
-      });
-    }
+      }
+    });
   }
 
 private:
@@ -697,6 +683,8 @@ private:
   std::vector<air::DmaMemcpyInterface> dma_op_history;
   std::vector<air::ChannelInterface> channel_op_history;
   std::vector<air::HierarchyInterface> hier_op_history;
+  // Ops of the above histories, for constant-time lookups
+  DenseSet<Operation *> processed_async_ops;
 
   // Create air execute op with async interface (no ssa result returned); update
   // graph
@@ -983,6 +971,12 @@ private:
     Value memrefValue;
     unsigned numDims;
     SmallVector<Value, 2> memrefIndices;
+    // Offsets, sizes and strides of the accessed region, if known. Kept when
+    // tracing past a hierarchy op, whose operand is then accessed through
+    // the region for some hierarchy ids.
+    SmallVector<Value, 4> regionOffsets;
+    SmallVector<Value, 4> regionSizes;
+    SmallVector<Value, 4> regionStrides;
   };
 
   partialMemref createPartialMemref(mlir::Value memrefValue, unsigned numDims) {
@@ -1006,6 +1000,13 @@ private:
     return tile;
   }
 
+  void setPartialMemrefRegion(partialMemref &tile, OperandRange offsets,
+                              OperandRange sizes, OperandRange strides) {
+    tile.regionOffsets.assign(offsets.begin(), offsets.end());
+    tile.regionSizes.assign(sizes.begin(), sizes.end());
+    tile.regionStrides.assign(strides.begin(), strides.end());
+  }
+
   // Check if operand is returned from ExecuteOp (memref.alloc)
   template <typename T> void pushDefiningOpAsDep(Value operand, T op) {
     // Check memref deps
@@ -1099,232 +1100,183 @@ private:
       return 'w';
   }
 
-  // Trace operand's uses at current scope
-  template <typename T>
-  void pushDepsAtCurrentScope(mlir::Value operand, T op, char rw = 'n',
-                              partialMemref *tile = nullptr) {
-    if (!operand.getType().isa<MemRefType>()) {
-      operand.getDefiningOp()->emitOpError(
-          "operand being traced is not a memref");
-    }
-    for (auto &u : operand.getUses()) {
-      // If used in DmaMemcpy Op
-      if (auto dma = dyn_cast<xilinx::air::DmaMemcpyInterface>(u.getOwner())) {
-        if (foundAsyncOpUsesAboveCurrentLine(
-                &dma)) { // If this use is above current line
-          // DMA2D: Need to check for overlapping partial memrefs in use
-          unsigned numDimsSrc = dma.getNumDims();
-          unsigned numDimsDst = dma.getNumDims();
-          if (numDimsSrc == 0)
-            numDimsSrc =
-                dma.getSrcMemref().getType().cast<MemRefType>().getRank();
-          if (numDimsDst == 0)
-            numDimsDst =
-                dma.getDstMemref().getType().cast<MemRefType>().getRank();
-          SmallVector<Value, 2> src_indices;
-          SmallVector<Value, 2> dst_indices;
-          if (auto nddma =
-                  dyn_cast<xilinx::air::DmaMemcpyNdOp>(dma.getOperation())) {
-            if (nddma.getSrcOffsets().size()) {
-              for (unsigned i = 0; i < numDimsSrc; i++) {
-                src_indices.push_back(nddma.getSrcOffsets()[i]);
-              }
-            } else {
-              for (unsigned i = 0; i < numDimsSrc; i++) {
-                src_indices.push_back(nullptr);
-              }
-            }
-            if (nddma.getDstOffsets().size()) {
-              for (unsigned i = 0; i < numDimsDst; i++) {
-                dst_indices.push_back(nddma.getDstOffsets()[i]);
-              }
-            } else {
-              for (unsigned i = 0; i < numDimsDst; i++) {
-                dst_indices.push_back(nullptr);
-              }
-            }
-          } else {
-            for (unsigned i = 0; i < numDimsSrc; i++) {
-              src_indices.push_back(dma.getSrcMemrefDim(i));
-            }
-            for (unsigned i = 0; i < numDimsDst; i++) {
-              dst_indices.push_back(dma.getDstMemrefDim(i));
-            }
+  // Memref access by an async op which has already been traced
+  struct memrefAccess {
+    // Async token of the accessing op
+    Value token;
+    // 'r' for read, 'w' for write, 'n' for read and write
+    char rw;
+    // Whether `tile` holds the accessed tile, known for air.dma_memcpy and
+    // air.channel ops; other accesses are assumed to overlap any tile
+    bool hasTile;
+    partialMemref tile;
+  };
+
+  // Keys: memref; mapped: accesses by traced async ops, in program order.
+  // Filled as the async ops of a function are traced, so that a sink op only
+  // visits the prior accesses to its operands.
+  DenseMap<Value, SmallVector<memrefAccess, 4>> memref_accesses;
+
+  void addMemrefAccess(Value memref, Value token, char rw,
+                       partialMemref *tile = nullptr) {
+    memrefAccess access;
+    access.token = token;
+    access.rw = rw;
+    access.hasTile = tile != nullptr;
+    if (tile)
+      access.tile = *tile;
+    memref_accesses[memref].push_back(access);
+  }
+
+  // Add the memref accesses of a traced async op to the access index
+  void indexMemrefAccesses(Operation *op) {
+    processed_async_ops.insert(op);
+    Value token = op->getResult(0);
+    if (auto dma = dyn_cast<xilinx::air::DmaMemcpyInterface>(op)) {
+      // DMA2D: Need to check for overlapping partial memrefs in use
+      unsigned numDimsSrc = dma.getNumDims();
+      unsigned numDimsDst = dma.getNumDims();
+      if (numDimsSrc == 0)
+        numDimsSrc = dma.getSrcMemref().getType().cast<MemRefType>().getRank();
+      if (numDimsDst == 0)
+        numDimsDst = dma.getDstMemref().getType().cast<MemRefType>().getRank();
+      SmallVector<Value, 2> src_indices;
+      SmallVector<Value, 2> dst_indices;
+      if (auto nddma = dyn_cast<xilinx::air::DmaMemcpyNdOp>(op)) {
+        if (nddma.getSrcOffsets().size()) {
+          for (unsigned i = 0; i < numDimsSrc; i++) {
+            src_indices.push_back(nddma.getSrcOffsets()[i]);
           }
-          partialMemref dma_src =
-              createPartialMemref(dma.getSrcMemref(), numDimsSrc, src_indices);
-          partialMemref dma_dst =
-              createPartialMemref(dma.getDstMemref(), numDimsDst, dst_indices);
-
-          if (rw == 'r') {
-            if (u.is(dma.getSrcMemref())) {
-              if (tile == nullptr) {
-                addAsyncDepToGraphIfNew<T>(dma.getOperation()->getResult(0),
-                                           op);
-              } else if (areEqualIndexPartialMemrefs(tile, &dma_src))
-                addAsyncDepToGraphIfNew<T>(dma.getOperation()->getResult(0),
-                                           op);
-            }
-          } else if (rw == 'w') {
-            if (u.is(dma.getDstMemref())) {
-              if (tile == nullptr) {
-                addAsyncDepToGraphIfNew<T>(dma.getOperation()->getResult(0),
-                                           op);
-              } else if (areEqualIndexPartialMemrefs(tile, &dma_dst))
-                addAsyncDepToGraphIfNew<T>(dma.getOperation()->getResult(0),
-                                           op);
-            }
-          } else {
-            if (tile == nullptr) {
-              addAsyncDepToGraphIfNew<T>(dma.getOperation()->getResult(0), op);
-            } else if (u.is(dma.getDstMemref())) {
-              if (areEqualIndexPartialMemrefs(tile, &dma_dst))
-                addAsyncDepToGraphIfNew<T>(dma.getOperation()->getResult(0),
-                                           op);
-            } else if (u.is(dma.getSrcMemref())) {
-              if (areEqualIndexPartialMemrefs(tile, &dma_src))
-                addAsyncDepToGraphIfNew<T>(dma.getOperation()->getResult(0),
-                                           op);
-            }
+        } else {
+          for (unsigned i = 0; i < numDimsSrc; i++) {
+            src_indices.push_back(nullptr);
+          }
+        }
+        if (nddma.getDstOffsets().size()) {
+          for (unsigned i = 0; i < numDimsDst; i++) {
+            dst_indices.push_back(nddma.getDstOffsets()[i]);
           }
+        } else {
+          for (unsigned i = 0; i < numDimsDst; i++) {
+            dst_indices.push_back(nullptr);
+          }
+        }
+      } else {
+        for (unsigned i = 0; i < numDimsSrc; i++) {
+          src_indices.push_back(dma.getSrcMemrefDim(i));
+        }
+        for (unsigned i = 0; i < numDimsDst; i++) {
+          dst_indices.push_back(dma.getDstMemrefDim(i));
         }
       }
-      // Else if used in Channel Op
-      else if (auto channel =
-                   dyn_cast<xilinx::air::ChannelInterface>(u.getOwner())) {
-        if (foundAsyncOpUsesAboveCurrentLine(
-                &channel)) { // If this use is above current line
-          // Channel op: Need to check for overlapping partial memrefs in use
-          if (auto channel_put =
-                  dyn_cast<xilinx::air::ChannelPutOp>(channel.getOperation())) {
-            unsigned numDimsSrc =
-                channel_put.getSrc().getType().cast<MemRefType>().getRank();
-            SmallVector<Value, 2> src_indices;
-            if (channel_put.getSrcOffsets().size()) {
-              for (unsigned i = 0; i < numDimsSrc; i++) {
-                src_indices.push_back(channel_put.getSrcOffsets()[i]);
-              }
-            } else {
-              for (unsigned i = 0; i < numDimsSrc; i++) {
-                src_indices.push_back(nullptr);
-              }
-            }
-            partialMemref channel_put_src = createPartialMemref(
-                channel_put.getSrc(), numDimsSrc, src_indices);
-
-            if (rw == 'r') {
-              if (u.is(channel_put.getSrc())) {
-                if (tile == nullptr) {
-                  addAsyncDepToGraphIfNew<T>(
-                      channel_put.getOperation()->getResult(0), op);
-                } else if (areEqualIndexPartialMemrefs(tile, &channel_put_src))
-                  addAsyncDepToGraphIfNew<T>(
-                      channel_put.getOperation()->getResult(0), op);
-              }
-            } else if (rw == 'w') {
-            } else {
-              if (tile == nullptr) {
-                addAsyncDepToGraphIfNew<T>(
-                    channel_put.getOperation()->getResult(0), op);
-              } else if (u.is(channel_put.getSrc())) {
-                if (areEqualIndexPartialMemrefs(tile, &channel_put_src))
-                  addAsyncDepToGraphIfNew<T>(
-                      channel_put.getOperation()->getResult(0), op);
-              }
-            }
-          } else if (auto channel_get = dyn_cast<xilinx::air::ChannelGetOp>(
-                         channel.getOperation())) {
-            unsigned numDimsDst =
-                channel_get.getDst().getType().cast<MemRefType>().getRank();
-            SmallVector<Value, 2> dst_indices;
-            if (channel_get.getDstOffsets().size()) {
-              for (unsigned i = 0; i < numDimsDst; i++) {
-                dst_indices.push_back(channel_get.getDstOffsets()[i]);
-              }
-            } else {
-              for (unsigned i = 0; i < numDimsDst; i++) {
-                dst_indices.push_back(nullptr);
-              }
-            }
-            partialMemref channel_get_dst = createPartialMemref(
-                channel_get.getDst(), numDimsDst, dst_indices);
-
-            if (rw == 'r') {
-            } else if (rw == 'w') {
-              if (u.is(channel_get.getDst())) {
-                if (tile == nullptr) {
-                  addAsyncDepToGraphIfNew<T>(
-                      channel_get.getOperation()->getResult(0), op);
-                } else if (areEqualIndexPartialMemrefs(tile, &channel_get_dst))
-                  addAsyncDepToGraphIfNew<T>(
-                      channel_get.getOperation()->getResult(0), op);
-              }
-            } else {
-              if (tile == nullptr) {
-                addAsyncDepToGraphIfNew<T>(
-                    channel_get.getOperation()->getResult(0), op);
-              } else if (u.is(channel_get.getDst())) {
-                if (areEqualIndexPartialMemrefs(tile, &channel_get_dst))
-                  addAsyncDepToGraphIfNew<T>(
-                      channel_get.getOperation()->getResult(0), op);
-              }
-            }
-          } else
-            channel->emitOpError("unknown air channel op");
+      partialMemref dma_src =
+          createPartialMemref(dma.getSrcMemref(), numDimsSrc, src_indices);
+      partialMemref dma_dst =
+          createPartialMemref(dma.getDstMemref(), numDimsDst, dst_indices);
+      if (auto nddma = dyn_cast<xilinx::air::DmaMemcpyNdOp>(op)) {
+        setPartialMemrefRegion(dma_src, nddma.getSrcOffsets(),
+                               nddma.getSrcSizes(), nddma.getSrcStrides());
+        setPartialMemrefRegion(dma_dst, nddma.getDstOffsets(),
+                               nddma.getDstSizes(), nddma.getDstStrides());
+      }
+      addMemrefAccess(dma.getSrcMemref(), token, 'r', &dma_src);
+      addMemrefAccess(dma.getDstMemref(), token, 'w', &dma_dst);
+    } else if (auto channel_put = dyn_cast<xilinx::air::ChannelPutOp>(op)) {
+      // Channel op: Need to check for overlapping partial memrefs in use
+      unsigned numDimsSrc =
+          channel_put.getSrc().getType().cast<MemRefType>().getRank();
+      SmallVector<Value, 2> src_indices;
+      if (channel_put.getSrcOffsets().size()) {
+        for (unsigned i = 0; i < numDimsSrc; i++) {
+          src_indices.push_back(channel_put.getSrcOffsets()[i]);
+        }
+      } else {
+        for (unsigned i = 0; i < numDimsSrc; i++) {
+          src_indices.push_back(nullptr);
         }
       }
-
-      // If used in a linalg op
-      else if (auto linalgop = mlir::dyn_cast<linalg::LinalgOp>(u.getOwner())) {
-        if (auto ar =
-                dyn_cast<xilinx::air::ExecuteOp>(linalgop->getParentOp())) {
-          if (foundAsyncOpUsesAboveCurrentLine(&ar)) {
-            if (rw == 'r') {
-              if (u.getOperandNumber() <
-                  linalgop.getNumDpsInputs() + linalgop.getNumDpsInits())
-                addAsyncDepToGraphIfNew<T>(ar.getResult(0), op);
-            } else if (rw == 'w') {
-              if (u.getOperandNumber() >= linalgop.getNumDpsInputs() &&
-                  u.getOperandNumber() - linalgop.getNumDpsInputs() <
-                      linalgop.getNumDpsInits())
-                addAsyncDepToGraphIfNew<T>(ar.getResult(0), op);
-            } else {
-              addAsyncDepToGraphIfNew<T>(ar.getResult(0), op);
-            }
-          }
+      partialMemref channel_put_src =
+          createPartialMemref(channel_put.getSrc(), numDimsSrc, src_indices);
+      setPartialMemrefRegion(channel_put_src, channel_put.getSrcOffsets(),
+                             channel_put.getSrcSizes(),
+                             channel_put.getSrcStrides());
+      addMemrefAccess(channel_put.getSrc(), token, 'r', &channel_put_src);
+    } else if (auto channel_get = dyn_cast<xilinx::air::ChannelGetOp>(op)) {
+      unsigned numDimsDst =
+          channel_get.getDst().getType().cast<MemRefType>().getRank();
+      SmallVector<Value, 2> dst_indices;
+      if (channel_get.getDstOffsets().size()) {
+        for (unsigned i = 0; i < numDimsDst; i++) {
+          dst_indices.push_back(channel_get.getDstOffsets()[i]);
+        }
+      } else {
+        for (unsigned i = 0; i < numDimsDst; i++) {
+          dst_indices.push_back(nullptr);
         }
       }
-
-      // If used in hierarchy op
-      else if (auto hier =
-                   dyn_cast<xilinx::air::HierarchyInterface>(u.getOwner())) {
-        if (foundAsyncOpUsesAboveCurrentLine(&hier)) {
-          // check if the use inside hierarchy op matches with the tracing mode
-          // (r or w)
-          for (unsigned hier_argument_id = 0;
-               hier_argument_id < hier.getNumKernelOperands();
-               hier_argument_id++) {
-            if (u.is(hier.getKernelOperand(hier_argument_id))) {
-              auto child_op = hier.getKernelArgument(hier_argument_id);
-              char rw_check = checkOperandReadOrWrite(child_op);
-              if (rw == 'n' || rw_check == rw) {
-                addAsyncDepToGraphIfNew<T>(hier->getResult(0), op);
-              }
+      partialMemref channel_get_dst =
+          createPartialMemref(channel_get.getDst(), numDimsDst, dst_indices);
+      setPartialMemrefRegion(channel_get_dst, channel_get.getDstOffsets(),
+                             channel_get.getDstSizes(),
+                             channel_get.getDstStrides());
+      addMemrefAccess(channel_get.getDst(), token, 'w', &channel_get_dst);
+    } else if (isa<xilinx::air::ChannelInterface>(op)) {
+      op->emitOpError("unknown air channel op");
+    } else if (auto hier = dyn_cast<xilinx::air::HierarchyInterface>(op)) {
+      // Classify the use by the accesses made inside the hierarchy op
+      for (unsigned hier_argument_id = 0;
+           hier_argument_id < hier.getNumKernelOperands(); hier_argument_id++) {
+        auto hier_operand = hier.getKernelOperand(hier_argument_id);
+        if (!hier_operand.getType().isa<MemRefType>())
+          continue;
+        auto child_op = hier.getKernelArgument(hier_argument_id);
+        addMemrefAccess(hier_operand, token, checkOperandReadOrWrite(child_op));
+      }
+    } else if (auto async_execute_op = dyn_cast<xilinx::air::ExecuteOp>(op)) {
+      for (auto &bb : async_execute_op.getBody()) {
+        for (auto &child_op : bb.getOperations()) {
+          for (auto &u : child_op.getOpOperands()) {
+            if (!u.get().getType().isa<MemRefType>())
+              continue;
+            // If used in a linalg op, inputs are read and inits are read and
+            // written
+            if (auto linalgop = dyn_cast<linalg::LinalgOp>(child_op)) {
+              char rw = u.getOperandNumber() < linalgop.getNumDpsInputs()
+                            ? 'r'
+                            : 'n';
+              addMemrefAccess(u.get(), token, rw);
             }
+            // If used in an unknown op, then assume read and write access
+            else
+              addMemrefAccess(u.get(), token, 'n');
           }
         }
       }
+    }
+  }
 
-      // If used in an unknown op
-      else {
-        auto unknownop = u.getOwner();
-        if (auto ar =
-                dyn_cast<xilinx::air::ExecuteOp>(unknownop->getParentOp())) {
-          if (foundAsyncOpUsesAboveCurrentLine(&ar)) {
-            addAsyncDepToGraphIfNew<T>(ar.getResult(0), op);
-          }
-        }
-      }
+  // Trace operand's accesses at current scope
+  template <typename T>
+  void pushDepsAtCurrentScope(mlir::Value operand, T op, char rw = 'n',
+                              partialMemref *tile = nullptr) {
+    if (!operand.getType().isa<MemRefType>()) {
+      operand.getDefiningOp()->emitOpError(
+          "operand being traced is not a memref");
+    }
+    auto it = memref_accesses.find(operand);
+    if (it == memref_accesses.end())
+      return;
+    // Visit the latest accesses first, in the order of the memref's use list,
+    // whose uses were created by the async ops in program order
+    for (auto &access : llvm::reverse(it->second)) {
+      // Check if the access matches with the tracing mode (r or w)
+      if (rw != 'n' && access.rw != 'n' && access.rw != rw)
+        continue;
+      // Check for overlapping partial memrefs in use
+      if (tile != nullptr && access.hasTile &&
+          !areEqualIndexPartialMemrefs(tile, &access.tile))
+        continue;
+      addAsyncDepToGraphIfNew<T>(access.token, op);
     }
   }
 
@@ -1360,6 +1312,9 @@ private:
             auto ancestor_op = hier.getKernelOperand(hier_operand_id);
             partialMemref ancestor_operand =
                 createPartialMemref(ancestor_op, operand.numDims);
+            ancestor_operand.regionOffsets = operand.regionOffsets;
+            ancestor_operand.regionSizes = operand.regionSizes;
+            ancestor_operand.regionStrides = operand.regionStrides;
             SmallVector<partialMemref, 1> ancestor_operands = {
                 ancestor_operand};
             traceDeps<air::HierarchyInterface>(ancestor_operands, hier,
@@ -1879,6 +1834,35 @@ private:
   operation_id_to_vertex_map
       wa_to_g; // Map between air wait_all and vertices in graph
 
+  // Ids of the async events created in the function
+  uint64_t ExecuteOpID = 0;
+  uint64_t HierarchyOpID = 0;
+  uint64_t WaitAllOpID = 0;
+  uint64_t ChannelOpID = 0;
+
+  // Drop the state of the previously processed function
+  void resetState() {
+    asyncExecuteGraph.clear();
+    asyncExecuteGraphTR.clear();
+    g_to_tr.clear();
+    tr_to_g.clear();
+    region_to_g.clear();
+    dma_to_g.clear();
+    channel_to_g.clear();
+    hier_to_g.clear();
+    wa_to_g.clear();
+    ExecuteOpID = 0;
+    HierarchyOpID = 0;
+    WaitAllOpID = 0;
+    ChannelOpID = 0;
+    async_execute_op_history.clear();
+    dma_op_history.clear();
+    channel_op_history.clear();
+    hier_op_history.clear();
+    processed_async_ops.clear();
+    memref_accesses.clear();
+  }
+
   // g vertex to air op mapping
   air::ExecuteOp getExecuteOpFromVertex(Graph::vertex_descriptor v, Graph g) {
     assert(g[v].asyncEventType == "execute" &&
@@ -2031,38 +2015,24 @@ private:
   //===----------------------------------------------------------------------===//
 
   bool foundAsyncOpUsesAboveCurrentLine(air::ExecuteOp *op) {
-    if (!async_execute_op_history.empty())
-      for (auto &iter : async_execute_op_history)
-        if (iter.getResult(0) == op->getResult(0))
-          return true;
-    return false;
+    return processed_async_ops.count(op->getOperation());
   }
 
   bool foundAsyncOpUsesAboveCurrentLine(air::DmaMemcpyInterface *op) {
-    if (!dma_op_history.empty())
-      for (auto &iter : dma_op_history)
-        if (iter->getResult(0) == op->getOperation()->getResult(0))
-          return true;
-    return false;
+    return processed_async_ops.count(op->getOperation());
   }
 
   bool foundAsyncOpUsesAboveCurrentLine(air::ChannelInterface *op) {
-    if (!channel_op_history.empty())
-      for (auto &iter : channel_op_history)
-        if (iter->getResult(0) == op->getOperation()->getResult(0))
-          return true;
-    return false;
+    return processed_async_ops.count(op->getOperation());
   }
 
   bool foundAsyncOpUsesAboveCurrentLine(air::HierarchyInterface *op) {
-    if (!hier_op_history.empty())
-      for (auto &iter : hier_op_history)
-        if (iter->getResult(0) == op->getOperation()->getResult(0))
-          return true;
-    return false;
+    return processed_async_ops.count(op->getOperation());
   }
 
-  // Check if two partial memref tiles have identical indices
+  // Check if two partial memref tiles have identical indices, and their
+  // regions are not proven disjoint by affine analysis of their offsets,
+  // sizes and strides
   bool areEqualIndexPartialMemrefs(partialMemref *tile_0,
                                    partialMemref *tile_1) {
     if (tile_0->numDims != tile_1->numDims) {
@@ -2075,6 +2045,10 @@ private:
           return false;
       }
     }
+    if (areDisjointMemrefRegions(tile_0->regionOffsets, tile_0->regionSizes,
+                                 tile_0->regionStrides, tile_1->regionOffsets,
+                                 tile_1->regionSizes, tile_1->regionStrides))
+      return false;
     return true;
   }
 
@@ -35,35 +35,36 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-
-    for (auto func : module.getOps<func::FuncOp>()) {
-      // Pre processing
-      // Re-trace ops which depend on air.hierarchies
-      // (Removes obsolete dep edges after -canonicalize)
-      canonicalizer.redoDepTraceIfDepOnHier(func);
-
-      // Parse dependency graphs
-      hostGraph = dependencyGraph(func, true);
-      canonicalizer.parseCommandGraphs(func, hostGraph, dep_ctx);
-
-      // Transitive reduction
-      xilinx::air::dependencyGraph trHostGraph;
-      canonicalizer.canonicalizeGraphs(hostGraph, trHostGraph, g_to_tr);
-
-      // Post processing
-      // Update dependency list
-      canonicalizer.updateDepList(func, trHostGraph);
-
-      // Clean up
-      canonicalizer.removeUnusedExecuteOp(func);
-      canonicalizer.removeRedundantWaitAllOps(func);
-      canonicalizer.removeDepListRepetition(func);
-
-      if (clDumpGraph) {
-        // Dump graphs
-        canonicalizer.dumpDotGraphFiles(trHostGraph, clDumpDir);
-      }
+    auto func = getOperation();
+
+    // Pre processing
+    // Re-trace ops which depend on air.hierarchies
+    // (Removes obsolete dep edges after -canonicalize)
+    canonicalizer.redoDepTraceIfDepOnHier(func);
+
+    // Parse dependency graphs. The pass instance is reused across the
+    // functions it is scheduled on, so the graphs and op ids start afresh.
+    hostGraph = dependencyGraph(func, true);
+    dep_ctx = dependencyContext();
+    g_to_tr = vertex_to_vertex_map_tree();
+    canonicalizer.parseCommandGraphs(func, hostGraph, dep_ctx);
+
+    // Transitive reduction
+    xilinx::air::dependencyGraph trHostGraph;
+    canonicalizer.canonicalizeGraphs(hostGraph, trHostGraph, g_to_tr);
+
+    // Post processing
+    // Update dependency list
+    canonicalizer.updateDepList(func, trHostGraph);
+
+    // Clean up
+    canonicalizer.removeUnusedExecuteOp(func);
+    canonicalizer.removeRedundantWaitAllOps(func);
+    canonicalizer.removeDepListRepetition(func);
+
+    if (clDumpGraph) {
+      // Dump graphs
+      canonicalizer.dumpDotGraphFiles(trHostGraph, clDumpDir);
     }
   }
 
@@ -1165,8 +1165,9 @@ private:
 struct UnrollChannelByFactorPattern {
 
 public:
-  void runUnrollChannelByFactorPattern(func::FuncOp funcOp, Operation *op,
-                                       int chanDim, int factor) {
+  void runUnrollChannelByFactorPattern(
+      func::FuncOp funcOp, Operation *op, int chanDim, int factor,
+      air::ChannelSymbolUses *channel_uses = nullptr) {
     air::ChannelOp chan_op = dyn_cast<air::ChannelOp>(op);
     OpBuilder builder(op);
     SmallVector<int64_t, 2> sizes = extractFromI64ArrayAttr(chan_op.getSize());
@@ -1180,15 +1181,19 @@ public:
 
     this->dim = chanDim;
     this->factor = factor;
+    this->channel_uses = channel_uses;
 
     // Update channel declaration
     sizes[chanDim] *= factor;
-    builder.create<air::ChannelOp>(op->getLoc(), chan_op.getSymName().str(),
-                                   builder.getI64ArrayAttr(sizes));
+    auto new_chan_op = builder.create<air::ChannelOp>(
+        op->getLoc(), chan_op.getSymName().str(),
+        builder.getI64ArrayAttr(sizes));
 
     // Add scf.parallel to unroll channel puts and gets
-    auto puts = air::getChannelPutOpThroughSymbol(chan_op);
-    auto gets = air::getChannelGetOpThroughSymbol(chan_op);
+    auto puts =
+        air::getChannelPutOpThroughSymbol(chan_op, nullptr, channel_uses);
+    auto gets =
+        air::getChannelGetOpThroughSymbol(chan_op, nullptr, channel_uses);
     for (auto put : puts) {
       builder.setInsertionPoint(put);
       auto init_val =
@@ -1205,17 +1210,28 @@ public:
     }
 
     for (auto put : puts) {
-      put->erase();
+      eraseChannelOp(put);
     }
     for (auto get : gets) {
-      get->erase();
+      eraseChannelOp(get);
     }
-    op->erase();
+    eraseChannelOp(op);
+    if (channel_uses)
+      channel_uses->insert(new_chan_op);
   }
 
 private:
   int dim = 0;
   int factor = 1;
+  // Channel index to keep up to date with the channel ops created and erased,
+  // if any
+  air::ChannelSymbolUses *channel_uses = nullptr;
+
+  void eraseChannelOp(Operation *op) {
+    if (channel_uses)
+      channel_uses->erase(op);
+    op->erase();
+  }
 
   Value createWaitAllToCollectIncomingTokens(OpBuilder builder, Operation *op) {
     auto async_op = dyn_cast<air::AsyncOpInterface>(op);
@@ -1310,6 +1326,8 @@ private:
     auto new_op = builder.create<T>(
         par.getLoc(), tys, merged_incoming_token, op.getChanName(),
         new_channel_idx, op.getMemref(), new_offsets, new_sizes, new_strides);
+    if (channel_uses)
+      channel_uses->insert(new_op);
 
     // Create scf::ReduceOp
     air::createSCFReduceForAsyncSCFParallel(
@@ -1562,11 +1580,8 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      runOptPatterns(f);
+    auto f = getOperation();
+    runOptPatterns(f);
   }
 
 private:
@@ -1581,11 +1596,8 @@ public:
 
   void runOnOperation() override {
     BroadcastDetection proc;
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      proc.runBroadcastPattern(f);
+    auto f = getOperation();
+    proc.runBroadcastPattern(f);
   }
 
 private:
@@ -1601,11 +1613,8 @@ public:
 
   void runOnOperation() override {
     PruneLinalgGenericInputDma proc;
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      proc.runLinalgGenericPattern(f);
+    auto f = getOperation();
+    proc.runLinalgGenericPattern(f);
   }
 
 private:
@@ -1628,11 +1637,8 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      runOptPatterns(f);
+    auto f = getOperation();
+    runOptPatterns(f);
   }
 
 private:
@@ -1654,11 +1660,8 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      runOptPatterns(f);
+    auto f = getOperation();
+    runOptPatterns(f);
   }
 
 private:
@@ -1681,11 +1684,8 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      runOptPatterns(f);
+    auto f = getOperation();
+    runOptPatterns(f);
   }
 
 private:
@@ -1701,8 +1701,8 @@ public:
       const AIRUnrollLoopForPipeliningPattern &pass){};
 
   void runOnOperation() override {
-    auto module = getOperation();
-    module.walk([&](scf::ForOp for_op) {
+    auto f = getOperation();
+    f.walk([&](scf::ForOp for_op) {
       // Check if loop is the target
       if (for_op->hasAttr("unroll")) {
         uint64_t unroll_factor =
@@ -1735,11 +1735,8 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      runOptPatterns(f);
+    auto f = getOperation();
+    runOptPatterns(f);
   }
 
 private:
@@ -1812,21 +1809,13 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      runIsolateScfForOpForPingPong(f);
-    for (auto f : funcOps)
-      runOpAnnotationPatterns(f);
-    for (auto f : funcOps)
-      runLoopUnroll(f);
-    for (auto f : funcOps)
-      runHoistMemallocPatterns(f);
-    for (auto f : funcOps)
-      runConstructPingPongDependencyPatterns(f);
-    for (auto f : funcOps)
-      runCleanUpAttrs(f);
+    auto f = getOperation();
+    runIsolateScfForOpForPingPong(f);
+    runOpAnnotationPatterns(f);
+    runLoopUnroll(f);
+    runHoistMemallocPatterns(f);
+    runConstructPingPongDependencyPatterns(f);
+    runCleanUpAttrs(f);
   }
 
 private:
@@ -1849,11 +1838,8 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps)
-      runOptPatterns(f);
+    auto f = getOperation();
+    runOptPatterns(f);
   }
 
 private:
@@ -1886,8 +1872,9 @@ public:
     SmallVector<func::FuncOp, 4> funcOps;
     module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
     for (auto f : funcOps)
-      proc.runUnrollChannelByFactorPattern(f, chanOps.front(), clUnrollDim,
-                                           clUnrollFactor);
+      proc.runUnrollChannelByFactorPattern(
+          f, chanOps.front(), clUnrollDim, clUnrollFactor,
+          &getAnalysis<air::ChannelSymbolUses>());
   }
 
 private:
@@ -1923,14 +1910,10 @@ public:
   }
 
   void runOnOperation() override {
-    auto module = getOperation();
-    SmallVector<func::FuncOp, 4> funcOps;
-    module.walk([&](func::FuncOp op) { funcOps.push_back(op); });
-    for (auto f : funcOps) {
-      runOnFunction(f);
-      // Renumber the air dma op ids
-      xilinx::air::renumberDmaOps(f, "global");
-    }
+    auto f = getOperation();
+    runOnFunction(f);
+    // Renumber the air dma op ids
+    xilinx::air::renumberDmaOps(f, "global");
   }
 
 private:
@@ -51,6 +51,14 @@ static uint64_t getTensorVolume(const Type ty) {
   }
 }
 
+// Bytes accessed in memory per element of a tensor. Scalar operands are held
+// in registers, and access no memory.
+static uint64_t getElementBytes(const Type ty) {
+  if (auto t = ty.dyn_cast<ShapedType>())
+    return (t.getElementTypeBitWidth() + 7) / 8;
+  return 0;
+}
+
 
 void
 CostModel::getLinalgOpCounts(OpCountMap &map, linalg::LinalgOp op) {
@@ -68,6 +76,8 @@ CostModel::getLinalgOpCounts(OpCountMap &map, linalg::LinalgOp op) {
   int64_t iters = 1;
   int64_t reads = 0;
   int64_t writes = 0;
+  int64_t read_bytes = 0;
+  int64_t write_bytes = 0;
   uint64_t footprint = 0;
   for (auto size : shapeSizes) {
     if (auto v = size.dyn_cast<Value>()) {
@@ -96,18 +106,27 @@ CostModel::getLinalgOpCounts(OpCountMap &map, linalg::LinalgOp op) {
     map[s] = map[s] + 1;
   });
   for (auto &oper : op.getDpsInputOperands()) {
-    if (op.payloadUsesValueFromOperand(oper))
+    auto bytes = getElementBytes(oper->get().getType());
+    if (op.payloadUsesValueFromOperand(oper)) {
       reads++;
+      read_bytes += bytes;
+    }
     footprint += getTensorVolume(oper->get().getType());
   }
   for (auto &oper : op.getDpsInitOperands()) {
-    if (op.payloadUsesValueFromOperand(oper))
+    auto bytes = getElementBytes(oper->get().getType());
+    if (op.payloadUsesValueFromOperand(oper)) {
       reads++;
+      read_bytes += bytes;
+    }
     writes++;
+    write_bytes += bytes;
     footprint += getTensorVolume(oper->get().getType());
   }
   map.map.insert({"reads", reads});
   map.map.insert({"writes", writes});
+  map.map.insert({"read_bytes", read_bytes});
+  map.map.insert({"write_bytes", write_bytes});
   map.map.erase("linalg.yield");
 
   for (auto &m : map.map)
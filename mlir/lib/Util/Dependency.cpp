@@ -9,8 +9,19 @@
 #include "air/Util/Dependency.h"
 #include "air/Util/Util.h"
 
+#include "mlir/Analysis/Presburger/IntegerRelation.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <sys/stat.h>
 
 #define DEBUG_TYPE "air-dependency-util"
@@ -46,6 +57,254 @@ bool areEqualIndices(mlir::Value index_0, mlir::Value index_1) {
   }
 }
 
+namespace {
+
+// Affine forms of index values, over variables standing for the loop induction
+// variables, hierarchy ids and unknown values they are computed from. Equal
+// values share a variable.
+class affineIndexBuilder {
+
+public:
+  // Sum of coeffs[i] * variable i, plus constant
+  struct linearExpr {
+    std::map<unsigned, int64_t> coeffs;
+    int64_t constant = 0;
+
+    void add(const linearExpr &expr, int64_t factor) {
+      for (auto &coeff : expr.coeffs)
+        coeffs[coeff.first] += coeff.second * factor;
+      constant += expr.constant * factor;
+    }
+  };
+
+  // Add a variable ranging over [lb, ub]; unbounded if lb > ub
+  unsigned addVariable(int64_t lb = 1, int64_t ub = 0) {
+    bounds.push_back(std::make_pair(lb, ub));
+    return bounds.size() - 1;
+  }
+
+  linearExpr getExpr(Value v) {
+    auto it = value_exprs.find(v);
+    if (it != value_exprs.end())
+      return it->second;
+    linearExpr expr;
+    if (!getExprImpl(v, expr)) {
+      expr = linearExpr();
+      expr.coeffs[addVariable()] = 1;
+    }
+    value_exprs[v] = expr;
+    return expr;
+  }
+
+  std::optional<int64_t> getConstant(Value v) {
+    auto expr = getExpr(v);
+    if (!expr.coeffs.empty())
+      return std::nullopt;
+    return expr.constant;
+  }
+
+  // Check if no assignment of the variables within their bounds makes `expr`
+  // zero
+  bool isNeverZero(const linearExpr &expr) {
+    unsigned num_vars = bounds.size();
+    presburger::IntegerPolyhedron poly(
+        presburger::PresburgerSpace::getSetSpace(num_vars));
+    for (unsigned i = 0; i < num_vars; i++) {
+      if (bounds[i].first > bounds[i].second)
+        continue;
+      SmallVector<int64_t, 8> lb(num_vars + 1, 0);
+      lb[i] = 1;
+      lb[num_vars] = -bounds[i].first;
+      poly.addInequality(lb);
+      SmallVector<int64_t, 8> ub(num_vars + 1, 0);
+      ub[i] = -1;
+      ub[num_vars] = bounds[i].second;
+      poly.addInequality(ub);
+    }
+    SmallVector<int64_t, 8> eq(num_vars + 1, 0);
+    for (auto &coeff : expr.coeffs)
+      eq[coeff.first] = coeff.second;
+    eq[num_vars] = expr.constant;
+    poly.addEquality(eq);
+    return poly.isIntegerEmpty();
+  }
+
+private:
+  std::vector<std::pair<int64_t, int64_t>> bounds;
+  llvm::DenseMap<Value, linearExpr> value_exprs;
+
+  bool getExprImpl(Value v, linearExpr &expr) {
+    if (auto const_op = v.getDefiningOp<arith::ConstantIndexOp>()) {
+      expr.constant = const_op.value();
+      return true;
+    }
+    // Index computations are wrapped in air.execute by air-dependency
+    if (auto execute_op = v.getDefiningOp<air::ExecuteOp>()) {
+      unsigned result_id = v.cast<OpResult>().getResultNumber();
+      if (result_id == 0)
+        return false;
+      auto terminator = execute_op.getBody().front().getTerminator();
+      expr = getExpr(terminator->getOperand(result_id - 1));
+      return true;
+    }
+    if (auto add_op = v.getDefiningOp<arith::AddIOp>()) {
+      expr.add(getExpr(add_op.getLhs()), 1);
+      expr.add(getExpr(add_op.getRhs()), 1);
+      return true;
+    }
+    if (auto sub_op = v.getDefiningOp<arith::SubIOp>()) {
+      expr.add(getExpr(sub_op.getLhs()), 1);
+      expr.add(getExpr(sub_op.getRhs()), -1);
+      return true;
+    }
+    if (auto mul_op = v.getDefiningOp<arith::MulIOp>()) {
+      auto lhs = getExpr(mul_op.getLhs());
+      auto rhs = getExpr(mul_op.getRhs());
+      if (lhs.coeffs.empty())
+        std::swap(lhs, rhs);
+      if (!rhs.coeffs.empty())
+        return false;
+      expr.add(lhs, rhs.constant);
+      return true;
+    }
+    if (auto apply_op = v.getDefiningOp<mlir::AffineApplyOp>()) {
+      auto map = apply_op.getAffineMap();
+      if (map.getNumResults() != 1)
+        return false;
+      SmallVector<linearExpr, 4> operands;
+      for (auto operand : apply_op.getMapOperands())
+        operands.push_back(getExpr(operand));
+      return getAffineExprImpl(map.getResult(0), operands, map.getNumDims(),
+                               expr);
+    }
+    auto arg = v.dyn_cast<BlockArgument>();
+    if (!arg)
+      return false;
+    auto parent_op = arg.getOwner()->getParentOp();
+    if (auto hier = dyn_cast<air::HierarchyInterface>(parent_op)) {
+      for (unsigned i = 0; i < hier.getNumDims(); i++) {
+        if (arg == hier.getSize()[i]) {
+          expr = getExpr(hier.getSizeOperands()[i]);
+          return true;
+        }
+        if (arg != hier.getIds()[i])
+          continue;
+        auto size = getConstant(hier.getSizeOperands()[i]);
+        if (!size || *size <= 0)
+          return false;
+        expr.coeffs[addVariable(0, *size - 1)] = 1;
+        return true;
+      }
+    } else if (auto for_op = dyn_cast<scf::ForOp>(parent_op)) {
+      if (arg == for_op.getInductionVar())
+        return getInductionVarExpr(for_op.getLowerBound(),
+                                   for_op.getUpperBound(), for_op.getStep(),
+                                   expr);
+    } else if (auto par_op = dyn_cast<scf::ParallelOp>(parent_op)) {
+      for (unsigned i = 0; i < par_op.getNumLoops(); i++)
+        if (arg == par_op.getInductionVars()[i])
+          return getInductionVarExpr(par_op.getLowerBound()[i],
+                                     par_op.getUpperBound()[i],
+                                     par_op.getStep()[i], expr);
+    }
+    return false;
+  }
+
+  // Induction variable lb + step * t, for 0 <= t < ceil((ub - lb) / step)
+  bool getInductionVarExpr(Value lb, Value ub, Value step, linearExpr &expr) {
+    auto lb_const = getConstant(lb);
+    auto ub_const = getConstant(ub);
+    auto step_const = getConstant(step);
+    if (!lb_const || !ub_const || !step_const || *step_const <= 0 ||
+        *ub_const <= *lb_const)
+      return false;
+    int64_t trip_count =
+        (*ub_const - *lb_const + *step_const - 1) / *step_const;
+    expr.coeffs[addVariable(0, trip_count - 1)] = *step_const;
+    expr.constant = *lb_const;
+    return true;
+  }
+
+  bool getAffineExprImpl(AffineExpr affine_expr,
+                         ArrayRef<linearExpr> operands, unsigned num_dims,
+                         linearExpr &expr) {
+    if (auto const_expr = affine_expr.dyn_cast<AffineConstantExpr>()) {
+      expr.constant = const_expr.getValue();
+      return true;
+    }
+    if (auto dim_expr = affine_expr.dyn_cast<AffineDimExpr>()) {
+      expr = operands[dim_expr.getPosition()];
+      return true;
+    }
+    if (auto sym_expr = affine_expr.dyn_cast<AffineSymbolExpr>()) {
+      expr = operands[num_dims + sym_expr.getPosition()];
+      return true;
+    }
+    auto bin_expr = affine_expr.dyn_cast<AffineBinaryOpExpr>();
+    if (!bin_expr)
+      return false;
+    linearExpr lhs, rhs;
+    if (!getAffineExprImpl(bin_expr.getLHS(), operands, num_dims, lhs) ||
+        !getAffineExprImpl(bin_expr.getRHS(), operands, num_dims, rhs))
+      return false;
+    if (affine_expr.getKind() == AffineExprKind::Add) {
+      expr.add(lhs, 1);
+      expr.add(rhs, 1);
+      return true;
+    }
+    if (affine_expr.getKind() == AffineExprKind::Mul) {
+      if (lhs.coeffs.empty())
+        std::swap(lhs, rhs);
+      if (!rhs.coeffs.empty())
+        return false;
+      expr.add(lhs, rhs.constant);
+      return true;
+    }
+    // floordiv, ceildiv and mod are not linear
+    return false;
+  }
+};
+
+} // namespace
+
+// Check if two regions of a memref, each addressing the elements
+// sum_i (offsets[i] + k_i) * strides[i] for 0 <= k_i < sizes[i], are disjoint
+// for all values of the loop induction variables and hierarchy ids their
+// offsets depend on. Sizes and strides must be constants.
+bool areDisjointMemrefRegions(ArrayRef<Value> offsets_0,
+                              ArrayRef<Value> sizes_0,
+                              ArrayRef<Value> strides_0,
+                              ArrayRef<Value> offsets_1,
+                              ArrayRef<Value> sizes_1,
+                              ArrayRef<Value> strides_1) {
+  if (offsets_0.empty() || offsets_1.empty())
+    return false;
+  if (offsets_0.size() != sizes_0.size() ||
+      offsets_0.size() != strides_0.size() ||
+      offsets_1.size() != sizes_1.size() ||
+      offsets_1.size() != strides_1.size())
+    return false;
+  affineIndexBuilder builder;
+  // Address in region 0 minus address in region 1
+  affineIndexBuilder::linearExpr diff;
+  auto addRegion = [&](ArrayRef<Value> offsets, ArrayRef<Value> sizes,
+                       ArrayRef<Value> strides, int64_t sign) {
+    for (unsigned i = 0; i < offsets.size(); i++) {
+      auto size = builder.getConstant(sizes[i]);
+      auto stride = builder.getConstant(strides[i]);
+      if (!size || !stride || *size <= 0)
+        return false;
+      diff.add(builder.getExpr(offsets[i]), sign * *stride);
+      diff.coeffs[builder.addVariable(0, *size - 1)] += sign * *stride;
+    }
+    return true;
+  };
+  if (!addRegion(offsets_0, sizes_0, strides_0, 1) ||
+      !addRegion(offsets_1, sizes_1, strides_1, -1))
+    return false;
+  return builder.isNeverZero(diff);
+}
+
 // Recursively check for dependency to loop induction vars arising from dma src
 void traceDependentInductionVar(air::DmaMemcpyInterface async_op,
                                 SmallVector<Value, 1> &loop_dep_history,
@@ -486,25 +745,167 @@ bool isAsyncOp(Operation *op) {
 // Dependency graph as a Boost graph object
 //===----------------------------------------------------------------------===//
 
+std::string stringifyDependencyEventType(dependencyEventType type) {
+  switch (type) {
+  case dependencyEventType::Start:
+    return "start";
+  case dependencyEventType::Dma:
+    return "dma";
+  case dependencyEventType::Channel:
+    return "channel";
+  case dependencyEventType::Hierarchy:
+    return "hierarchy";
+  case dependencyEventType::HierarchyTerminator:
+    return "hierarchy_terminator";
+  case dependencyEventType::Terminator:
+    return "terminator";
+  case dependencyEventType::ForLoop:
+    return "for_loop";
+  case dependencyEventType::ParallelLoop:
+    return "parallel_loop";
+  case dependencyEventType::Execute:
+    return "execute";
+  case dependencyEventType::WaitAll:
+    return "wait_all";
+  case dependencyEventType::Unknown:
+    break;
+  }
+  return "";
+}
+
+dependencyEventType symbolizeDependencyEventType(llvm::StringRef type) {
+  return llvm::StringSwitch<dependencyEventType>(type)
+      .Case("start", dependencyEventType::Start)
+      .Case("dma", dependencyEventType::Dma)
+      .Case("channel", dependencyEventType::Channel)
+      .Case("hierarchy", dependencyEventType::Hierarchy)
+      .Case("hierarchy_terminator", dependencyEventType::HierarchyTerminator)
+      .Case("terminator", dependencyEventType::Terminator)
+      .Case("for_loop", dependencyEventType::ForLoop)
+      .Case("parallel_loop", dependencyEventType::ParallelLoop)
+      .Case("execute", dependencyEventType::Execute)
+      .Case("wait_all", dependencyEventType::WaitAll)
+      .Default(dependencyEventType::Unknown);
+}
+
+std::string graphNodeProperties::getColor(dependencyNodeCategory category) {
+  switch (category) {
+  case dependencyNodeCategory::Hierarchy:
+    return "yellow";
+  case dependencyNodeCategory::Control:
+    return "crimson";
+  case dependencyNodeCategory::Data:
+    return "cyan";
+  case dependencyNodeCategory::Compute:
+    return "chartreuse";
+  case dependencyNodeCategory::None:
+    break;
+  }
+  return "";
+}
+
+std::string graphNodeProperties::getShape(dependencyNodeCategory category) {
+  switch (category) {
+  case dependencyNodeCategory::Hierarchy:
+  case dependencyNodeCategory::Control:
+    return "box";
+  case dependencyNodeCategory::Data:
+  case dependencyNodeCategory::Compute:
+    return "oval";
+  case dependencyNodeCategory::None:
+    break;
+  }
+  return "";
+}
+
+namespace {
+// String pool backing dependencyNodeEntry names and descriptions. Strings are
+// appended to chunks which are never moved or freed, so that strings are read
+// without taking the lock which guards interning. Chunk i holds
+// firstChunkSize << i strings.
+struct dependencyStringPool {
+  static constexpr unsigned firstChunkSize = 1024;
+  static constexpr unsigned maxChunks = 22;
+
+  std::mutex mutex;
+  std::array<std::atomic<std::string *>, maxChunks> chunks{};
+  unsigned size = 0;
+  llvm::StringMap<unsigned> ids;
+
+  dependencyStringPool() {
+    // Reserve id 0 for the empty string, the default of every vertex
+    append("");
+    ids[""] = 0;
+  }
+
+  ~dependencyStringPool() {
+    for (auto &chunk : chunks)
+      delete[] chunk.load(std::memory_order_relaxed);
+  }
+
+  static std::pair<unsigned, unsigned> getChunkAndOffset(unsigned id) {
+    unsigned chunk = llvm::Log2_32(id / firstChunkSize + 1);
+    return {chunk, id - ((1u << chunk) - 1) * firstChunkSize};
+  }
+
+  // Append a string under the lock, publishing its chunk to readers
+  unsigned append(llvm::StringRef str) {
+    auto [chunk, offset] = getChunkAndOffset(size);
+    std::string *strings = chunks[chunk].load(std::memory_order_relaxed);
+    if (!strings) {
+      strings = new std::string[firstChunkSize << chunk];
+      chunks[chunk].store(strings, std::memory_order_release);
+    }
+    strings[offset] = str.str();
+    return size++;
+  }
+
+  const std::string &get(unsigned id) const {
+    auto [chunk, offset] = getChunkAndOffset(id);
+    return chunks[chunk].load(std::memory_order_acquire)[offset];
+  }
+};
+
+dependencyStringPool &getDependencyStringPool() {
+  static dependencyStringPool pool;
+  return pool;
+}
+} // namespace
+
+unsigned internDependencyString(llvm::StringRef str) {
+  if (str.empty())
+    return 0;
+  auto &pool = getDependencyStringPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  auto it = pool.ids.try_emplace(str, pool.size);
+  if (it.second)
+    pool.append(str);
+  return it.first->second;
+}
+
+// Ids are handed out after their string is written, and whoever holds an id
+// received it through the synchronization which published it, so reads need
+// no lock
+const std::string &getInternedDependencyString(unsigned id) {
+  return getDependencyStringPool().get(id);
+}
+
 void dependencyCanonicalizer::parseCommandGraphs(func::FuncOp &toplevel,
                                                  dependencyGraph &global_graph,
                                                  dependencyContext &dep_ctx,
                                                  std::string granularity,
                                                  bool dump_dot,
-                                                 std::string dump_dir) {
-  // Graph parsing granularity. Tuple format: <expandLaunch, expandSegment,
-  // expandHerd, expandCore>
-  graphGranularityProperties expandHier = {true, true, true, false};
-  if (granularity == "herd") {
-    std::get<2>(expandHier) = true;
-    std::get<3>(expandHier) = false;
-  } else if (granularity == "core") {
-    std::get<2>(expandHier) = true;
-    std::get<3>(expandHier) = true;
-  } else {
-    toplevel->emitOpError("unknown graph parsing granularity");
+                                                 std::string dump_dir,
+                                                 bool fold_cores) {
+  graphGranularityProperties expandHier;
+  if (failed(getGraphGranularity(toplevel, granularity, fold_cores,
+                                 expandHier)))
     return;
-  }
+
+  // Index the function's channel ops once for all channel vertices. Other
+  // functions are not walked, so that functions can be parsed concurrently.
+  dep_ctx.channel_uses = std::make_shared<ChannelSymbolUses>(
+      toplevel, /*enclosingDeclarations=*/true);
 
   // Create vertices for graphs
   // Build up host graph
@@ -528,54 +929,117 @@ void dependencyCanonicalizer::parseCommandGraphs(func::FuncOp &toplevel,
     }
   });
 
-  // Adds edges between async ops
+  // Adds edges between async ops of the host graph, and connect the start
+  // node per graph as graph inception point
   parseDependencyEdgesInGraph(global_graph.g, dep_ctx);
-  for (auto &G_l : global_graph.subgraphs) {
-    parseDependencyEdgesInGraph(G_l.g, dep_ctx);
-    for (auto &G_p : G_l.subgraphs) {
-      parseDependencyEdgesInGraph(G_p.g, dep_ctx);
-      for (auto &G_h : G_p.subgraphs) {
-        parseDependencyEdgesInGraph(G_h.g, dep_ctx);
-      }
+  connectStartNodeInCommandGraph(global_graph);
+  updatePointerFromGraphToHierarchyTerminator(global_graph);
+  updatePointerFromHierarchyOpToGraph(global_graph);
+  for (auto &launchGraph : global_graph.subgraphs)
+    connectHierarchyGraph(global_graph, launchGraph, dep_ctx);
+
+  if (dump_dot) {
+    // Dump dot graphs
+    dumpDotGraphFiles(global_graph, dump_dir);
+  }
+}
+
+bool dependencyCanonicalizer::reparseLaunchGraph(air::LaunchOp launch,
+                                                 dependencyGraph &global_graph,
+                                                 dependencyContext &dep_ctx,
+                                                 std::string granularity,
+                                                 bool fold_cores) {
+  graphGranularityProperties expandHier;
+  if (failed(getGraphGranularity(launch, granularity, fold_cores, expandHier)))
+    return false;
+  dependencyGraph *launch_graph = nullptr;
+  for (auto &G_l : global_graph.subgraphs)
+    if (G_l.hierarchyOp == launch.getOperation())
+      launch_graph = &G_l;
+  if (!launch_graph)
+    return false;
+
+  // Forget the vertices of the old graph and its subgraphs. Their ops may
+  // have been erased, so only the graphs they point to are looked at.
+  std::set<dependencyGraph *> old_graphs = {launch_graph};
+  for (auto &G_p : launch_graph->subgraphs) {
+    old_graphs.insert(&G_p);
+    for (auto &G_h : G_p.subgraphs)
+      old_graphs.insert(&G_h);
+  }
+  for (auto it = dep_ctx.op_to_g.begin(); it != dep_ctx.op_to_g.end();) {
+    if (old_graphs.count(it->second)) {
+      dep_ctx.op_to_v.erase(it->first);
+      it = dep_ctx.op_to_g.erase(it);
+    } else {
+      ++it;
     }
   }
 
-  // Connect leaf vertices to launch, segment and herd terminators
-  for (auto &G_l : global_graph.subgraphs) {
-    connectTerminatorInGraph(G_l.g);
-    for (auto &G_p : G_l.subgraphs) {
-      connectTerminatorInGraph(G_p.g);
-      for (auto &G_h : G_p.subgraphs) {
-        connectTerminatorInGraph(G_h.g);
-      }
+  // Rebuild the graph where it was, so that the pointer to it from the host
+  // graph stays valid. Ops get new ids, which do not clash with the ids of the
+  // ops of the other graphs.
+  *launch_graph = dependencyGraph(launch.getOperation(), true);
+  addVerticesInLaunchGraph(launch_graph, launch, dep_ctx, expandHier);
+  connectHierarchyGraph(global_graph, *launch_graph, dep_ctx);
+  return true;
+}
+
+// Graph parsing granularity. Tuple format: <expandLaunch, expandSegment,
+// expandHerd, expandCore, foldCores>
+LogicalResult dependencyCanonicalizer::getGraphGranularity(
+    Operation *op, std::string granularity, bool fold_cores,
+    graphGranularityProperties &expandHier) {
+  expandHier = {true, true, true, false, false};
+  if (granularity == "herd") {
+    std::get<2>(expandHier) = true;
+    std::get<3>(expandHier) = false;
+  } else if (granularity == "core") {
+    std::get<2>(expandHier) = true;
+    std::get<3>(expandHier) = true;
+    std::get<4>(expandHier) = fold_cores;
+  } else {
+    op->emitOpError("unknown graph parsing granularity");
+    return failure();
+  }
+  return success();
+}
+
+// Adds edges between the async ops of a launch, segment or herd graph and of
+// its subgraphs, connects their leaf vertices to their terminators and their
+// start nodes to their roots, and updates the pointers between the graphs
+void dependencyCanonicalizer::connectHierarchyGraph(dependencyGraph &parent,
+                                                    dependencyGraph &G,
+                                                    dependencyContext &dep_ctx) {
+  parseDependencyEdgesInGraph(G.g, dep_ctx);
+  for (auto &G_p : G.subgraphs) {
+    parseDependencyEdgesInGraph(G_p.g, dep_ctx);
+    for (auto &G_h : G_p.subgraphs) {
+      parseDependencyEdgesInGraph(G_h.g, dep_ctx);
     }
   }
 
-  // Connect the start node per graph as graph inception point;
-  // update pointer from graph to air.hierarchy op terminators
-  connectStartNodeInCommandGraph(global_graph);
-  updatePointerFromGraphToHierarchyTerminator(global_graph);
-  updatePointerFromHierarchyOpToGraph(global_graph);
-  for (auto &launchGraph : global_graph.subgraphs) {
-    connectStartNodeInCommandGraph(launchGraph);
-    updatePointerFromGraphToHierarchyTerminator(launchGraph);
-    updatePointerFromHierarchyTerminatorToGraph(global_graph, launchGraph);
-    updatePointerFromHierarchyOpToGraph(launchGraph);
-    for (auto &segmentGraph : launchGraph.subgraphs) {
-      connectStartNodeInCommandGraph(segmentGraph);
-      updatePointerFromGraphToHierarchyTerminator(segmentGraph);
-      updatePointerFromHierarchyTerminatorToGraph(launchGraph, segmentGraph);
-      updatePointerFromHierarchyOpToGraph(segmentGraph);
-      for (auto &herdGraph : segmentGraph.subgraphs) {
-        connectStartNodeInCommandGraph(herdGraph);
-        updatePointerFromGraphToHierarchyTerminator(herdGraph);
-      }
+  connectTerminatorInGraph(G.g);
+  for (auto &G_p : G.subgraphs) {
+    connectTerminatorInGraph(G_p.g);
+    for (auto &G_h : G_p.subgraphs) {
+      connectTerminatorInGraph(G_h.g);
     }
   }
 
-  if (dump_dot) {
-    // Dump dot graphs
-    dumpDotGraphFiles(global_graph, dump_dir);
+  connectStartNodeInCommandGraph(G);
+  updatePointerFromGraphToHierarchyTerminator(G);
+  updatePointerFromHierarchyTerminatorToGraph(parent, G);
+  updatePointerFromHierarchyOpToGraph(G);
+  for (auto &segmentGraph : G.subgraphs) {
+    connectStartNodeInCommandGraph(segmentGraph);
+    updatePointerFromGraphToHierarchyTerminator(segmentGraph);
+    updatePointerFromHierarchyTerminatorToGraph(G, segmentGraph);
+    updatePointerFromHierarchyOpToGraph(segmentGraph);
+    for (auto &herdGraph : segmentGraph.subgraphs) {
+      connectStartNodeInCommandGraph(herdGraph);
+      updatePointerFromGraphToHierarchyTerminator(herdGraph);
+    }
   }
 }
 
@@ -647,8 +1111,8 @@ void dependencyCanonicalizer::copyDependencyGraphToFlatGraphAndVisualize(
 
   auto vp = getVerticesWithAffineIf(global_graph.g, global_graph.position);
   for (auto vit : vp) {
-    if (global_graph.g[vit].asyncEventName == "LaunchOp") {
-      auto G_l = *global_graph.g[vit].nextDependencyGraphs[0];
+    if (global_graph.g[vit].getAsyncEventName() == "LaunchOp") {
+      auto &G_l = *global_graph.g[vit].nextDependencyGraphs[0];
       FlatGraph &flat_subg_l = flat_g.create_subgraph();
       updateSubgraphFromDependencyGraphAsGraphVizCluster(
           G_l, flat_subg_l, maps[index], index, idx_l, "launch");
@@ -658,8 +1122,8 @@ void dependencyCanonicalizer::copyDependencyGraphToFlatGraphAndVisualize(
       auto map_idx_launch = index++;
       auto vp_l = getVerticesWithAffineIf(G_l.g, G_l.position);
       for (auto vit_l : vp_l) {
-        if (G_l.g[vit_l].asyncEventName == "SegmentOp") {
-          auto G_p = *G_l.g[vit_l].nextDependencyGraphs[0];
+        if (G_l.g[vit_l].getAsyncEventName() == "SegmentOp") {
+          auto &G_p = *G_l.g[vit_l].nextDependencyGraphs[0];
           FlatGraph &flat_subg_p = flat_subg_l.create_subgraph();
           updateSubgraphFromDependencyGraphAsGraphVizCluster(
               G_p, flat_subg_p, maps[index], index, idx_p, "segment");
@@ -671,9 +1135,9 @@ void dependencyCanonicalizer::copyDependencyGraphToFlatGraphAndVisualize(
           auto map_idx_segment = index++;
           auto vp_p = getVerticesWithAffineIf(G_p.g, G_p.position);
           for (auto vit_p : vp_p) {
-            if (G_p.g[vit_p].asyncEventName == "HerdOp") {
+            if (G_p.g[vit_p].getAsyncEventName() == "HerdOp") {
               for (auto G_h_ptr : G_p.g[vit_p].nextDependencyGraphs) {
-                auto G_h = *G_h_ptr;
+                auto &G_h = *G_h_ptr;
                 FlatGraph &flat_subg_h = flat_subg_p.create_subgraph();
                 updateSubgraphFromDependencyGraphAsGraphVizCluster(
                     G_h, flat_subg_h, maps[index], index, idx_h, "herd");
@@ -684,9 +1148,9 @@ void dependencyCanonicalizer::copyDependencyGraphToFlatGraphAndVisualize(
               }
             }
           }
-        } else if (G_l.g[vit_l].asyncEventName == "HerdOp") {
+        } else if (G_l.g[vit_l].getAsyncEventName() == "HerdOp") {
           for (auto G_h_ptr : G_l.g[vit_l].nextDependencyGraphs) {
-            auto G_h = *G_h_ptr;
+            auto &G_h = *G_h_ptr;
             FlatGraph &flat_subg_h = flat_subg_l.create_subgraph();
             updateSubgraphFromDependencyGraphAsGraphVizCluster(
                 G_h, flat_subg_h, maps[index], index, idx_h, "herd");
@@ -697,8 +1161,8 @@ void dependencyCanonicalizer::copyDependencyGraphToFlatGraphAndVisualize(
           }
         }
       }
-    } else if (global_graph.g[vit].asyncEventName == "SegmentOp") {
-      auto G_p = *global_graph.g[vit].nextDependencyGraphs[0];
+    } else if (global_graph.g[vit].getAsyncEventName() == "SegmentOp") {
+      auto &G_p = *global_graph.g[vit].nextDependencyGraphs[0];
       FlatGraph &flat_subg_p = flat_g.create_subgraph();
       updateSubgraphFromDependencyGraphAsGraphVizCluster(
           G_p, flat_subg_p, maps[index], index, idx_p, "segment");
@@ -708,9 +1172,9 @@ void dependencyCanonicalizer::copyDependencyGraphToFlatGraphAndVisualize(
       auto map_idx_segment = index++;
       auto vp_p = getVerticesWithAffineIf(G_p.g, G_p.position);
       for (auto vit_p : vp_p) {
-        if (G_p.g[vit_p].asyncEventName == "HerdOp") {
+        if (G_p.g[vit_p].getAsyncEventName() == "HerdOp") {
           for (auto G_h_ptr : G_p.g[vit_p].nextDependencyGraphs) {
-            auto G_h = *G_h_ptr;
+            auto &G_h = *G_h_ptr;
             FlatGraph &flat_subg_h = flat_subg_p.create_subgraph();
             updateSubgraphFromDependencyGraphAsGraphVizCluster(
                 G_h, flat_subg_h, maps[index], index, idx_h, "herd");
@@ -721,9 +1185,9 @@ void dependencyCanonicalizer::copyDependencyGraphToFlatGraphAndVisualize(
           }
         }
       }
-    } else if (global_graph.g[vit].asyncEventName == "HerdOp") {
+    } else if (global_graph.g[vit].getAsyncEventName() == "HerdOp") {
       for (auto G_h_ptr : global_graph.g[vit].nextDependencyGraphs) {
-        auto G_h = *G_h_ptr;
+        auto &G_h = *G_h_ptr;
         FlatGraph &flat_subg_h = flat_g.create_subgraph();
         updateSubgraphFromDependencyGraphAsGraphVizCluster(
             G_h, flat_subg_h, maps[index], index, idx_h, "herd");
@@ -762,13 +1226,22 @@ void dependencyCanonicalizer::addVerticesInHerd(
   // Build up herd graph
   bool showCores = std::get<3>(expandHier);
   if (showCores) {
-    auto hier = dyn_cast<air::HierarchyInterface>(herd.getOperation());
-    for (unsigned i = 0; i < getTripCountInHierarchyOp(hier); i++) {
+    // Each core gets a graph of its own, unless folding cores, in which case
+    // only the first core of each class of symmetric cores does
+    std::vector<std::vector<unsigned>> core_classes;
+    if (std::get<4>(expandHier)) {
+      core_classes = getSymmetricCoreClasses(herd);
+    } else {
+      auto hier = dyn_cast<air::HierarchyInterface>(herd.getOperation());
+      for (unsigned i = 0; i < getTripCountInHierarchyOp(hier); i++)
+        core_classes.push_back({i});
+    }
+    for (auto &core_class : core_classes) {
       herd_subgraphs.push_back(dependencyGraph(herd.getOperation(), true));
       dependencyGraph *current_herd_graph = &(herd_subgraphs.back());
 
       // Core id
-      auto current_position = getPositionFromIterator(i, herd);
+      auto current_position = getPositionFromIterator(core_class[0], herd);
       auto &position_ref = current_herd_graph->position;
       // auto check_prod = 1;
       for (auto id : current_position) {
@@ -778,7 +1251,10 @@ void dependencyCanonicalizer::addVerticesInHerd(
       std::string position_str = "core position: ";
       position_str += toPositionString(current_position);
       current_herd_graph->g[current_herd_graph->start_vertex]
-          .detailed_description = position_str;
+          .setDetailedDescription(position_str);
+      for (unsigned i = 1; i < core_class.size(); i++)
+        current_herd_graph->folded_positions.push_back(
+            getPositionFromIterator(core_class[i], herd));
 
       herd.walk([&](Operation *herd_childop) {
         if (!dyn_cast<air::HerdOp>(herd_childop)) {
@@ -822,8 +1298,13 @@ void dependencyCanonicalizer::addVerticesInLaunch(
     dependencyContext &dep_ctx, graphGranularityProperties expandHier) {
   // Build up launch graph
   launch_subgraphs.push_back(dependencyGraph(launch.getOperation(), true));
-  dependencyGraph *current_launch_graph = &(launch_subgraphs.back());
+  addVerticesInLaunchGraph(&(launch_subgraphs.back()), launch, dep_ctx,
+                           expandHier);
+}
 
+void dependencyCanonicalizer::addVerticesInLaunchGraph(
+    dependencyGraph *current_launch_graph, air::LaunchOp launch,
+    dependencyContext &dep_ctx, graphGranularityProperties expandHier) {
   launch.walk([&](Operation *launch_childop) {
     if (!launch_childop->getParentOfType<air::SegmentOp>() &&
         !dyn_cast<air::LaunchOp>(launch_childop)) {
@@ -879,11 +1360,10 @@ Graph::vertex_descriptor dependencyCanonicalizer::addVertexFromOp(
   op->setAttr("id", mlir::IntegerAttr::get(
                         mlir::IntegerType::get(op->getContext(), 32), ++id));
   auto v = add_vertex(G->g);
-  G->g[v].asyncEventName = event_name;
-  G->g[v].asyncEventType = event_type;
-  G->g[v].color = properties.color;
-  G->g[v].shape = properties.shape;
-  G->g[v].detailed_description = properties.detailed_description;
+  G->g[v].setAsyncEventName(event_name);
+  G->g[v].asyncEventType = symbolizeDependencyEventType(event_type);
+  G->g[v].category = properties.category;
+  G->g[v].setDetailedDescription(properties.detailed_description);
   G->g[v].operationId = id;
   if (pointer_op)
     G->g[v].op = pointer_op;
@@ -917,7 +1397,8 @@ Graph::vertex_descriptor dependencyCanonicalizer::addVertexFromChannelOp(
     std::string memorySpaceSrcStr =
         getMemorySpaceAsString(channel_put.getSrc());
     std::vector<air::ChannelGetOp> channel_gets =
-        getTheOtherChannelOpThroughSymbol(channel_put);
+        getTheOtherChannelOpThroughSymbol(channel_put,
+                                          dep_ctx.channel_uses.get());
     if (!channel_gets.size())
       op->emitOpError("found channel op not in pairs");
     std::string memorySpaceDstStr =
@@ -925,7 +1406,8 @@ Graph::vertex_descriptor dependencyCanonicalizer::addVertexFromChannelOp(
     std::string event_name = "ChannelPutOp@" + channel_put.getChanName().str() +
                              "(" + memorySpaceSrcStr + "-->" +
                              memorySpaceDstStr + ")";
-    auto channel_op = getChannelDeclarationThroughSymbol(op);
+    auto channel_op =
+        getChannelDeclarationThroughSymbol(op, dep_ctx.channel_uses.get());
     std::string detailed_description = "";
     if (channel_op->hasAttr("broadcast_shape")) {
       auto size = extractFromI64ArrayAttr(channel_op.getSize());
@@ -953,7 +1435,8 @@ Graph::vertex_descriptor dependencyCanonicalizer::addVertexFromChannelOp(
     std::string memorySpaceDstStr =
         getMemorySpaceAsString(channel_get.getDst());
     std::vector<air::ChannelPutOp> channel_puts =
-        getTheOtherChannelOpThroughSymbol(channel_get);
+        getTheOtherChannelOpThroughSymbol(channel_get,
+                                          dep_ctx.channel_uses.get());
     if (!channel_puts.size())
       op->emitOpError("found channel op not in pairs");
     std::string memorySpaceSrcStr =
@@ -961,7 +1444,8 @@ Graph::vertex_descriptor dependencyCanonicalizer::addVertexFromChannelOp(
     std::string event_name = "ChannelGetOp@" + channel_get.getChanName().str() +
                              "(" + memorySpaceDstStr + "<--" +
                              memorySpaceSrcStr + ")";
-    auto channel_op = getChannelDeclarationThroughSymbol(op);
+    auto channel_op =
+        getChannelDeclarationThroughSymbol(op, dep_ctx.channel_uses.get());
     std::string detailed_description = "";
     if (channel_op->hasAttr("broadcast_shape")) {
       auto size = extractFromI64ArrayAttr(channel_op.getSize());
@@ -1197,38 +1681,40 @@ std::string dependencyCanonicalizer::getOpTypeFromOpImpls(Operation *op) {
 // in region, while "back" returns the terminator in region.
 std::pair<Graph::vertex_descriptor, dependencyGraph *>
 dependencyCanonicalizer::getVertexFromOp(Operation *op,
-                                         dependencyContext dep_ctx,
+                                         dependencyContext &dep_ctx,
                                          std::string front_or_back) {
-  std::pair<Graph::vertex_descriptor, dependencyGraph *> output;
+  std::pair<Graph::vertex_descriptor, dependencyGraph *> output =
+      std::make_pair(0, nullptr);
+  std::pair<std::string, unsigned> entry_pair;
   if (auto execute_op = dyn_cast<xilinx::air::ExecuteOp>(op)) {
     if (front_or_back == "front") {
       auto execute_front_op = &(*op->getRegions().front().op_begin());
-      std::pair<std::string, unsigned> entry_pair =
-          getTypeIdPairFromOp(execute_front_op);
-      output.first = dep_ctx.op_to_v[entry_pair];
-      output.second = dep_ctx.op_to_g[entry_pair];
+      entry_pair = getTypeIdPairFromOp(execute_front_op);
     } else if (front_or_back == "back") {
       auto execute_end_op =
           op->getRegions().front().getBlocks().front().getTerminator();
-      std::pair<std::string, unsigned> entry_pair =
-          getTypeIdPairFromOp(execute_end_op);
-      output.first = dep_ctx.op_to_v[entry_pair];
-      output.second = dep_ctx.op_to_g[entry_pair];
+      entry_pair = getTypeIdPairFromOp(execute_end_op);
     } else {
       op->emitOpError(
           "unknown string operand (only accepts 'front' or 'back')");
+      return output;
     }
   } else {
-    std::pair<std::string, unsigned> entry_pair = getTypeIdPairFromOp(op);
-    output.first = dep_ctx.op_to_v[entry_pair];
-    output.second = dep_ctx.op_to_g[entry_pair];
-  }
+    entry_pair = getTypeIdPairFromOp(op);
+  }
+  // Look up without inserting, as the context is shared by reference
+  auto v_it = dep_ctx.op_to_v.find(entry_pair);
+  if (v_it != dep_ctx.op_to_v.end())
+    output.first = v_it->second;
+  auto g_it = dep_ctx.op_to_g.find(entry_pair);
+  if (g_it != dep_ctx.op_to_g.end())
+    output.second = g_it->second;
   return output;
 }
 
 // Copy vertices and edges from dependencyGraph to FlatGraph
 void dependencyCanonicalizer::copyFromDependencyGraphToFlatGraph(
-    Graph g_src, std::vector<unsigned> position, FlatGraph &g_dst,
+    Graph &g_src, std::vector<unsigned> position, FlatGraph &g_dst,
     vertex_to_flat_vertex_map &map, bool copyEdges) {
   // Copy vertices
   auto vp = getVerticesWithAffineIf(g_src, position);
@@ -1236,11 +1722,12 @@ void dependencyCanonicalizer::copyFromDependencyGraphToFlatGraph(
     auto new_v = add_vertex(g_dst);
     // Copy vertex asyncEventName
     put(get(boost::vertex_attribute, g_dst), new_v,
-        GraphvizAttributes{{"label", g_src[vit].asyncEventName + "\n" +
-                                         g_src[vit].detailed_description},
-                           {"color", g_src[vit].color},
-                           {"shape", g_src[vit].shape},
-                           {"style", "filled"}});
+        GraphvizAttributes{
+            {"label", g_src[vit].getAsyncEventName() + "\n" +
+                          g_src[vit].getDetailedDescription()},
+            {"color", graphNodeProperties::getColor(g_src[vit].category)},
+            {"shape", graphNodeProperties::getShape(g_src[vit].category)},
+            {"style", "filled"}});
     map.insert(std::make_pair(vit, new_v));
   }
   if (copyEdges) {
@@ -1261,7 +1748,7 @@ void dependencyCanonicalizer::copyFromDependencyGraphToFlatGraph(
 // showing cores
 std::vector<Graph::vertex_descriptor>
 dependencyCanonicalizer::getVerticesWithAffineIf(
-    Graph g, std::vector<unsigned> position) {
+    Graph &g, std::vector<unsigned> position) {
   std::vector<Graph::vertex_descriptor> output;
   auto vp = boost::vertices(g);
   if (position.size()) {
@@ -1284,8 +1771,8 @@ dependencyCanonicalizer::getVerticesWithAffineIf(
 
 // Update subgraph in FlatGraph from dependencyGraph
 void dependencyCanonicalizer::updateSubgraphFromDependencyGraph(
-    Graph subg_src, std::vector<unsigned> position, FlatGraph &subg_dst,
-    vertex_to_flat_vertex_map map, bool copyEdges) {
+    Graph &subg_src, std::vector<unsigned> position, FlatGraph &subg_dst,
+    vertex_to_flat_vertex_map &map, bool copyEdges) {
   // Update vertices
   vertex_to_flat_vertex_map subg_map;
   auto vp = getVerticesWithAffineIf(subg_src, position);
@@ -1309,12 +1796,12 @@ void dependencyCanonicalizer::updateSubgraphFromDependencyGraph(
 
 // Collect air.channel put and get pairs
 void dependencyCanonicalizer::collectAIRChannelPutAndGetInGraph(
-    Graph g, std::vector<unsigned> position, vertex_to_flat_vertex_map map,
+    Graph &g, std::vector<unsigned> position, vertex_to_flat_vertex_map &map,
     ChannelMap &channel_map) {
   // Search for air.channel put/get
   auto vp = getVerticesWithAffineIf(g, position);
   for (auto vit : vp) {
-    if (g[vit].asyncEventType == "channel") {
+    if (g[vit].asyncEventType == dependencyEventType::Channel) {
       auto channel_op = dyn_cast<air::ChannelInterface>(g[vit].op);
       auto chan_name = channel_op.getChanName().str();
       if (channel_map.find(chan_name) == channel_map.end()) {
@@ -1337,7 +1824,7 @@ void dependencyCanonicalizer::collectAIRChannelPutAndGetInGraph(
 
 // Trace dependency of every op in a boost graph
 void dependencyCanonicalizer::parseDependencyEdgesInGraph(
-    Graph &g, dependencyContext dep_ctx) {
+    Graph &g, dependencyContext &dep_ctx) {
   auto vp = boost::vertices(g);
   for (auto vit = vp.first; vit != vp.second; ++vit) {
     auto op = g[*vit].op;
@@ -1348,7 +1835,7 @@ void dependencyCanonicalizer::parseDependencyEdgesInGraph(
 }
 
 void dependencyCanonicalizer::connectOpToItsDepListImpls(
-    Operation *op, Graph &g, dependencyContext dep_ctx) {
+    Operation *op, Graph &g, dependencyContext &dep_ctx) {
   SmallVector<Value, 1> dep_list;
   // air.asyncopinterface
   if (auto async_op = mlir::dyn_cast<xilinx::air::AsyncOpInterface>(op)) {
@@ -1387,8 +1874,8 @@ void dependencyCanonicalizer::connectOpToItsDepListImpls(
 
 // Connect an async op to ops in its dependency list
 void dependencyCanonicalizer::connectOpToItsDepList(
-    Operation *op, SmallVector<Value, 1> dep_list, Graph &g,
-    dependencyContext dep_ctx) {
+    Operation *op, SmallVector<Value, 1> &dep_list, Graph &g,
+    dependencyContext &dep_ctx) {
   auto dst_v = getVertexFromOp(op, dep_ctx, "front").first;
   if (dep_list.size()) {
     for (auto dep_token : dep_list) {
@@ -1485,7 +1972,7 @@ void dependencyCanonicalizer::connectTerminatorInGraph(Graph &g) {
   auto vp = boost::vertices(g);
   Graph::vertex_descriptor terminator_v = 0;
   for (auto vit = vp.first; vit != vp.second; ++vit) {
-    if (g[*vit].asyncEventType == "hierarchy_terminator") {
+    if (g[*vit].asyncEventType == dependencyEventType::HierarchyTerminator) {
       terminator_v = *vit;
     }
   }
@@ -1493,7 +1980,7 @@ void dependencyCanonicalizer::connectTerminatorInGraph(Graph &g) {
     return;
   for (auto vit = vp.first; vit != vp.second; ++vit) {
     if ((terminator_v != *vit) && !out_degree(*vit, g) &&
-        (g[*vit].asyncEventType != "start")) {
+        (g[*vit].asyncEventType != dependencyEventType::Start)) {
       add_edge(*vit, terminator_v, g);
     }
   }
@@ -1516,7 +2003,7 @@ void dependencyCanonicalizer::updatePointerFromGraphToHierarchyTerminator(
     dependencyGraph &G) {
   auto vp = boost::vertices(G.g);
   for (auto v = vp.first; v != vp.second; ++v) {
-    if (G.g[*v].asyncEventType == "hierarchy_terminator") {
+    if (G.g[*v].asyncEventType == dependencyEventType::HierarchyTerminator) {
       G.terminator_vertex = *v;
       return;
     }
@@ -1528,7 +2015,8 @@ void dependencyCanonicalizer::updatePointerFromHierarchyTerminatorToGraph(
     dependencyGraph &G, dependencyGraph &subG) {
   auto vp = boost::vertices(subG.g);
   for (auto v = vp.first; v != vp.second; ++v) {
-    if (subG.g[*v].asyncEventType == "hierarchy_terminator") {
+    if (subG.g[*v].asyncEventType ==
+        dependencyEventType::HierarchyTerminator) {
       subG.g[*v].nextDependencyGraphs.push_back(&G);
       return;
     }
@@ -1542,7 +2030,7 @@ void dependencyCanonicalizer::updatePointerFromHierarchyOpToGraph(
   std::vector<vertex_iterator> hier_vs;
   auto vp = boost::vertices(G.g);
   for (auto v = vp.first; v != vp.second; ++v) {
-    if (G.g[*v].asyncEventType == "hierarchy") {
+    if (G.g[*v].asyncEventType == dependencyEventType::Hierarchy) {
       hier_vs.push_back(v);
     }
   }
@@ -1551,11 +2039,14 @@ void dependencyCanonicalizer::updatePointerFromHierarchyOpToGraph(
     if (G.subgraphs[idx].position.size()) {
       if (!isa<air::HerdOp>(G.g[*v].op))
         G.g[*v].op->emitOpError("found non-herd op with core id");
+      // One graph per core, or per class of symmetric cores if folding cores
       auto hier = dyn_cast<air::HierarchyInterface>(G.g[*v].op);
-      for (unsigned i = 0; i < getTripCountInHierarchyOp(hier); i++) {
+      unsigned core_count = 0;
+      while (core_count < getTripCountInHierarchyOp(hier)) {
         G.g[*v].nextDependencyGraphs.push_back(&(G.subgraphs[idx]));
         if (G.g[*v].op != G.subgraphs[idx].hierarchyOp)
           G.g[*v].op->emitOpError("mismatch between graph and hierarchy op");
+        core_count += 1 + G.subgraphs[idx].folded_positions.size();
         idx++;
       }
     } else {
@@ -1567,14 +2058,68 @@ void dependencyCanonicalizer::updatePointerFromHierarchyOpToGraph(
   }
 }
 
+// Deep-copies a hierarchy of command graphs. Pointers between graphs in the
+// hierarchy are redirected to their copies, and runner node pointers are reset.
+void dependencyCanonicalizer::copyDependencyGraph(dependencyGraph &src,
+                                                  dependencyGraph &dst) {
+  graph_to_graph_map graph_map;
+  copyDependencyGraphImpl(src, dst, graph_map);
+  redirectPointersBetweenGraphs(dst, graph_map);
+}
+
+void dependencyCanonicalizer::copyDependencyGraphImpl(
+    dependencyGraph &src, dependencyGraph &dst, graph_to_graph_map &graph_map) {
+  graph_map[&src] = &dst;
+  dst.g = src.g;
+  dst.hierarchyOp = src.hierarchyOp;
+  dst.runner_node = nullptr;
+  dst.start_vertex = src.start_vertex;
+  dst.terminator_vertex = src.terminator_vertex;
+  dst.position = src.position;
+  dst.folded_positions = src.folded_positions;
+  dst.subgraphs.clear();
+  for (auto &subG : src.subgraphs) {
+    // Growing a deque at its end keeps references to its elements valid
+    dst.subgraphs.emplace_back();
+    copyDependencyGraphImpl(subG, dst.subgraphs.back(), graph_map);
+  }
+}
+
+void dependencyCanonicalizer::redirectPointersBetweenGraphs(
+    dependencyGraph &G, graph_to_graph_map &graph_map) {
+  auto vp = boost::vertices(G.g);
+  for (auto v = vp.first; v != vp.second; ++v) {
+    for (auto &next_graph : G.g[*v].nextDependencyGraphs) {
+      auto it = graph_map.find(next_graph);
+      if (it != graph_map.end())
+        next_graph = it->second;
+    }
+  }
+  for (auto &subG : G.subgraphs)
+    redirectPointersBetweenGraphs(subG, graph_map);
+}
+
 // Dump graphviz
-void dependencyCanonicalizer::dump_graph(std::string filename, Graph G) {
+void dependencyCanonicalizer::dump_graph(std::string filename, Graph &G) {
   std::ofstream ofs(filename, std::ofstream::out);
+  // Visualization attributes are not kept on the vertices; materialize them
+  // into a side table for the duration of the dump
+  std::vector<std::string> labels, colors, shapes;
+  auto vp = boost::vertices(G);
+  for (auto v = vp.first; v != vp.second; ++v) {
+    labels.push_back(G[*v].getAsyncEventName());
+    colors.push_back(graphNodeProperties::getColor(G[*v].category));
+    shapes.push_back(graphNodeProperties::getShape(G[*v].category));
+  }
+  auto index = boost::get(boost::vertex_index, G);
   boost::dynamic_properties dp;
-  dp.property("label", boost::get(&dependencyNodeEntry::asyncEventName, G));
-  dp.property("color", boost::get(&dependencyNodeEntry::color, G));
-  dp.property("shape", boost::get(&dependencyNodeEntry::shape, G));
-  dp.property("node_id", boost::get(boost::vertex_index, G));
+  dp.property("label",
+              boost::make_iterator_property_map(labels.begin(), index));
+  dp.property("color",
+              boost::make_iterator_property_map(colors.begin(), index));
+  dp.property("shape",
+              boost::make_iterator_property_map(shapes.begin(), index));
+  dp.property("node_id", index);
   dp.property("style", boost::make_constant_property<Graph::vertex_descriptor>(
                            +"filled"));
   write_graphviz_dp(ofs, G, dp);
@@ -1657,7 +2202,7 @@ void dependencyCanonicalizer::canonicalizeGraphs(
   }
 }
 
-void dependencyCanonicalizer::dumpDotGraphFiles(dependencyGraph global_graph,
+void dependencyCanonicalizer::dumpDotGraphFiles(dependencyGraph &global_graph,
                                                 std::string dump_dir) {
   // Dump dot graphs
   if (dump_dir != "") {
@@ -1667,17 +2212,17 @@ void dependencyCanonicalizer::dumpDotGraphFiles(dependencyGraph global_graph,
   }
   dump_graph(dump_dir + "host.dot", global_graph.g);
   int i = 0;
-  for (auto G_l : global_graph.subgraphs) {
+  for (auto &G_l : global_graph.subgraphs) {
     std::string name = xilinx::air::to_string(G_l.hierarchyOp) + "_" +
                        std::to_string(++i) + ".dot";
     dump_graph(dump_dir + name, G_l.g);
     int j = 0;
-    for (auto G_p : G_l.subgraphs) {
+    for (auto &G_p : G_l.subgraphs) {
       std::string name = xilinx::air::to_string(G_p.hierarchyOp) + "_" +
                          std::to_string(i) + "_" + std::to_string(++j) + ".dot";
       dump_graph(dump_dir + name, G_p.g);
       int k = 0;
-      for (auto G_h : G_p.subgraphs) {
+      for (auto &G_h : G_p.subgraphs) {
         std::string name = xilinx::air::to_string(G_h.hierarchyOp) + "_" +
                            std::to_string(i) + "_" + std::to_string(j) + "_" +
                            std::to_string(++k) + ".dot";
@@ -1691,22 +2236,17 @@ void dependencyCanonicalizer::boostTransitiveReductionImpl(
     Graph &asyncExecuteGraph, Graph &asyncExecuteGraphTR,
     vertex_to_vertex_map &g_to_tr, vertex_to_vertex_map &tr_to_g) {
 
-  std::vector<size_t> id_map(num_vertices(asyncExecuteGraph));
-  std::iota(id_map.begin(), id_map.end(), 0u);
-
-  boost::transitive_reduction(asyncExecuteGraph, asyncExecuteGraphTR,
-                              boost::make_assoc_property_map(g_to_tr),
-                              id_map.data());
+  transitiveReduction(asyncExecuteGraph, asyncExecuteGraphTR, g_to_tr);
 
   for (vertex_to_vertex_map::iterator i = g_to_tr.begin(); i != g_to_tr.end();
        ++i) {
     // Copy over graph properties
-    asyncExecuteGraphTR[i->second].asyncEventName =
-        asyncExecuteGraph[i->first].asyncEventName;
+    asyncExecuteGraphTR[i->second].asyncEventNameId =
+        asyncExecuteGraph[i->first].asyncEventNameId;
     asyncExecuteGraphTR[i->second].asyncEventType =
         asyncExecuteGraph[i->first].asyncEventType;
-    asyncExecuteGraphTR[i->second].color = asyncExecuteGraph[i->first].color;
-    asyncExecuteGraphTR[i->second].shape = asyncExecuteGraph[i->first].shape;
+    asyncExecuteGraphTR[i->second].category =
+        asyncExecuteGraph[i->first].category;
     asyncExecuteGraphTR[i->second].operationId =
         asyncExecuteGraph[i->first].operationId;
     asyncExecuteGraphTR[i->second].op = asyncExecuteGraph[i->first].op;
@@ -1782,14 +2322,15 @@ void dependencyCanonicalizer::fillAIRDepListUsingGraphTR(
          it++) {
       auto TRVertex = source(*it, graph.g);
       auto src_op = graph.g[TRVertex].op;
+      auto src_type = graph.g[TRVertex].asyncEventType;
       if (src_op && op != src_op) { // Avoid dep to itself
-        if (graph.g[TRVertex].asyncEventType == "for_loop") {
+        if (src_type == dependencyEventType::ForLoop) {
           auto value = dyn_cast<scf::ForOp>(src_op).getRegionIterArgs()[0];
           async_op.addAsyncDependency(value);
-        } else if (graph.g[TRVertex].asyncEventType == "parallel_loop") {
+        } else if (src_type == dependencyEventType::ParallelLoop) {
           auto value = dyn_cast<scf::ParallelOp>(src_op).getInitVals()[0];
           async_op.addAsyncDependency(value);
-        } else if (graph.g[TRVertex].asyncEventType == "terminator") {
+        } else if (src_type == dependencyEventType::Terminator) {
           auto parent_op = src_op->getParentOp();
           auto value = parent_op->getResult(0);
           async_op.addAsyncDependency(value);
@@ -1888,6 +2429,40 @@ unsigned dependencyCanonicalizer::getTripCountInHierarchyOp(
   return output;
 }
 
+// Group the cores of a herd whose simulations are interchangeable, i.e. which
+// run the same ops once filtered by the affine.if conditions on the herd. The
+// runner matches channel ops by symbol, so such cores also share the channel
+// endpoints they communicate with. Each class is listed with its first core,
+// in iteration order, at its front.
+std::vector<std::vector<unsigned>>
+dependencyCanonicalizer::getSymmetricCoreClasses(air::HerdOp herd) {
+  std::vector<Operation *> filtered_ops;
+  herd.walk([&](Operation *op) {
+    if (!op->getParentOfType<mlir::AffineIfOp>())
+      return;
+    std::vector<Operation *> affine_if_nest;
+    Operation *spatial_loop = nullptr;
+    getAffineIfNestAndSpatialLoopFromOp(op, affine_if_nest, spatial_loop);
+    if (spatial_loop == herd.getOperation())
+      filtered_ops.push_back(op);
+  });
+
+  std::vector<std::vector<unsigned>> classes;
+  std::map<std::vector<bool>, unsigned> class_of_signature;
+  auto hier = dyn_cast<air::HierarchyInterface>(herd.getOperation());
+  for (unsigned i = 0; i < getTripCountInHierarchyOp(hier); i++) {
+    auto position = getPositionFromIterator(i, herd);
+    std::vector<bool> signature;
+    for (auto op : filtered_ops)
+      signature.push_back(positionHitsAffineIfCondition(op, position));
+    auto it = class_of_signature.insert({signature, classes.size()});
+    if (it.second)
+      classes.push_back({});
+    classes[it.first->second].push_back(i);
+  }
+  return classes;
+}
+
 // Write position of each core to dependency graph, if showing cores
 std::vector<unsigned>
 dependencyCanonicalizer::getPositionFromIterator(unsigned iter,
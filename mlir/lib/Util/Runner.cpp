@@ -13,8 +13,12 @@
 
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/JSON.h"
 
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
@@ -24,15 +28,26 @@
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/IntegerSet.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/MathExtras.h"
 #include "mlir/Transforms/RegionUtils.h"
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
 #include <float.h>
+#include <functional>
 #include <list>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <set>
+#include <shared_mutex>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // boost graph
@@ -48,6 +63,9 @@
 #include "./Runner/Resource.cpp"
 #include "./Runner/ResourceHierarchy.cpp"
 #include "./Runner/RunnerNode.cpp"
+#include "./Runner/BandwidthModel.cpp"
+#include "./Runner/RunnerStatistics.cpp"
+#include "./Runner/TraceWriter.cpp"
 
 #define DEBUG_TYPE "air-runner"
 
@@ -61,6 +79,79 @@ namespace air {
 
 class AIRRunner::AIRRunner_impl {
 
+  // Trace event emitted by a launch iteration, with its time stamp relative to
+  // the start of the iteration. The event is named by the interned name and
+  // description of its vertex.
+  struct launchTraceEvent {
+    unsigned name_id;
+    unsigned description_id;
+    dependencyNodeCategory category;
+    char ph;
+    uint64_t time;
+    int64_t tid;
+    int64_t pid;
+
+    bool operator==(const launchTraceEvent &other) const {
+      return time == other.time && tid == other.tid && pid == other.pid &&
+             ph == other.ph && name_id == other.name_id &&
+             description_id == other.description_id;
+    }
+  };
+
+  // Timing signature of a simulated launch iteration
+  struct launchIterationRecord {
+    uint64_t start_time = 0;
+    uint64_t duration = 0;
+    std::vector<launchTraceEvent> events;
+    std::vector<double> occupancy;
+    // Statistics gathered up to the start of the iteration
+    runnerStatistics statistics;
+    std::vector<size_t> footprint_timeline_sizes;
+
+    bool operator==(const launchIterationRecord &other) const {
+      return duration == other.duration && occupancy == other.occupancy &&
+             events == other.events;
+    }
+  };
+
+  // A simulated launch, kept so that an unchanged launch of a program can be
+  // replayed rather than simulated again. Trace events are timed relative to
+  // the start of the launch; other time stamps are absolute.
+  struct cachedLaunch {
+    unsigned device_id = 0;
+    uint64_t start_time = 0;
+    uint64_t duration = 0;
+    // Device occupancy at the start of the launch, which it also left behind
+    std::vector<double> occupancy;
+    std::vector<launchTraceEvent> events;
+    // Statistics gathered up to the start and to the end of the launch
+    runnerStatistics statistics;
+    runnerStatistics end_statistics;
+    std::vector<size_t> footprint_timeline_sizes;
+    std::vector<std::vector<std::pair<uint64_t, double>>> footprints;
+    // Repeats of the launch's footprints, indexed from the start of the launch
+    std::vector<std::vector<AIRRunnerFootprintRepeat>> footprint_repeats;
+    AIRRunnerCriticalPath critical_path;
+    AIRRunnerLaunchIterations iterations;
+  };
+
+  // Data moved by an op, as modelled by its cost
+  struct transferRecord {
+    unsigned src = 0;
+    unsigned dst = 0;
+    double bytes = 0;
+  };
+
+  // Trace and completion events of a sub-runner subtree, buffered over one
+  // phase of the tick loop
+  struct subtreePartition {
+    runnerNode *root = nullptr;
+    std::string trace;
+    std::vector<launchTraceEvent> events;
+    completionEventQueue completion_events;
+    bool running = false;
+  };
+
   void debugArg(const std::string &head, mlir::Value op,
                 const llvm::APInt &value, uint64_t time) {
     LLVM_DEBUG(llvm::dbgs() << "  " << head << ":  " << op << " = " << value
@@ -94,9 +185,24 @@ class AIRRunner::AIRRunner_impl {
 
 public:
   AIRRunner_impl(llvm::raw_ostream &trace_stream, llvm::json::Value &json_model,
-                 std::string sim_granularity = "herd", bool verbose = false)
-      : traceStream(trace_stream), jsonModel(json_model),
-        sim_granularity(sim_granularity) {
+                 std::string sim_granularity = "herd", bool verbose = false,
+                 bool full_simulation = false, bool parallel_segments = false,
+                 std::string trace_format = "json",
+                 std::string trace_level = "all", bool fold_cores = false)
+      : jsonModel(json_model), sim_granularity(sim_granularity),
+        fold_cores(fold_cores),
+        trace(trace_stream,
+              symbolizeTraceFormat(trace_format).value_or(traceFormat::Json),
+              symbolizeTraceLevel(trace_level).value_or(traceLevel::All)),
+        full_simulation(full_simulation), launch_iteration_record(nullptr),
+        parallel_segments(parallel_segments) {
+
+    if (!symbolizeTraceFormat(trace_format))
+      llvm::report_fatal_error("unknown trace format " +
+                               llvm::Twine(trace_format));
+    if (!symbolizeTraceLevel(trace_level))
+      llvm::report_fatal_error("unknown trace level " +
+                               llvm::Twine(trace_level));
 
     auto model = jsonModel.getAsObject();
 
@@ -116,70 +222,51 @@ public:
     if (auto hs = model->getNumber("num_herd_slots"))
       herd_slots = (unsigned)(*hs);
 
+    num_devices = 1;
+    if (auto nd = model->getNumber("num_devices")) {
+      if (*nd < 1)
+        llvm::report_fatal_error("number of devices must be positive");
+      num_devices = (unsigned)(*nd);
+    }
+
+    channel_buffer_depth = 1;
+    if (auto cb = model->getNumber("channel_buffer_depth")) {
+      if (*cb < 1)
+        llvm::report_fatal_error("channel buffer depth must be positive");
+      channel_buffer_depth = (unsigned)(*cb);
+    }
+
+    if (auto bw = model->getString("bandwidth_model")) {
+      if (*bw != "fixed" && *bw != "fluid")
+        llvm::report_fatal_error("unknown bandwidth model " + llvm::Twine(*bw));
+      bandwidth_contention = *bw == "fluid";
+    }
+
     LLVM_DEBUG(llvm::dbgs() << "dispatch slots: " << dispatch_slots << "\n");
     LLVM_DEBUG(llvm::dbgs()
                << "dispatch dma slots: " << dispatch_dma_slots << "\n");
     LLVM_DEBUG(llvm::dbgs() << "core dma slots: " << core_dma_slots << "\n");
     LLVM_DEBUG(llvm::dbgs() << "herd slots: " << herd_slots << "\n");
+    LLVM_DEBUG(llvm::dbgs() << "devices: " << num_devices << "\n");
+    LLVM_DEBUG(llvm::dbgs()
+               << "channel buffer depth: " << channel_buffer_depth << "\n");
   }
 
-  void emitTraceStart(llvm::raw_ostream &s) { s << "[\n"; }
-
-  void emitTraceEnd(llvm::raw_ostream &s) { s << "{}]\n"; }
-
-  void emitTraceEvent(llvm::raw_ostream &s, std::string name, std::string cat,
-                      std::string ph, std::string ts, int64_t tid,
-                      int64_t pid) {
-    s << "{\n";
-    s << "  \"name\": \"" << name << "\","
-      << "\n";
-    s << "  \"cat\": \"" << cat << "\","
-      << "\n";
-    s << "  \"ph\": \"" << ph << "\","
-      << "\n";
-    s << "  \"ts\": " << ts << ","
-      << "\n";
-    s << "  \"pid\": " << pid << ","
-      << "\n";
-    s << "  \"tid\": " << tid << ","
-      << "\n";
-    s << "  \"args\": "
-      << "{}"
-      << ""
-      << "\n";
-    s << "},\n";
-  }
-
-  void emitTraceMetadataEvent(llvm::raw_ostream &s, std::string item_name,
-                              std::string arg_name, std::string arg_entry,
-                              std::string ph, int64_t pid, int64_t tid = -1) {
-    s << "{\n";
-    s << "  \"name\": \"" << item_name << "\","
-      << "\n";
-    s << "  \"ph\": \"" << ph << "\","
-      << "\n";
-    s << "  \"pid\": " << pid << ","
-      << "\n";
-    if (tid != -1) {
-      s << "  \"tid\": " << tid << ","
-        << "\n";
-    }
-    s << "  \"args\": {\n";
-    s << "    \"" << arg_name << "\": \"" << arg_entry << "\""
-      << "\n";
-    s << "  }\n";
-    s << "},\n";
-  }
-
-  // Model each event's latency
-  uint64_t modelOp(device &d, dependencyNodeEntry &c) {
+  void emitTraceStart(llvm::raw_ostream &s) { trace.writeHeader(s); }
+
+  void emitTraceEnd(llvm::raw_ostream &s) { trace.writeFooter(s); }
+
+  // Model each event's latency. The data moved by dma and channel ops is
+  // returned in `transfer`, if given.
+  uint64_t modelOp(device &d, dependencyNodeEntry &c,
+                   transferRecord *transfer = nullptr) {
     auto type = c.asyncEventType;
-    auto name = c.asyncEventName;
     uint64_t execution_time = 1;
+    transferRecord moved;
 
-    if (type == "wait_all") {
+    if (type == dependencyEventType::WaitAll) {
       execution_time = 1;
-    } else if (type == "dma") {
+    } else if (type == dependencyEventType::Dma) {
       auto Op = mlir::dyn_cast<xilinx::air::DmaMemcpyInterface>(c.op);
       if (!Op)
         c.op->emitOpError("has mismatching event type").attachNote()
@@ -191,12 +278,12 @@ public:
       auto dstSpace = dstTy.getMemorySpaceAsInt();
       // if there is a size mismatch, it's because we're moving a tile of the
       // larger tensor
-      if (getTensorVolume(srcTy) <= getTensorVolume(dstTy))
-        execution_time = getTransferCost(d, c.op, srcSpace, dstSpace, srcTy);
-      else
-        execution_time = getTransferCost(d, c.op, srcSpace, dstSpace, dstTy);
-    } else if (type == "channel" &&
-               (name.find("ChannelGetOp") != std::string::npos)) {
+      MemRefType ty =
+          getTensorVolume(srcTy) <= getTensorVolume(dstTy) ? srcTy : dstTy;
+      execution_time = getTransferCost(d, c.op, srcSpace, dstSpace, ty);
+      moved = recordTransfer(d, srcSpace, dstSpace, getTensorVolume(ty), ty);
+    } else if (type == dependencyEventType::Channel &&
+               isa<air::ChannelGetOp>(c.op)) {
       auto getOp = mlir::dyn_cast<xilinx::air::ChannelGetOp>(c.op);
       if (!getOp)
         c.op->emitOpError("has mismatching event type").attachNote()
@@ -204,7 +291,7 @@ public:
                "air::ChannelGetOp";
       MemRefType dstTy = getOp.getDst().getType().cast<MemRefType>();
       std::vector<air::ChannelPutOp> putOps =
-          air::getTheOtherChannelOpThroughSymbol(getOp);
+          air::getTheOtherChannelOpThroughSymbol(getOp, channel_uses);
       if (!putOps.size())
         getOp->emitOpError("found no put op for air::ChannelGetOp");
       MemRefType srcTy = putOps[0].getSrc().getType().cast<MemRefType>();
@@ -214,13 +301,17 @@ public:
       auto dstVolumn = getTransferVolumn(getOp);
       // if there is a size mismatch, it's because we're moving a tile of the
       // larger tensor
-      if (srcVolumn <= dstVolumn)
+      if (srcVolumn <= dstVolumn) {
         execution_time =
             getTransferCost(d, c.op, srcSpace, dstSpace, srcVolumn, srcTy);
-      else
+        moved = recordTransfer(d, srcSpace, dstSpace, srcVolumn, srcTy);
+      } else {
         execution_time =
             getTransferCost(d, c.op, srcSpace, dstSpace, dstVolumn, dstTy);
-    } else if (type == "execute" && name != "ExecuteTerminatorOp") {
+        moved = recordTransfer(d, srcSpace, dstSpace, dstVolumn, dstTy);
+      }
+    } else if (type == dependencyEventType::Execute &&
+               !isa<air::ExecuteTerminatorOp>(c.op)) {
       if (!isa<air::ExecuteOp>(c.op))
         c.op->emitOpError("has mismatching event type").attachNote()
             << "Has 'execute' as event type, but op isn't of type "
@@ -239,80 +330,90 @@ public:
       LLVM_DEBUG(llvm::dbgs() << air::to_string(c.op) << "'\n");
       execution_time = 1;
     }
+    if (transfer)
+      *transfer = moved;
     return execution_time;
   }
 
   bool processGraph(runnerNode &c, device &device_resource_node,
-                    uint64_t time) {
+                    uint64_t time, subtreePartition *partition = nullptr) {
 
     LLVM_DEBUG(llvm::dbgs() << "\nNEW TIME STAMP @" << time - 1 << " runner "
                             << air::to_string(c.ctrl_g->hierarchyOp) << " loc "
                             << air::to_string(c.ctrl_g->position) << "'\n");
 
-    executeOpsFromWavefrontAndFreeResource(c, device_resource_node, time);
-    pushOpsToWavefrontAndAllocateResource(c, device_resource_node, time);
+    // Only runner nodes with due completion events have ops to execute
+    popDueCompletionEvents(*c.getCompletionEventQueue(), time);
+    if (c.completions_due) {
+      c.completions_due = 0;
+      executeOpsFromWavefrontAndFreeResource(c, device_resource_node, time,
+                                             partition);
+    }
+    pushOpsToWavefrontAndAllocateResource(c, device_resource_node, time,
+                                          partition);
 
     return !c.wavefront.empty();
   }
 
-  void executeOpsFromWavefrontAndFreeResource(runnerNode &c,
-                                              device &device_resource_node,
-                                              uint64_t time) {
+  void executeOpsFromWavefrontAndFreeResource(
+      runnerNode &c, device &device_resource_node, uint64_t time,
+      subtreePartition *partition = nullptr) {
 
     Graph &G = c.ctrl_g->g;
 
-    // Pre-process the wavefront by moving terminator ops to the back
+    // Pre-process the wavefront by moving terminator ops to the back, last
+    // started first
     // Note: Reason for sorting the wavefront is because executing terminator
     // event may change the execution status of other ops on wavefront
-    for (int i = c.wavefront.size() - 1; i >= 0; i--) {
-      if (G[std::get<0>(c.wavefront[i])].asyncEventType == "terminator") {
-        moveItemToBack<std::tuple<Graph::vertex_descriptor,
-                                  std::vector<resource *>, unsigned>>(
-            c.wavefront, i);
-      }
-    }
+    auto isTerminator = [&](wavefrontEntry &entry) {
+      return G[entry.v].asyncEventType == dependencyEventType::Terminator;
+    };
+    auto terminators = std::stable_partition(
+        c.wavefront.begin(), c.wavefront.end(),
+        [&](wavefrontEntry &entry) { return !isTerminator(entry); });
+    std::reverse(terminators, c.wavefront.end());
     // Update wavefront
-    for (auto it = c.wavefront.begin(); it != c.wavefront.end(); ++it) {
-      if (G[std::get<0>(*it)].is_started() &&
-          G[std::get<0>(*it)].is_done(time)) {
-
-        if (G[std::get<0>(*it)].asyncEventType != "start") {
-
-          auto runner_id = getIdAttr(c.ctrl_g->hierarchyOp);
-          auto tid = std::get<2>(*it);
-          emitTraceEvent(traceStream,
-                         G[std::get<0>(*it)].asyncEventName +
-                             G[std::get<0>(*it)].detailed_description,
-                         "layer", "E",
-                         convertToTimeStampInStr(time, device_resource_node),
-                         tid, runner_id);
-        }
+    c.popFromWavefront(
+        [&](wavefrontEntry &entry) {
+          return G[entry.v].is_started() && G[entry.v].is_done(time);
+        },
+        [&](wavefrontEntry &entry) {
+          if (G[entry.v].asyncEventType != dependencyEventType::Start) {
+            auto runner_id = getIdAttr(c.ctrl_g->hierarchyOp);
+            emitLayerTraceEvents(c, G[entry.v], 'E', time, entry.slot,
+                                 runner_id, partition);
+          }
 
-        // "ExecuteOp"
-        c.executeOpImpls(std::get<0>(*it), time);
+          if (bandwidth_contention)
+            bandwidth.finishFlow(&G[entry.v], time);
+          recordOpEnd(G[entry.v]);
 
-        // Consume any loop-carried token
-        c.consumeLoopYieldedTokens(std::get<0>(*it));
+          // "ExecuteOp"
+          c.executeOpImpls(entry.v, time);
+          if (G[entry.v].asyncEventType == dependencyEventType::Channel)
+            recordChannelOccupancy(c, G[entry.v], time);
 
-        // Erase from wavefront
-        c.wavefront.erase(it);
-        it--;
-      }
-    }
+          // Consume any loop-carried token
+          c.consumeLoopYieldedTokens(entry.v);
+        });
   }
 
-  bool pushOpsToWavefrontAndAllocateResource(runnerNode &c,
-                                             device &device_resource_node,
-                                             uint64_t time) {
+  bool pushOpsToWavefrontAndAllocateResource(
+      runnerNode &c, device &device_resource_node, uint64_t time,
+      subtreePartition *partition = nullptr) {
 
     Graph &G = c.ctrl_g->g;
 
     // Get candidate vertices to be pushed to wavefront
+    uint64_t visits = 0;
     std::vector<Graph::vertex_descriptor> next_vertex_set_candidates =
-        c.getCandidateVerticesForWavefront();
+        c.getCandidateVerticesForWavefront(visits);
+    vertex_visits += visits;
 
     // Check dependency fulfillment of each candidate
     std::vector<Graph::vertex_descriptor> next_vertex_set;
+    std::vector<std::vector<std::pair<dependencyNodeEntry *, std::string>>>
+        next_vertex_dep_lists;
     for (auto it = next_vertex_set_candidates.begin();
          it != next_vertex_set_candidates.end(); ++it) {
       bool dep_fulfilled = true;
@@ -320,7 +421,7 @@ public:
       // to the node, the second field is a string representing the type of
       // this dependency, either "ssa" or "sym", and the third field is the
       // token index, in case if op contains multiple tokens.
-      std::vector<std::pair<dependencyNodeEntry, std::string>> dep_list;
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> dep_list;
       c.buildVertexDependencyList(*it, dep_list);
       // Check whether adj_v's dependency list is fulfilled
       if (isNonBlocking(G[*it].op)) {
@@ -332,42 +433,66 @@ public:
         dep_fulfilled =
             c.checkAllDependenciesFulfillment(dep_list, G[*it], time, true);
       }
+      if (G[*it].asyncEventType == dependencyEventType::Channel)
+        recordChannelOpReadiness(c, dep_list, G[*it], time, dep_fulfilled);
       if (dep_fulfilled) {
         next_vertex_set.push_back(*it);
+        next_vertex_dep_lists.push_back(std::move(dep_list));
       }
     }
 
     // Check resource fulfillment of each candidate
-    for (auto next_vertex : next_vertex_set) {
+    for (unsigned i = 0; i < next_vertex_set.size(); i++) {
+      auto next_vertex = next_vertex_set[i];
 
       // Check whether adj_v's resource requirement has been fulfilled.
       bool res_fulfilled = c.checkResourceFulfillmentForOpImpls(G[next_vertex]);
+      if (!res_fulfilled && isAllocation(G[next_vertex]))
+        recordAllocationBlocked(G[next_vertex], time);
 
       if (res_fulfilled) {
         // Delete vertex from latent wavefront candidates
-        c.removeVertexFromVertices(c.latent_wavefront_candidates, next_vertex);
-        // Push to wavefront; check for sim. granularity
-        c.pushToWavefront(next_vertex,
-                          canonicalizer.getIteratorFromPosition(
-                              c.ctrl_g->position, c.ctrl_g->hierarchyOp));
+        c.latent_wavefront_candidates.erase(next_vertex);
+        // Push to wavefront
+        c.pushToWavefront(next_vertex);
+        started_events++;
 
         G[next_vertex].start_time = time;
+        transferRecord transfer;
         G[next_vertex].end_time =
-            time + modelOp(device_resource_node, G[next_vertex]);
+            time + modelOp(device_resource_node, G[next_vertex], &transfer);
+        // Under bandwidth contention, the transfer's end time depends on the
+        // other transfers in flight through the same resource
+        if (bandwidth_contention && transfer.bytes > 0)
+          bandwidth.startFlow(device_resource_node,
+                              getTransferResource(c, c.wavefront.back()),
+                              transfer.src, transfer.dst, transfer.bytes,
+                              &G[next_vertex], &c, time);
+        c.pushCompletionEvent(G[next_vertex].end_time);
         // emit trace event begin
         auto runner_id = getIdAttr(c.ctrl_g->hierarchyOp);
-        auto tid = std::get<2>(c.wavefront.back());
-        emitTraceEvent(
-            traceStream,
-            G[next_vertex].asyncEventName + G[next_vertex].detailed_description,
-            "layer", "B", convertToTimeStampInStr(time, device_resource_node),
-            tid, runner_id);
+        emitLayerTraceEvents(c, G[next_vertex], 'B', time,
+                             c.wavefront.back().slot, runner_id, partition);
+        recordOpStart(c, G[next_vertex], runner_id, next_vertex_dep_lists[i]);
+        if (G[next_vertex].asyncEventType == dependencyEventType::Channel)
+          recordChannelOccupancy(c, G[next_vertex], time);
       }
     }
 
     return c.wavefront.size() > 0;
   }
 
+  // Resource carrying a transfer started on a runner node's wavefront: the
+  // first port reserved by a channel op, or else the du, tile or device of the
+  // runner node issuing a dma
+  resource *getTransferResource(runnerNode &c, wavefrontEntry &entry) {
+    if (!entry.reserved_resources.empty())
+      return entry.reserved_resources.front();
+    if (!c.resource_hiers.empty())
+      return c.resource_hiers.front();
+    return nullptr;
+  }
+
   void scheduleFunction(func::FuncOp &toplevel) {
 
     // Walk the launch op and create a boost graph using dependencyCanonicalizer
@@ -375,7 +500,52 @@ public:
     canonicalizer.removeDepListRepetition(toplevel);
     hostGraph = dependencyGraph(toplevel, true);
     canonicalizer.parseCommandGraphs(toplevel, hostGraph, dep_ctx,
-                                     sim_granularity);
+                                     sim_granularity, false, "", fold_cores);
+    std::map<Operation *, CostModel::OpCountMap> toplevel_op_counts;
+    countExecuteLinalgOps(toplevel, toplevel_op_counts);
+    op_counts = &toplevel_op_counts;
+
+    scheduleHostGraph(toplevel, dep_ctx);
+    op_counts = nullptr;
+
+    // Simulation performance report
+    std::string end_ts = llvm::formatv("{0:F3}", results.latency_us).str();
+    std::cout << "Latency: " << end_ts << "us\n";
+  }
+
+  void scheduleFunction(AIRRunnerProgram &program) {
+    if (program.sim_granularity != sim_granularity) {
+      program.toplevel->emitOpError(
+          "program graphs were built for a different simulation granularity");
+      return;
+    }
+    // Runner nodes update the state of graph vertices, so simulate a private
+    // copy of the program's graphs
+    canonicalizer.copyDependencyGraph(program.hostGraph, hostGraph);
+    launch_versions = &program.launch_versions;
+    op_counts = &program.op_counts;
+    scheduleHostGraph(program.toplevel, program.dep_ctx);
+    // Forget the launches which changed since, whose versions are gone
+    std::unordered_set<uint64_t> versions;
+    for (auto &entry : program.launch_versions)
+      versions.insert(entry.second);
+    for (auto it = launch_cache.begin(); it != launch_cache.end();) {
+      if (versions.count(it->first))
+        ++it;
+      else
+        it = launch_cache.erase(it);
+    }
+    launch_versions = nullptr;
+    op_counts = nullptr;
+  }
+
+  const AIRRunnerResults &getResults() { return results; }
+
+  // Simulate the launches in the host graph
+  void scheduleHostGraph(func::FuncOp &toplevel, dependencyContext &ctx) {
+
+    results = AIRRunnerResults();
+    channel_uses = ctx.channel_uses.get();
 
     // Walk the launch graph and write process name metadata in trace
     writeTraceMetadataProcNames(hostGraph);
@@ -384,9 +554,39 @@ public:
     auto model = jsonModel.getAsObject();
     if (!model)
       toplevel->emitOpError("failed to read JSON model");
-    auto device_resource_node = device(model);
-
-    uint64_t time = 1;
+    // Each device of the model is an identical copy of its resources. With
+    // several devices, their resources are named after their device.
+    std::deque<device> devices;
+    tracked_resources.clear();
+    tracked_memories.clear();
+    device_resource_offsets.assign(1, 0);
+    for (unsigned i = 0; i < num_devices; i++) {
+      devices.emplace_back(model);
+      std::string prefix =
+          num_devices > 1 ? "device[" + std::to_string(i) + "]/" : "";
+      for (auto &r : devices.back().getTrackedResources(prefix))
+        tracked_resources.push_back(r);
+      for (auto &m : devices.back().getTrackedMemories(prefix))
+        tracked_memories.push_back(m);
+      device_resource_offsets.push_back(tracked_resources.size());
+    }
+    trace.setClock(devices.front().clock);
+    statistics = runnerStatistics();
+    statistics.busy_cycles.assign(tracked_resources.size(), 0);
+    statistics.peak_bytes.assign(tracked_memories.size(), 0);
+    live_bytes.assign(tracked_memories.size(), 0);
+    footprint_timelines.assign(tracked_memories.size(), {});
+    footprint_repeats.assign(tracked_memories.size(), {});
+    compute_costs.clear();
+    compute_cost_hits = 0;
+    vertex_visits = 0;
+    started_events = 0;
+
+    // Time at which each device is free, and at which each simulated launch
+    // and the last synchronous launch ended
+    std::vector<uint64_t> device_free_times(num_devices, 1);
+    llvm::DenseMap<Operation *, uint64_t> launch_end_times;
+    uint64_t host_barrier_time = 1;
     for (auto &launchGraph : hostGraph.subgraphs) {
 
       // air launch iteration space
@@ -397,25 +597,180 @@ public:
         iter_count *= s;
       }
 
+      // Run the launch on the device which is free first, once the launches
+      // it depends on have ended
+      unsigned device_id = 0;
+      for (unsigned i = 1; i < num_devices; i++)
+        if (device_free_times[i] < device_free_times[device_id])
+          device_id = i;
+      auto &device_resource_node = devices[device_id];
+      active_device = device_id;
+      uint64_t time = std::max(
+          {device_free_times[device_id], host_barrier_time,
+           getLaunchReadyTime(launch_op, launch_end_times)});
+
+      // A launch of a program which is unchanged since it was last simulated
+      // from the same device state is replayed from the launch cache
+      std::optional<cachedLaunch> cached;
+      if (launch_versions) {
+        auto occupancy = device_resource_node.getOccupancySnapshot();
+        if (replayCachedLaunch(launch_op, device_id, occupancy, time)) {
+          recordLaunchEnd(launch_op, device_id, time, device_free_times,
+                          launch_end_times, host_barrier_time);
+          continue;
+        }
+        cached = cachedLaunch();
+        cached->device_id = device_id;
+        cached->start_time = time;
+        cached->occupancy = std::move(occupancy);
+        cached->statistics = statistics;
+        for (auto &timeline : footprint_timelines)
+          cached->footprint_timeline_sizes.push_back(timeline.size());
+      }
+
+      AIRRunnerLaunchIterations iterations;
+      iterations.name = air::to_string(launch_op);
+      iterations.id = getIdAttr(launch_op);
+      iterations.iterations = iter_count;
+      launchIterationRecord prev_iteration, curr_iteration;
       for (unsigned i = 0; i < iter_count; i++) {
+        iterations.simulated_iterations++;
 
         // Reset controllers
-        launch_runner_node = runnerNode(nullptr, &launchGraph, "launch",
-                                        &dep_ctx, sim_granularity);
+        launch_runner_node = runnerNode(nullptr, &launchGraph, "launch", &ctx,
+                                        sim_granularity);
+        launch_runner_node.completion_events = &completion_events;
+        launch_runner_node.default_channel_buffer_depth = channel_buffer_depth;
         // Update pointer to launch runner node in launch graph
         launchGraph.runner_node = &launch_runner_node;
 
         // Walk the launch graph and infer herd/segment runner nodes
         launch_runner_node.initRunnerNodesFromLaunchGraph(launchGraph);
 
-        // Schedule launch runner node and its sub-runner nodes
+        // Schedule launch runner node and its sub-runner nodes, recording the
+        // iteration's trace events relative to its start time
+        curr_iteration = launchIterationRecord();
+        curr_iteration.start_time = time;
+        curr_iteration.statistics = statistics;
+        for (auto &timeline : footprint_timelines)
+          curr_iteration.footprint_timeline_sizes.push_back(timeline.size());
+        launch_iteration_record = &curr_iteration;
+        critical_path_log.clear();
+        channel_ready_times.clear();
+        allocation_blocked_times.clear();
         scheduleLaunch(launch_runner_node, device_resource_node, time);
+        closeChannelOccupancy(time);
+        launch_iteration_record = nullptr;
+        recordSpanStart(launch_op, curr_iteration.start_time);
+        recordSpanEnd(launch_op, time);
+        curr_iteration.duration = time - curr_iteration.start_time;
+        curr_iteration.occupancy = device_resource_node.getOccupancySnapshot();
+        if (cached)
+          recordCachedLaunchEvents(*cached, curr_iteration.events,
+                                   curr_iteration.start_time);
+
+        // Two consecutive iterations with identical relative timings and
+        // identical resource state afterwards have reached a periodic steady
+        // state. All remaining iterations would repeat it, so replay its trace
+        // events and advance time analytically instead of simulating them.
+        if (!full_simulation && i > 0 && i + 1 < iter_count &&
+            curr_iteration == prev_iteration) {
+          uint64_t remaining = iter_count - i - 1;
+          LLVM_DEBUG(llvm::dbgs()
+                     << "launch " << air::to_string(launch_op)
+                     << " reached steady state after " << i + 1
+                     << " iterations; extrapolating " << remaining
+                     << " iterations of " << curr_iteration.duration
+                     << " cycles\n");
+          iterations.fast_forwarded_iterations = remaining;
+          iterations.period_cycles = curr_iteration.duration;
+          for (uint64_t r = 0; r < remaining; r++) {
+            for (auto &e : curr_iteration.events)
+              if (trace.isEnabled(e.category))
+                trace.writeEvent(getInternedDependencyString(e.name_id),
+                                 getInternedDependencyString(e.description_id),
+                                 "layer", e.ph, time + e.time, e.tid, e.pid);
+            if (cached)
+              recordCachedLaunchEvents(*cached, curr_iteration.events, time);
+            time += curr_iteration.duration;
+          }
+          statistics.repeatSince(curr_iteration.statistics, remaining,
+                                 curr_iteration.duration);
+          repeatFootprintTimelines(curr_iteration.footprint_timeline_sizes,
+                                   remaining, curr_iteration.duration);
+          break;
+        }
+        std::swap(prev_iteration, curr_iteration);
       }
+
+      // The critical path of the last simulated iteration ends at the launch
+      // terminator
+      results.critical_paths.push_back(getCriticalPath(launchGraph));
+      results.simulation.launches.push_back(iterations);
+
+      // Only launches which leave the device as they found it can be replayed
+      if (cached &&
+          device_resource_node.getOccupancySnapshot() == cached->occupancy)
+        cacheLaunch(launch_op, *cached, time);
+      recordLaunchEnd(launch_op, device_id, time, device_free_times,
+                      launch_end_times, host_barrier_time);
     }
 
-    // Simulation performance report
-    std::string end_ts = convertToTimeStampInStr(time, device_resource_node);
-    std::cout << "Latency: " << end_ts << "us\n";
+    // Simulation performance summary
+    uint64_t time =
+        *std::max_element(device_free_times.begin(), device_free_times.end());
+    results.cycles = time;
+    results.latency_us =
+        std::round((double)time / (1000000000.0 / devices.front().clock)) /
+        1000.0;
+    collectStatisticsIntoResults();
+    writeTraceMetadataThreadPages();
+    results.simulation.compute_cost_hits = compute_cost_hits.load();
+    results.simulation.compute_cost_misses = compute_costs.size();
+    results.simulation.events = started_events.load();
+    results.simulation.vertex_visits = vertex_visits.load();
+    LLVM_DEBUG(llvm::dbgs()
+               << "compute cost cache: " << compute_cost_hits.load()
+               << " hits, " << compute_costs.size() << " misses\n");
+  }
+
+  // Time at which the launches that a launch depends on, through its async
+  // dependencies and the host ops producing them, have ended
+  uint64_t
+  getLaunchReadyTime(air::LaunchOp launch_op,
+                     llvm::DenseMap<Operation *, uint64_t> &launch_end_times) {
+    uint64_t ready = 1;
+    llvm::SmallVector<Value> worklist(launch_op.getAsyncDependencies());
+    llvm::DenseSet<Operation *> visited;
+    while (!worklist.empty()) {
+      auto op = worklist.pop_back_val().getDefiningOp();
+      if (!op || !visited.insert(op).second)
+        continue;
+      if (isa<air::LaunchOp>(op)) {
+        auto end = launch_end_times.find(op);
+        if (end != launch_end_times.end())
+          ready = std::max(ready, end->second);
+        continue;
+      }
+      if (auto async_op = dyn_cast<air::AsyncOpInterface>(op))
+        worklist.append(async_op.getAsyncDependencies().begin(),
+                        async_op.getAsyncDependencies().end());
+      else
+        worklist.append(op->operand_begin(), op->operand_end());
+    }
+    return ready;
+  }
+
+  // Record the end of a launch on a device. The host waits for a synchronous
+  // launch before issuing the next ones.
+  void recordLaunchEnd(air::LaunchOp launch_op, unsigned device_id,
+                       uint64_t time, std::vector<uint64_t> &device_free_times,
+                       llvm::DenseMap<Operation *, uint64_t> &launch_end_times,
+                       uint64_t &host_barrier_time) {
+    device_free_times[device_id] = time;
+    launch_end_times[launch_op] = time;
+    if (!launch_op.getAsyncToken())
+      host_barrier_time = std::max(host_barrier_time, time);
   }
 
   void scheduleLaunch(runnerNode &launch, device &device_resource_node,
@@ -423,31 +778,52 @@ public:
 
     auto start_v = launch.ctrl_g->start_vertex;
     // Reset launch graph
-    launch.processed_vertices.clear();
+    launch.clearProcessedVertices();
     launch.resetGraphBetweenTwoVertices(
         start_v, launch.ctrl_g->terminator_vertex, launch.ctrl_g->g, time);
+    // Clear any completion events and transfers left over from the previous
+    // launch
+    completion_events = completionEventQueue();
+    bandwidth.reset();
     // Start running launch
     bool running = true;
     launch.ctrl_g->g[start_v].start_time = 1;
     launch.ctrl_g->g[start_v].end_time = 1;
     launch.pushStartToWavefront(start_v);
-    // Consume devices upon launch
-    // TODO: multi-device modelling
+    // Consume the device the launch runs on
     launch.resource_hiers.push_back(&device_resource_node);
 
+    // Partition sub-runner subtrees into independent groups, if simulating
+    // them in parallel
+    std::vector<subtreePartition> partitions;
+    std::vector<std::vector<unsigned>> groups;
+    // Transfers of all subtrees contend for the same interfaces, so subtrees
+    // are only simulated in parallel without bandwidth contention
+    if (parallel_segments && !bandwidth_contention)
+      initSubtreePartitions(launch, partitions, groups);
+    bool run_in_parallel = groups.size() > 1;
+    launch.channel_state_mutex =
+        run_in_parallel ? &channel_state_mutex : nullptr;
+
     while (running) {
       LLVM_DEBUG(llvm::dbgs() << "time: " << time << "\n");
 
       running = false;
-      std::vector<uint64_t> next_times;
 
       running |= processGraph(launch, device_resource_node, time);
 
-      for (auto &segment_runner_node : launch.sub_runner_nodes) {
-        running |=
-            processGraph(segment_runner_node, device_resource_node, time);
-        for (auto &herd_runner_node : segment_runner_node.sub_runner_nodes) {
-          running |= processGraph(herd_runner_node, device_resource_node, time);
+      if (run_in_parallel) {
+        running |= processSubtreesInParallel(launch, partitions, groups,
+                                             device_resource_node, time,
+                                             /*push_only=*/false);
+      } else {
+        for (auto &segment_runner_node : launch.sub_runner_nodes) {
+          running |=
+              processGraph(segment_runner_node, device_resource_node, time);
+          for (auto &herd_runner_node : segment_runner_node.sub_runner_nodes) {
+            running |=
+                processGraph(herd_runner_node, device_resource_node, time);
+          }
         }
       }
 
@@ -455,46 +831,199 @@ public:
       running |= pushOpsToWavefrontAndAllocateResource(
           launch, device_resource_node, time);
 
-      for (auto &segment_runner_node : launch.sub_runner_nodes) {
-        running |= pushOpsToWavefrontAndAllocateResource(
-            segment_runner_node, device_resource_node, time);
-        for (auto &herd_runner_node : segment_runner_node.sub_runner_nodes) {
-          running |= pushOpsToWavefrontAndAllocateResource(
-              herd_runner_node, device_resource_node, time);
-        }
-      }
-
-      if (running) {
-        launch.getTimeStampsFromWavefront(next_times);
+      if (run_in_parallel) {
+        running |= processSubtreesInParallel(launch, partitions, groups,
+                                             device_resource_node, time,
+                                             /*push_only=*/true);
+      } else {
         for (auto &segment_runner_node : launch.sub_runner_nodes) {
-          segment_runner_node.getTimeStampsFromWavefront(next_times);
+          running |= pushOpsToWavefrontAndAllocateResource(
+              segment_runner_node, device_resource_node, time);
           for (auto &herd_runner_node : segment_runner_node.sub_runner_nodes) {
-            herd_runner_node.getTimeStampsFromWavefront(next_times);
+            running |= pushOpsToWavefrontAndAllocateResource(
+                herd_runner_node, device_resource_node, time);
           }
         }
       }
 
+      // Advance to the earliest pending completion event. Events which are
+      // already due only occur for zero-latency ops, in which case time
+      // advances by one cycle.
       uint64_t next_time = 0;
-      if (next_times.size())
-        next_time = *std::min_element(next_times.begin(), next_times.end());
-      time = std::max(time + 1, next_time);
+      if (running && !completion_events.empty())
+        next_time = completion_events.top().first;
+      next_time = std::max(time + 1, next_time);
+      recordFootprints(time);
+      accumulateBusyCycles(next_time - time);
+      time = next_time;
       if (time > 5000000000)
         running = false;
     }
   }
 
+  // Accumulate the cycles until the next time stamp onto the resources of the
+  // simulated device which are currently reserved
+  void accumulateBusyCycles(uint64_t cycles) {
+    for (unsigned i = device_resource_offsets[active_device];
+         i < device_resource_offsets[active_device + 1]; i++)
+      if (tracked_resources[i].res->isReserved)
+        statistics.busy_cycles[i] += cycles;
+  }
+
+  // Pop all completion events which are due at the current time stamp, and
+  // flag their runner nodes for execution
+  void popDueCompletionEvents(completionEventQueue &events, uint64_t time) {
+    while (!events.empty() && events.top().first <= time) {
+      events.top().second->completions_due++;
+      events.pop();
+    }
+  }
+
+  // Group the launch's sub-runner subtrees (a segment runner node and its herd
+  // runner nodes) which communicate through common channel symbols. Subtrees
+  // of different groups only interact through the launch runner node, and
+  // each own the resource hierarchies reserved when they start, so the groups
+  // can be simulated concurrently between two launch runner node updates.
+  void initSubtreePartitions(runnerNode &launch,
+                             std::vector<subtreePartition> &partitions,
+                             std::vector<std::vector<unsigned>> &groups) {
+    for (auto &segment_runner_node : launch.sub_runner_nodes) {
+      partitions.emplace_back();
+      partitions.back().root = &segment_runner_node;
+    }
+
+    // Union subtrees which share a channel symbol
+    std::vector<unsigned> leader(partitions.size());
+    std::iota(leader.begin(), leader.end(), 0);
+    std::function<unsigned(unsigned)> findLeader = [&](unsigned i) {
+      return leader[i] == i ? i : leader[i] = findLeader(leader[i]);
+    };
+    std::map<std::string, unsigned> channel_owner;
+    auto collectChannels = [&](dependencyGraph *g, unsigned idx) {
+      auto vp = boost::vertices(g->g);
+      for (auto v = vp.first; v != vp.second; ++v) {
+        if (g->g[*v].asyncEventType != dependencyEventType::Channel)
+          continue;
+        auto chan_op = dyn_cast<air::ChannelInterface>(g->g[*v].op);
+        auto it = channel_owner.insert(
+            std::make_pair(chan_op.getChanName().str(), idx));
+        leader[findLeader(idx)] = findLeader(it.first->second);
+      }
+    };
+    for (unsigned i = 0; i < partitions.size(); i++) {
+      collectChannels(partitions[i].root->ctrl_g, i);
+      for (auto &herd_runner_node : partitions[i].root->sub_runner_nodes)
+        collectChannels(herd_runner_node.ctrl_g, i);
+    }
+
+    // Within each group, subtrees keep their sequential order
+    std::map<unsigned, unsigned> group_of_leader;
+    for (unsigned i = 0; i < partitions.size(); i++) {
+      auto l = findLeader(i);
+      if (!group_of_leader.count(l)) {
+        group_of_leader[l] = groups.size();
+        groups.emplace_back();
+      }
+      groups[group_of_leader[l]].push_back(i);
+    }
+    LLVM_DEBUG(llvm::dbgs() << "simulating " << partitions.size()
+                            << " sub-runner subtrees in " << groups.size()
+                            << " independent groups\n");
+  }
+
+  // Run one phase of the tick loop over the launch's sub-runner subtrees, with
+  // independent groups on the thread pool. Each subtree buffers its trace and
+  // completion events, which are merged afterwards in the same order as a
+  // sequential pass would have produced them. If `push_only` is set, only
+  // ready events are pushed to wavefronts.
+  bool processSubtreesInParallel(runnerNode &launch,
+                                 std::vector<subtreePartition> &partitions,
+                                 std::vector<std::vector<unsigned>> &groups,
+                                 device &device_resource_node, uint64_t time,
+                                 bool push_only) {
+    // Sequentially, the first sub-runner node pops the events made due by the
+    // launch runner node
+    if (!push_only)
+      popDueCompletionEvents(completion_events, time);
+    for (auto &partition : partitions) {
+      partition.root->completion_events = &partition.completion_events;
+      partition.running = false;
+    }
+
+    mlir::parallelForEach(
+        launch.ctrl_g->hierarchyOp->getContext(), groups,
+        [&](std::vector<unsigned> &group) {
+          for (auto idx : group) {
+            auto &partition = partitions[idx];
+            auto &segment_runner_node = *partition.root;
+            if (push_only) {
+              partition.running |= pushOpsToWavefrontAndAllocateResource(
+                  segment_runner_node, device_resource_node, time, &partition);
+              for (auto &herd_runner_node :
+                   segment_runner_node.sub_runner_nodes)
+                partition.running |= pushOpsToWavefrontAndAllocateResource(
+                    herd_runner_node, device_resource_node, time, &partition);
+            } else {
+              partition.running |= processGraph(
+                  segment_runner_node, device_resource_node, time, &partition);
+              for (auto &herd_runner_node :
+                   segment_runner_node.sub_runner_nodes)
+                partition.running |= processGraph(
+                    herd_runner_node, device_resource_node, time, &partition);
+            }
+          }
+        });
+
+    bool running = false;
+    for (unsigned i = 0; i < partitions.size(); i++) {
+      auto &partition = partitions[i];
+      partition.root->completion_events = nullptr;
+      running |= partition.running;
+      trace.append(partition.trace);
+      partition.trace.clear();
+      if (launch_iteration_record)
+        launch_iteration_record->events.insert(
+            launch_iteration_record->events.end(), partition.events.begin(),
+            partition.events.end());
+      partition.events.clear();
+      // Sequentially, events made due by a subtree are popped by the next
+      // subtree's first runner node, if there is one
+      bool popped_by_next_subtree = !push_only && i + 1 < partitions.size();
+      while (!partition.completion_events.empty()) {
+        auto event = partition.completion_events.top();
+        partition.completion_events.pop();
+        if (popped_by_next_subtree && event.first <= time)
+          event.second->completions_due++;
+        else
+          completion_events.push(event);
+      }
+    }
+    return running;
+  }
+
 private:
   dependencyCanonicalizer canonicalizer;
   xilinx::air::dependencyContext dep_ctx;
+  // Channel index of the dependency context being simulated
+  const ChannelSymbolUses *channel_uses = nullptr;
 
-  llvm::raw_ostream &traceStream;
   llvm::json::Value &jsonModel;
   std::string sim_granularity;
+  // Simulate one core per class of symmetric cores in each herd, if
+  // simulating cores
+  bool fold_cores;
+
+  // Sink of the simulated trace
+  traceWriter trace;
 
   unsigned dispatch_slots;
   unsigned dispatch_dma_slots;
   unsigned core_dma_slots;
   unsigned herd_slots;
+  // Identical devices that independent launches are spread over
+  unsigned num_devices;
+  // Transfers held by the FIFO of a channel without a buffer_depth attribute
+  unsigned channel_buffer_depth;
 
   // Dependency graph constructed as Boost graph
   dependencyGraph hostGraph;
@@ -502,20 +1031,535 @@ private:
   // Host and segment runnerNodes
   runnerNode launch_runner_node;
 
+  // Completion events of all ops in flight, ordered by end time
+  completionEventQueue completion_events;
+
+  // Simulate every launch iteration, instead of fast-forwarding through
+  // iterations once a steady state is detected
+  bool full_simulation;
+
+  // Record of the launch iteration currently being simulated, if any
+  launchIterationRecord *launch_iteration_record;
+
+  // Simulate independent segment subtrees of a launch on a thread pool
+  bool parallel_segments;
+
+  // Share the data rate of the device's interfaces between concurrent
+  // transfers, following the model's "bandwidth_model"
+  bool bandwidth_contention = false;
+  bandwidthModel bandwidth;
+
+  // Serializes the op counting of linalg ops missing from `op_counts`, which
+  // builds IR, across all runners sharing an MLIR context
+  static std::mutex cost_model_mutex;
+
+  // Op counts of the linalg ops of the simulated function, counted before the
+  // simulation
+  const std::map<Operation *, CostModel::OpCountMap> *op_counts = nullptr;
+
+  // Compute cost of each linalg op modeled in the current simulation, and the
+  // number of lookups which found it. Lookups only share compute_costs_mutex
+  // with each other.
+  std::unordered_map<Operation *, uint64_t> compute_costs;
+  std::atomic<uint64_t> compute_cost_hits{0};
+  // Simulated events, and vertices and edges looked at while gathering their
+  // candidates for the wavefront
+  std::atomic<uint64_t> started_events{0};
+  std::atomic<uint64_t> vertex_visits{0};
+  std::shared_mutex compute_costs_mutex;
+
+  // Summary of the last simulated function
+  AIRRunnerResults results;
+
+  // Versions of the launches of the program being simulated, if any, and the
+  // last simulation of each version, for incremental re-simulation of programs
+  const std::map<Operation *, uint64_t> *launch_versions = nullptr;
+  std::unordered_map<uint64_t, cachedLaunch> launch_cache;
+
+  // Resources of the simulated device, and the statistics gathered over the
+  // simulation. Statistics are guarded by statistics_mutex while sub-runner
+  // subtrees are simulated in parallel.
+  std::vector<trackedResource> tracked_resources;
+  // Index of the first tracked resource of each device, followed by the number
+  // of tracked resources, and the device being simulated
+  std::vector<unsigned> device_resource_offsets;
+  unsigned active_device = 0;
+  runnerStatistics statistics;
+  criticalPathLog critical_path_log;
+  // Time at which each channel op waiting to start had its ssa dependencies
+  // fulfilled
+  std::unordered_map<dependencyNodeEntry *, uint64_t> channel_ready_times;
+  // L2 and L1 memories of the simulated device, their live bytes when last
+  // recorded, the time stamps at which their live bytes changed, and the
+  // periodic repeats of these changes past a steady state
+  std::vector<trackedResource> tracked_memories;
+  std::vector<double> live_bytes;
+  std::vector<std::vector<std::pair<uint64_t, double>>> footprint_timelines;
+  std::vector<std::vector<AIRRunnerFootprintRepeat>> footprint_repeats;
+  // Time at which each allocation waiting to start was first denied memory
+  std::unordered_map<dependencyNodeEntry *, uint64_t> allocation_blocked_times;
+  // Keys: channel symbol; mapped: occupancy of its FIFO in the current launch
+  // iteration and the time since which it has held
+  std::map<std::string, std::pair<unsigned, uint64_t>> channel_occupancy_levels;
+  // Keys: trace pid and first thread id of a page of threads beyond the first
+  // of a core; mapped: name of the page's first thread. Pages are kept across
+  // simulations, since replayed launches reuse them.
+  std::map<std::pair<int64_t, int64_t>, std::string> trace_thread_pages;
+  std::mutex statistics_mutex;
+
+  // Guards channel bookkeeping on the launch runner node while sub-runner
+  // subtrees are simulated in parallel
+  std::recursive_mutex channel_state_mutex;
+
+  //===----------------------------------------------------------------------===//
+  // Statistics helper functions
+  //===----------------------------------------------------------------------===//
+
+  // Record the bytes moved by a data movement op
+  transferRecord recordTransfer(device &d, unsigned srcSpace,
+                                unsigned dstSpace, int64_t volume,
+                                mlir::Type ty) {
+    transferRecord transfer;
+    auto datawidth = d.datatypes.find(getElementTypeAsString(ty));
+    if (datawidth == d.datatypes.end())
+      return transfer;
+    transfer = {srcSpace, dstSpace, volume * datawidth->second};
+    std::lock_guard<std::mutex> lock(statistics_mutex);
+    statistics.transferred_bytes[{srcSpace, dstSpace}] += transfer.bytes;
+    return transfer;
+  }
+
+  // Record when a channel op waiting to start first has its ssa dependencies
+  // fulfilled. From then on, it is stalled on its counterpart or on ports.
+  void recordChannelOpReadiness(
+      runnerNode &c,
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> &dep_list,
+      dependencyNodeEntry &node, uint64_t time, bool dep_fulfilled) {
+    {
+      std::lock_guard<std::mutex> lock(statistics_mutex);
+      if (channel_ready_times.count(&node))
+        return;
+    }
+    if (!dep_fulfilled) {
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> ssa_deps;
+      for (auto &dep : dep_list)
+        if (dep.second != "sym")
+          ssa_deps.push_back(dep);
+      if (!c.checkAllDependenciesFulfillment(ssa_deps, node, time, true))
+        return;
+    }
+    std::lock_guard<std::mutex> lock(statistics_mutex);
+    channel_ready_times[&node] = time;
+  }
+
+  // Record the occupancy of a channel's FIFO after one of its ops started or
+  // executed, adding the cycles spent at its previous occupancy
+  void recordChannelOccupancy(runnerNode &c, dependencyNodeEntry &node,
+                              uint64_t time) {
+    auto chan_op = dyn_cast<air::ChannelInterface>(node.op);
+    if (!chan_op)
+      return;
+    std::string name = chan_op.getChanName().str();
+    unsigned depth = c.getChannelBufferDepth(chan_op);
+    unsigned level = c.getChannelOccupancy(name);
+    std::lock_guard<std::mutex> lock(statistics_mutex);
+    auto &occupancy = statistics.channel_occupancy[name];
+    occupancy.depth = depth;
+    occupancy.peak = std::max(occupancy.peak, level);
+    // A channel is empty from the start of the launch iteration until its
+    // first op
+    uint64_t iteration_start =
+        launch_iteration_record ? launch_iteration_record->start_time : time;
+    auto &held = channel_occupancy_levels
+                     .insert({name, std::make_pair(0u, iteration_start)})
+                     .first->second;
+    if (held.first == level)
+      return;
+    occupancy.cycles[held.first] += time - held.second;
+    held = {level, time};
+  }
+
+  // Add the cycles that each channel's FIFO held its last occupancy until the
+  // end of a launch iteration
+  void closeChannelOccupancy(uint64_t time) {
+    for (auto &entry : channel_occupancy_levels)
+      statistics.channel_occupancy[entry.first].cycles[entry.second.first] +=
+          time - entry.second.second;
+    channel_occupancy_levels.clear();
+  }
+
+  bool isAllocation(dependencyNodeEntry &node) {
+    return node.asyncEventType == dependencyEventType::Execute &&
+           node.getAsyncEventName() == "AllocOp";
+  }
+
+  Operation *getChildOp(dependencyNodeEntry &node) {
+    return &*(node.op->getRegions().front().getOps().begin());
+  }
+
+  // Record when an allocation first waits for memory to be freed
+  void recordAllocationBlocked(dependencyNodeEntry &node, uint64_t time) {
+    std::lock_guard<std::mutex> lock(statistics_mutex);
+    if (allocation_blocked_times.insert({&node, time}).second)
+      LLVM_DEBUG(llvm::dbgs() << "memory over-subscribed at " << time
+                              << ", deferring "
+                              << air::to_string(getChildOp(node)) << "\n");
+  }
+
+  // Record the live bytes of each memory at the end of a time stamp, if they
+  // changed
+  void recordFootprints(uint64_t time) {
+    for (unsigned i = 0; i < tracked_memories.size(); i++) {
+      auto mem = static_cast<memory *>(tracked_memories[i].res);
+      if (mem->bytes_used == live_bytes[i])
+        continue;
+      live_bytes[i] = mem->bytes_used;
+      footprint_timelines[i].push_back({time, mem->bytes_used});
+      statistics.peak_bytes[i] =
+          std::max(statistics.peak_bytes[i], mem->bytes_used);
+    }
+  }
+
+  // Repeat the footprint changes recorded since the given timeline sizes for
+  // `times` more periods. The changes are recorded once with their repeat
+  // count, so that timelines do not grow with the number of repeats.
+  void repeatFootprintTimelines(std::vector<size_t> &sizes, uint64_t times,
+                                uint64_t period) {
+    for (unsigned i = 0; i < footprint_timelines.size(); i++)
+      if (sizes[i] < footprint_timelines[i].size())
+        footprint_repeats[i].push_back(
+            {sizes[i], footprint_timelines[i].size(), period, times});
+  }
+
+  // Record an op which started at its start time: the stall of channel ops
+  // and allocations, and the op's critical predecessor
+  void recordOpStart(
+      runnerNode &c, dependencyNodeEntry &node, int64_t runner_id,
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> &dep_list) {
+    // A channel get waits on the puts of its channel
+    std::vector<mlir::Operation *> partner_ops;
+    if (auto get = dyn_cast<air::ChannelGetOp>(node.op)) {
+      for (auto put : air::getTheOtherChannelOpThroughSymbol(get, channel_uses))
+        partner_ops.push_back(put.getOperation());
+    }
+    std::lock_guard<std::mutex> lock(statistics_mutex);
+    auto blocked = allocation_blocked_times.find(&node);
+    if (blocked != allocation_blocked_times.end()) {
+      auto alloc = cast<memref::AllocOp>(getChildOp(node));
+      auto space = alloc.getMemref().getType().cast<MemRefType>();
+      auto &stall = statistics.allocation_stalls[space.getMemorySpaceAsInt()];
+      stall.first++;
+      stall.second += node.start_time - blocked->second;
+      allocation_blocked_times.erase(blocked);
+    }
+    if (node.asyncEventType == dependencyEventType::Channel) {
+      auto chan_op = dyn_cast<air::ChannelInterface>(node.op);
+      auto &stall = statistics.channel_stalls[chan_op.getChanName().str()];
+      stall.first++;
+      auto ready = channel_ready_times.find(&node);
+      if (ready != channel_ready_times.end()) {
+        stall.second += node.start_time - ready->second;
+        channel_ready_times.erase(ready);
+      }
+    }
+    if (isa<air::SegmentOp, air::HerdOp>(node.op))
+      recordSpanStart(node.op, node.start_time);
+    critical_path_log.record(&node, runner_id, node.start_time, node.end_time,
+                             dep_list, partner_ops, c.ctrl_g->hierarchyOp);
+  }
+
+  // Record the end time of an op, which data movement under bandwidth
+  // contention only knows once the op is done
+  void recordOpEnd(dependencyNodeEntry &node) {
+    std::lock_guard<std::mutex> lock(statistics_mutex);
+    critical_path_log.setEndTime(&node, node.end_time);
+    // Every core of a herd ends with its own terminator
+    if (isa<air::SegmentTerminatorOp, air::HerdTerminatorOp>(node.op))
+      recordSpanEnd(node.op->getParentOp(), node.end_time);
+    if (node.category == dependencyNodeCategory::Data ||
+        node.category == dependencyNodeCategory::Compute) {
+      auto &op = statistics.op_cycles[{node.asyncEventNameId,
+                                       node.detailedDescriptionId}];
+      op.first++;
+      op.second += node.end_time - node.start_time;
+    }
+  }
+
+  // Record the start of an instance of an air.launch, air.segment or air.herd
+  void recordSpanStart(Operation *op, uint64_t time) {
+    auto &span = statistics.spans[op];
+    if (!span.instances++)
+      span.start = time;
+  }
+
+  void recordSpanEnd(Operation *op, uint64_t time) {
+    auto &span = statistics.spans[op];
+    span.end = std::max(span.end, time);
+  }
+
+  // Critical path of the last simulated iteration of a launch
+  AIRRunnerCriticalPath getCriticalPath(dependencyGraph &launchGraph) {
+    AIRRunnerCriticalPath path;
+    path.launch = air::to_string(launchGraph.hierarchyOp);
+    for (auto &instance : critical_path_log.getPathTo(
+             &launchGraph.g[launchGraph.terminator_vertex])) {
+      AIRRunnerCriticalPathOp op;
+      op.name = instance.node->getAsyncEventName() +
+                instance.node->getDetailedDescription();
+      op.runner = instance.pid;
+      op.start = instance.start_time;
+      op.end = instance.end_time;
+      path.ops.push_back(op);
+    }
+    if (path.ops.size())
+      path.cycles = path.ops.back().end - path.ops.front().start;
+    return path;
+  }
+
+  // Summarize the gathered statistics in the results
+  void collectStatisticsIntoResults() {
+    double du_cycles = 0, tile_cycles = 0;
+    unsigned num_dus = 0, num_tiles = 0;
+    for (unsigned i = 0; i < tracked_resources.size(); i++) {
+      auto &r = tracked_resources[i];
+      results.resources.push_back({r.name, r.kind, statistics.busy_cycles[i]});
+      if (r.kind == "du") {
+        du_cycles += statistics.busy_cycles[i];
+        num_dus++;
+      } else if (r.kind == "tile") {
+        tile_cycles += statistics.busy_cycles[i];
+        num_tiles++;
+      }
+    }
+    if (results.cycles && num_dus)
+      results.du_utilization = du_cycles / num_dus / results.cycles;
+    if (results.cycles && num_tiles)
+      results.tile_utilization = tile_cycles / num_tiles / results.cycles;
+    for (auto &entry : statistics.channel_stalls)
+      results.channels.push_back(
+          {entry.first, entry.second.first, entry.second.second});
+    for (auto &entry : statistics.channel_occupancy) {
+      AIRRunnerChannelOccupancy occupancy;
+      occupancy.name = entry.first;
+      occupancy.depth = entry.second.depth;
+      occupancy.peak = entry.second.peak;
+      for (auto &level : entry.second.cycles)
+        occupancy.cycles.push_back(level);
+      results.channel_occupancy.push_back(std::move(occupancy));
+    }
+    for (auto &entry : statistics.transferred_bytes)
+      results.transfers.push_back(
+          {lookUpMemorySpaceFromInt(entry.first.first),
+           lookUpMemorySpaceFromInt(entry.first.second), entry.second});
+    for (unsigned i = 0; i < tracked_memories.size(); i++) {
+      auto mem = static_cast<memory *>(tracked_memories[i].res);
+      results.memories.push_back(
+          {tracked_memories[i].name,
+           lookUpMemorySpaceFromInt(mem->memory_space), mem->bytes,
+           statistics.peak_bytes[i], std::move(footprint_timelines[i]),
+           std::move(footprint_repeats[i])});
+    }
+    for (auto &entry : statistics.allocation_stalls)
+      results.allocation_stalls.push_back(
+          {lookUpMemorySpaceFromInt(entry.first), entry.second.first,
+           entry.second.second});
+    for (auto &entry : statistics.op_cycles)
+      results.ops.push_back(
+          {getInternedDependencyString(entry.first.first) +
+               getInternedDependencyString(entry.first.second),
+           entry.second.first, entry.second.second});
+    std::sort(results.ops.begin(), results.ops.end(),
+              [](auto &a, auto &b) { return a.name < b.name; });
+    // Spans are listed by start time, outer hierarchy ops first
+    auto getDepth = [](Operation *op) {
+      return isa<air::LaunchOp>(op) ? 0 : isa<air::SegmentOp>(op) ? 1 : 2;
+    };
+    std::vector<std::pair<Operation *, hierarchySpan>> spans(
+        statistics.spans.begin(), statistics.spans.end());
+    std::sort(spans.begin(), spans.end(), [&](auto &a, auto &b) {
+      return std::make_tuple(a.second.start, getDepth(a.first),
+                             getIdAttr(a.first)) <
+             std::make_tuple(b.second.start, getDepth(b.first),
+                             getIdAttr(b.first));
+    });
+    // Spans are named by the symbol of their op, if it has one
+    auto getName = [](Operation *op) {
+      if (auto sym = op->getAttrOfType<StringAttr>(
+              SymbolTable::getSymbolAttrName()))
+        return sym.str();
+      return air::to_string(op);
+    };
+    const char *kinds[] = {"launch", "segment", "herd"};
+    for (auto &entry : spans)
+      results.spans.push_back({getName(entry.first),
+                               kinds[getDepth(entry.first)],
+                               getIdAttr(entry.first), entry.second.instances,
+                               entry.second.start, entry.second.end});
+  }
+
+  //===----------------------------------------------------------------------===//
+  // Launch cache helper functions
+  //===----------------------------------------------------------------------===//
+
+  // Append the trace events of a launch iteration starting at `start_time` to
+  // a launch being cached
+  void recordCachedLaunchEvents(cachedLaunch &cached,
+                                std::vector<launchTraceEvent> &events,
+                                uint64_t start_time) {
+    for (auto &e : events) {
+      if (!trace.isEnabled(e.category))
+        continue;
+      cached.events.push_back(e);
+      cached.events.back().time += start_time - cached.start_time;
+    }
+  }
+
+  // Cache a launch which was simulated up to `time`
+  void cacheLaunch(Operation *launch_op, cachedLaunch &cached, uint64_t time) {
+    auto version = launch_versions->find(launch_op);
+    if (version == launch_versions->end())
+      return;
+    cached.duration = time - cached.start_time;
+    cached.end_statistics = statistics;
+    for (unsigned i = 0; i < footprint_timelines.size(); i++) {
+      auto begin = cached.footprint_timeline_sizes[i];
+      cached.footprints.emplace_back(footprint_timelines[i].begin() + begin,
+                                     footprint_timelines[i].end());
+      cached.footprint_repeats.emplace_back();
+      for (auto repeat : footprint_repeats[i]) {
+        if (repeat.begin < begin)
+          continue;
+        repeat.begin -= begin;
+        repeat.end -= begin;
+        cached.footprint_repeats.back().push_back(repeat);
+      }
+    }
+    cached.critical_path = results.critical_paths.back();
+    cached.iterations = results.simulation.launches.back();
+    cached.iterations.replayed = true;
+    launch_cache[version->second] = std::move(cached);
+  }
+
+  // Replay a cached launch at `time`, if the launch is unchanged since it was
+  // cached and starts from the same occupancy of the same device
+  bool replayCachedLaunch(Operation *launch_op, unsigned device_id,
+                          std::vector<double> &occupancy, uint64_t &time) {
+    auto version = launch_versions->find(launch_op);
+    if (version == launch_versions->end())
+      return false;
+    auto it = launch_cache.find(version->second);
+    if (it == launch_cache.end() || it->second.device_id != device_id ||
+        it->second.occupancy != occupancy)
+      return false;
+    auto &cached = it->second;
+    LLVM_DEBUG(llvm::dbgs() << "launch " << air::to_string(launch_op)
+                            << " is unchanged; replaying " << cached.duration
+                            << " cycles\n");
+    auto shift = [&](uint64_t t) { return t - cached.start_time + time; };
+    for (auto &e : cached.events)
+      trace.writeEvent(getInternedDependencyString(e.name_id),
+                       getInternedDependencyString(e.description_id), "layer",
+                       e.ph, time + e.time, e.tid, e.pid);
+    statistics.addSince(cached.statistics, cached.end_statistics,
+                        cached.start_time, time);
+    for (unsigned i = 0; i < footprint_timelines.size(); i++) {
+      auto begin = footprint_timelines[i].size();
+      for (auto repeat : cached.footprint_repeats[i]) {
+        repeat.begin += begin;
+        repeat.end += begin;
+        footprint_repeats[i].push_back(repeat);
+      }
+      for (auto &entry : cached.footprints[i]) {
+        footprint_timelines[i].push_back({shift(entry.first), entry.second});
+        statistics.peak_bytes[i] =
+            std::max(statistics.peak_bytes[i], entry.second);
+      }
+    }
+    results.critical_paths.push_back(cached.critical_path);
+    for (auto &op : results.critical_paths.back().ops) {
+      op.start = shift(op.start);
+      op.end = shift(op.end);
+    }
+    results.simulation.launches.push_back(cached.iterations);
+    time += cached.duration;
+    return true;
+  }
+
   //===----------------------------------------------------------------------===//
   // Trace helper functions
   //===----------------------------------------------------------------------===//
 
+  // Emit an op's begin or end event, and record it for steady-state
+  // detection. Events of a subtree simulated in parallel go to its partition.
+  void emitLayerTraceEvent(dependencyNodeEntry &node, char ph, uint64_t time,
+                           int64_t tid, int64_t pid,
+                           subtreePartition *partition = nullptr) {
+    if (launch_iteration_record) {
+      launchTraceEvent event = {node.asyncEventNameId,
+                                node.detailedDescriptionId,
+                                node.category,
+                                ph,
+                                time - launch_iteration_record->start_time,
+                                tid,
+                                pid};
+      if (partition)
+        partition->events.push_back(event);
+      else
+        launch_iteration_record->events.push_back(event);
+    }
+    if (!trace.isEnabled(node.category))
+      return;
+    if (partition)
+      trace.writeEvent(partition->trace, node.getAsyncEventName(),
+                       node.getDetailedDescription(), "layer", ph, time, tid,
+                       pid);
+    else
+      trace.writeEvent(node.getAsyncEventName(), node.getDetailedDescription(),
+                       "layer", ph, time, tid, pid);
+  }
+
+  // Emit an op's begin or end event on a trace thread slot of the core of a
+  // runner node, and replay it on the symmetric cores folded into the runner
+  // node, if any
+  void emitLayerTraceEvents(runnerNode &c, dependencyNodeEntry &node, char ph,
+                            uint64_t time, unsigned slot, int64_t pid,
+                            subtreePartition *partition = nullptr) {
+    emitLayerTraceEvent(node, ph, time,
+                        getTraceThreadId(c, slot, c.ctrl_g->position, pid),
+                        pid, partition);
+    for (auto &position : c.ctrl_g->folded_positions)
+      emitLayerTraceEvent(node, ph, time,
+                          getTraceThreadId(c, slot, position, pid), pid,
+                          partition);
+  }
+
+  // Get the trace thread id of a slot on the core at `position` of a runner
+  // node, remembering the pages of threads which a core uses beyond its first
+  int64_t getTraceThreadId(runnerNode &c, unsigned slot,
+                           std::vector<unsigned> &position, int64_t pid) {
+    if (slot > trace_threads_per_core && !position.empty()) {
+      unsigned page = (slot - 1) / trace_threads_per_core;
+      int64_t page_tid =
+          c.getTraceThreadId(page * trace_threads_per_core + 1, position);
+      std::string thread_name = "core [" + to_string(position) + "] page " +
+                                std::to_string(page + 1);
+      std::lock_guard<std::mutex> lock(statistics_mutex);
+      trace_thread_pages.try_emplace(std::make_pair(pid, page_tid),
+                                     thread_name);
+    }
+    return c.getTraceThreadId(slot, position);
+  }
+
   // Write process names in trace metadata
   void writeTraceMetadataProcNames(dependencyGraph &hostGraph) {
     for (auto &launchGraph : hostGraph.subgraphs) {
       // Write launch process name to trace metadata
-      emitTraceMetadataEvent(traceStream, "process_name", "name",
-                             air::to_string(launchGraph.hierarchyOp), "M",
-                             getIdAttr(launchGraph.hierarchyOp));
-      emitTraceMetadataEvent(traceStream, "process_sort_index", "sort_index",
-                             std::to_string(getIdAttr(launchGraph.hierarchyOp)),
-                             "M", getIdAttr(launchGraph.hierarchyOp));
+      trace.writeMetadata("process_name", "name",
+                          air::to_string(launchGraph.hierarchyOp),
+                          getIdAttr(launchGraph.hierarchyOp));
+      trace.writeMetadata("process_sort_index", "sort_index",
+                          std::to_string(getIdAttr(launchGraph.hierarchyOp)),
+                          getIdAttr(launchGraph.hierarchyOp));
       for (auto &segmentGraph : launchGraph.subgraphs) {
         // Write segment process name to trace metadata
         std::string seg_process_info = "";
@@ -523,11 +1567,10 @@ private:
         seg_process_info += air::to_string(seg);
         seg_process_info += "[" + std::to_string(*seg.getNumCols()) + ", " +
                             std::to_string(*seg.getNumRows()) + "]";
-        emitTraceMetadataEvent(traceStream, "process_name", "name",
-                               seg_process_info, "M", getIdAttr(seg));
-        emitTraceMetadataEvent(traceStream, "process_sort_index", "sort_index",
-                               std::to_string(getIdAttr(seg)), "M",
-                               getIdAttr(seg));
+        trace.writeMetadata("process_name", "name", seg_process_info,
+                            getIdAttr(seg));
+        trace.writeMetadata("process_sort_index", "sort_index",
+                            std::to_string(getIdAttr(seg)), getIdAttr(seg));
         for (auto &herdGraph : segmentGraph.subgraphs) {
           // Only write herd process name metadata once per herd
           bool print_pid_metadata_for_herd = true;
@@ -548,32 +1591,35 @@ private:
             herd_process_info += air::to_string(herd);
             herd_process_info += "[" + std::to_string(herd.getNumCols()) +
                                  ", " + std::to_string(herd.getNumRows()) + "]";
-            emitTraceMetadataEvent(traceStream, "process_name", "name",
-                                   herd_process_info, "M", getIdAttr(herd));
-            emitTraceMetadataEvent(
-                traceStream, "process_sort_index", "sort_index",
-                std::to_string(getIdAttr(herd)), "M", getIdAttr(herd));
+            trace.writeMetadata("process_name", "name", herd_process_info,
+                                getIdAttr(herd));
+            trace.writeMetadata("process_sort_index", "sort_index",
+                                std::to_string(getIdAttr(herd)),
+                                getIdAttr(herd));
           }
           if (print_tid_metadata_for_core) {
-            // Write herd process name to trace metadata
-            std::string thread_name =
-                "core [" + to_string(herdGraph.position) + "]";
-            // Hardcoded maximum number of threads per core
-            unsigned max_num_threads_per_core = 10;
-            unsigned core_id = canonicalizer.getIteratorFromPosition(
-                                   herdGraph.position, herdGraph.hierarchyOp) *
-                                   max_num_threads_per_core +
-                               1;
-            emitTraceMetadataEvent(traceStream, "thread_name", "name",
-                                   thread_name, "M",
-                                   getIdAttr(herdGraph.hierarchyOp), core_id);
-            // Iteratively write thread sort index for every possible thread in
-            // a core
-            for (unsigned i = 0; i < max_num_threads_per_core; i++) {
-              emitTraceMetadataEvent(traceStream, "thread_sort_index",
-                                     "sort_index", std::to_string(core_id + i),
-                                     "M", getIdAttr(herdGraph.hierarchyOp),
-                                     core_id + i);
+            // Cores folded into this core's graph get threads of their own
+            std::vector<std::vector<unsigned>> positions = {herdGraph.position};
+            positions.insert(positions.end(),
+                             herdGraph.folded_positions.begin(),
+                             herdGraph.folded_positions.end());
+            for (auto &position : positions) {
+              // Write herd process name to trace metadata
+              std::string thread_name = "core [" + to_string(position) + "]";
+              unsigned core_id = canonicalizer.getIteratorFromPosition(
+                                     position, herdGraph.hierarchyOp) *
+                                     trace_threads_per_core +
+                                 1;
+              trace.writeMetadata("thread_name", "name", thread_name,
+                                  getIdAttr(herdGraph.hierarchyOp), core_id);
+              // Iteratively write thread sort index for every thread in the
+              // first page of a core
+              for (unsigned i = 0; i < trace_threads_per_core; i++) {
+                trace.writeMetadata("thread_sort_index", "sort_index",
+                                    std::to_string(core_id + i),
+                                    getIdAttr(herdGraph.hierarchyOp),
+                                    core_id + i);
+              }
             }
           }
         }
@@ -581,19 +1627,16 @@ private:
     }
   }
 
-  // Convert time from cycle count to time stamp in ms (with 3 d.p.)
-  std::string convertToTimeStampInStr(uint64_t time, device &d) {
-    uint64_t time_in_ns =
-        (uint64_t)std::round(((double)time) / (1000000000.0 / (double)d.clock));
-    uint64_t int_part = (uint64_t)(time_in_ns / 1000);
-    uint64_t frac_part = (uint64_t)(time_in_ns % 1000);
-    std::string zero_fill = "";
-    if (frac_part < 10)
-      zero_fill = "00";
-    else if (frac_part < 100)
-      zero_fill = "0";
-    return std::to_string(int_part) + "." + zero_fill +
-           std::to_string(frac_part);
+  // Write thread names and sort indices of the pages of threads which cores
+  // used beyond their first, once they are known from the simulation
+  void writeTraceMetadataThreadPages() {
+    for (auto &[key, thread_name] : trace_thread_pages) {
+      auto [pid, page_tid] = key;
+      trace.writeMetadata("thread_name", "name", thread_name, pid, page_tid);
+      for (unsigned i = 0; i < trace_threads_per_core; i++)
+        trace.writeMetadata("thread_sort_index", "sort_index",
+                            std::to_string(page_tid + i), pid, page_tid + i);
+    }
   }
 
   //===----------------------------------------------------------------------===//
@@ -611,18 +1654,23 @@ private:
     if (cps == 0.0f) {
       op->emitError("device clock frequency not found in JSON model");
     }
+    // Sub-runner subtrees may model ops concurrently, so the device's tables
+    // are only looked up, never inserted into
     unsigned datawidth = 0;
-    if (auto bytes = d.datatypes[getElementTypeAsString(ty)]) {
-      datawidth = bytes;
+    auto datatype = d.datatypes.find(getElementTypeAsString(ty));
+    if (datatype != d.datatypes.end()) {
+      datawidth = datatype->second;
       if (!datawidth)
         op->emitOpError("found data type with zero width in JSON model");
     } else
       op->emitOpError("data type not found in JSON model");
 
     double bytes = volume * datawidth;
-    double bps = d.interfaces[{srcSpace, dstSpace}]->data_rate;
-    if (bps == 0.0f)
+    double bps = d.getInterfaceDataRate(srcSpace, dstSpace);
+    if (bps == 0.0f) {
       op->emitOpError("data rate not found in JSON model");
+      return 1;
+    }
     double seconds = bytes / bps;
     return (uint64_t)ceil(seconds * cps);
   }
@@ -647,58 +1695,113 @@ private:
     return output;
   }
 
+  // The cost of an op only depends on the op and the device, so it is computed
+  // once per simulation and looked up for every later instance of the op
   uint64_t getComputeCostFromCostModel(device &d, Operation *op) {
-    uint64_t compute_op_cost = 0;
-    auto opCounts = xilinx::air::CostModel().getOpCounts(op);
-    std::string skip = "footprint";
-    std::string memops = "reads;writes;";
-    std::string cpuops = "math.rsqrt;";
-    cpuops += "arith.mulf;arith.divf;arith.addf;arith.subf;arith.truncf;"
-              "arith.cmpf;arith.maxf;";
-    cpuops += "arith.muli;arith.divsi;arith.divsi;arith.addi;arith.subi;"
-              "arith.trunci;arith.cmpi;arith.maxi";
-    cpuops += "std.select";
-    uint64_t memory_op_count = 0;
-    uint64_t compute_op_count = 0;
-    for (auto &p : opCounts.map) {
+    {
+      std::shared_lock<std::shared_mutex> lock(compute_costs_mutex);
+      auto it = compute_costs.find(op);
+      if (it != compute_costs.end()) {
+        compute_cost_hits++;
+        return it->second;
+      }
+    }
+    uint64_t compute_op_cost = computeCostFromCostModel(d, op);
+    std::unique_lock<std::shared_mutex> lock(compute_costs_mutex);
+    compute_costs.insert({op, compute_op_cost});
+    return compute_op_cost;
+  }
+
+  // Roofline estimate of a linalg op's cycles: the longer of the time to issue
+  // its compute ops, each opcode at its own throughput, and the time to load
+  // and store its operands in L1
+  uint64_t computeCostFromCostModel(device &d, Operation *op) {
+    CostModel::OpCountMap counted;
+    const CostModel::OpCountMap *opCounts = nullptr;
+    if (op_counts) {
+      auto it = op_counts->find(op);
+      if (it != op_counts->end())
+        opCounts = &it->second;
+    }
+    if (!opCounts) {
+      std::lock_guard<std::mutex> lock(cost_model_mutex);
+      counted = xilinx::air::CostModel().getOpCounts(op);
+      opCounts = &counted;
+    }
+    static const std::set<std::string> skipped = {
+        "footprint", "reads", "writes", "read_bytes", "write_bytes"};
+    static const std::set<std::string> cpuops = {
+        "math.rsqrt",  "arith.mulf",   "arith.divf", "arith.addf",
+        "arith.subf",  "arith.truncf", "arith.cmpf", "arith.maxf",
+        "arith.muli",  "arith.divsi",  "arith.addi", "arith.subi",
+        "arith.trunci", "arith.cmpi",  "arith.maxi", "std.select"};
+
+    // defaults
+    double num_cores = 1;              // one because the post-tiling code in
+                                       // air.herd's body is for each core
+    double ops_per_core_per_cycle = 8; // vector width for this type
+    double efficiency = 1.0f;
+    std::map<std::string, double> opcode_throughputs;
+    std::optional<std::pair<double, double>> l1_bandwidth;
+
+    // if kernels exists, assume everthing else exists
+    // Get operation datatype as the first operand's datatype
+    auto op_datatype = getElementTypeAsString(op->getOperandTypes()[0]);
+    auto kernel_it = d.kernels.find(air::to_string(op));
+    if (kernel_it != d.kernels.end()) {
+      auto k = kernel_it->second;
+      auto datatype = k->datatypes.find(op_datatype);
+      if (datatype != k->datatypes.end()) {
+        ops_per_core_per_cycle = datatype->second.second;
+        efficiency = datatype->second.first;
+      }
+      auto throughputs = k->opcode_throughputs.find(op_datatype);
+      if (throughputs != k->opcode_throughputs.end())
+        opcode_throughputs = throughputs->second;
+      auto bandwidth = k->l1_bandwidths.find(op_datatype);
+      if (bandwidth != k->l1_bandwidths.end())
+        l1_bandwidth = bandwidth->second;
+    }
+
+    // Keys: ops per core per cycle; mapped: number of ops issued at it
+    std::map<double, uint64_t> compute_op_counts;
+    for (auto &p : opCounts->map) {
       auto name = std::get<0>(p);
       auto count = std::get<1>(p);
-      if (memops.find(name) != std::string::npos)
-        memory_op_count += count;
-      else if (cpuops.find(name) != std::string::npos)
-        compute_op_count += count;
-      else if (skip.find(name) == std::string::npos)
+      auto throughput = opcode_throughputs.find(name);
+      if (throughput != opcode_throughputs.end())
+        compute_op_counts[throughput->second] += count;
+      else if (cpuops.count(name))
+        compute_op_counts[ops_per_core_per_cycle] += count;
+      else if (!skipped.count(name))
         LLVM_DEBUG(llvm::dbgs() << name << " not counted\n");
     }
 
-    if (compute_op_count) {
-      // defaults
-      double num_cores = 1;              // one because the post-tiling code in
-                                         // air.herd's body is for each core
-      double ops_per_core_per_cycle = 8; // vector width for this type
-      double cycles_per_second = 1e9;
-      double efficiency = 1.0f;
-
-      // if kernels exists, assume everthing else exists
-      // Get operation datatype as the first operand's datatype
-      auto op_datatype = getElementTypeAsString(op->getOperandTypes()[0]);
-      if (d.kernels.count(air::to_string(op))) {
-        if (d.kernels[air::to_string(op)]->datatypes.count(op_datatype)) {
-          ops_per_core_per_cycle =
-              d.kernels[air::to_string(op)]->datatypes[op_datatype].second;
-          efficiency =
-              d.kernels[air::to_string(op)]->datatypes[op_datatype].first;
-        }
-      }
-      cycles_per_second = d.clock;
-
-      double ops_per_cycle = num_cores * ops_per_core_per_cycle * efficiency;
+    double compute_cycles = 0;
+    for (auto &entry : compute_op_counts) {
+      double ops_per_cycle = num_cores * entry.first * efficiency;
       if (ops_per_cycle <= 0)
         op->emitOpError("ops per cycle in model must be greater than zero");
+      compute_cycles += entry.second / ops_per_cycle;
+    }
 
-      double cycles = ceil(compute_op_count / ops_per_cycle);
-      compute_op_cost = cycles;
+    double memory_cycles = 0;
+    if (l1_bandwidth) {
+      auto getBytes = [&](std::string key) -> double {
+        auto it = opCounts->map.find(key);
+        return it != opCounts->map.end() ? it->second : 0;
+      };
+      if (l1_bandwidth->first > 0)
+        memory_cycles = std::max(memory_cycles,
+                                 getBytes("read_bytes") /
+                                     (num_cores * l1_bandwidth->first));
+      if (l1_bandwidth->second > 0)
+        memory_cycles = std::max(memory_cycles,
+                                 getBytes("write_bytes") /
+                                     (num_cores * l1_bandwidth->second));
     }
+
+    uint64_t compute_op_cost = ceil(std::max(compute_cycles, memory_cycles));
     return compute_op_cost;
   }
 
@@ -754,20 +1857,159 @@ private:
   // Misc. helper functions
   //===----------------------------------------------------------------------===//
 
-  // Move an element of the vector to the back
-  template <typename T>
-  void moveItemToBack(std::vector<T> &v, size_t itemIndex) {
-    auto it = v.begin() + itemIndex;
-    std::rotate(it, it + 1, v.end());
+}; // AIRRunner_impl
+
+std::mutex AIRRunner::AIRRunner_impl::cost_model_mutex;
+
+// Launch versions are unique across programs, so that a runner never mistakes
+// the launch of one program for that of another
+static std::atomic<uint64_t> launch_version_counter(0);
+
+AIRRunnerProgram::AIRRunnerProgram(func::FuncOp &toplevel,
+                                   std::string sim_granularity,
+                                   bool fold_cores)
+    : toplevel(toplevel), sim_granularity(sim_granularity),
+      fold_cores(fold_cores) {
+  invalidate({toplevel});
+}
+
+// Hash an op and the ops nested under it, stopping at hierarchy ops if
+// `host_only`. Ops are hashed by address, attributes, operands and result
+// types, which are all uniqued, so any edit changes the hash.
+static llvm::hash_code getFingerprint(Operation *root, bool host_only) {
+  llvm::hash_code hash = 0;
+  root->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    hash = llvm::hash_combine(hash, op, op->getName().getAsOpaquePointer(),
+                              op->getAttrDictionary().getAsOpaquePointer());
+    for (auto operand : op->getOperands())
+      hash = llvm::hash_combine(hash, operand.getAsOpaquePointer());
+    for (auto type : op->getResultTypes())
+      hash = llvm::hash_combine(hash, type.getAsOpaquePointer());
+    if (host_only && op != root && isa<air::HierarchyInterface>(op))
+      return WalkResult::skip();
+    return WalkResult::advance();
+  });
+  return hash;
+}
+
+void AIRRunnerProgram::invalidate(ArrayRef<Operation *> changed_ops) {
+  dependencyCanonicalizer canonicalizer;
+  canonicalizer.removeDepListRepetition(toplevel);
+
+  // Edits outside of the launches change the host graph, which is rebuilt
+  // along with the graphs of all launches
+  bool host_changed = getFingerprint(toplevel, true) != host_fingerprint;
+  std::set<Operation *> changed_launches;
+  for (auto op : changed_ops) {
+    auto launch = dyn_cast<air::LaunchOp>(op);
+    if (!launch)
+      launch = op->getParentOfType<air::LaunchOp>();
+    if (launch)
+      changed_launches.insert(launch);
+    else
+      host_changed = true;
+  }
+  std::vector<air::LaunchOp> launches;
+  toplevel.walk([&](air::LaunchOp launch) {
+    launches.push_back(launch);
+    auto it = launch_fingerprints.find(launch);
+    if (host_changed || it == launch_fingerprints.end() ||
+        it->second != getFingerprint(launch, false))
+      changed_launches.insert(launch);
+  });
+
+  // Channel ops are paired across launches by symbol, so a launch sharing a
+  // channel with a changed launch changes too
+  llvm::StringSet<> changed_channels;
+  for (auto launch : changed_launches)
+    launch->walk([&](air::ChannelInterface op) {
+      changed_channels.insert(op.getChanName());
+    });
+  if (!changed_channels.empty())
+    for (auto launch : launches)
+      launch->walk([&](air::ChannelInterface op) {
+        if (changed_channels.count(op.getChanName()))
+          changed_launches.insert(launch);
+      });
+
+  bool reparsed = !host_changed;
+  if (reparsed) {
+    dep_ctx.channel_uses = std::make_shared<ChannelSymbolUses>(
+        toplevel, /*enclosingDeclarations=*/true);
+    for (auto launch : launches)
+      if (changed_launches.count(launch))
+        reparsed &= canonicalizer.reparseLaunchGraph(
+            launch, hostGraph, dep_ctx, sim_granularity, fold_cores);
+  }
+  if (!reparsed) {
+    for (auto launch : launches)
+      changed_launches.insert(launch);
+    hostGraph = dependencyGraph(toplevel, true);
+    dep_ctx = dependencyContext();
+    canonicalizer.parseCommandGraphs(toplevel, hostGraph, dep_ctx,
+                                     sim_granularity, false, "", fold_cores);
   }
 
-}; // AIRRunner_impl
+  // Outside of the changed launches, ops are the ones counted before. Counts
+  // of erased ops are dropped along with the old counts.
+  std::map<Operation *, CostModel::OpCountMap> counts;
+  if (reparsed) {
+    toplevel.walk<WalkOrder::PreOrder>([&](Operation *op) {
+      if (changed_launches.count(op))
+        return WalkResult::skip();
+      if (isa<air::ExecuteOp>(op)) {
+        auto child_op = &*(op->getRegions().front().getOps().begin());
+        auto it = op_counts.find(child_op);
+        if (it != op_counts.end())
+          counts[child_op] = std::move(it->second);
+      }
+      return WalkResult::advance();
+    });
+    for (auto launch : changed_launches)
+      countExecuteLinalgOps(launch, counts);
+  } else {
+    countExecuteLinalgOps(toplevel, counts);
+  }
+  op_counts = std::move(counts);
+
+  // Renew the versions of the changed launches, and hash the ops of every
+  // launch as parsed, i.e. with their ids
+  std::map<Operation *, uint64_t> versions;
+  launch_fingerprints.clear();
+  for (auto launch : launches) {
+    auto it = launch_versions.find(launch);
+    if (it != launch_versions.end() && !changed_launches.count(launch))
+      versions[launch] = it->second;
+    else
+      versions[launch] = ++launch_version_counter;
+    launch_fingerprints[launch] = getFingerprint(launch, false);
+  }
+  launch_versions = std::move(versions);
+  host_fingerprint = getFingerprint(toplevel, true);
+}
+
+void countExecuteLinalgOps(
+    Operation *root,
+    std::map<Operation *, CostModel::OpCountMap> &op_counts) {
+  // Collect the ops first, since counting may build IR next to them
+  std::vector<Operation *> linalg_ops;
+  root->walk([&](air::ExecuteOp execute) {
+    auto child_op = &*(execute->getRegions().front().getOps().begin());
+    if (isa<linalg::LinalgOp>(child_op))
+      linalg_ops.push_back(child_op);
+  });
+  for (auto op : linalg_ops)
+    op_counts[op] = CostModel().getOpCounts(op);
+}
 
 AIRRunner::AIRRunner(llvm::raw_ostream &trace_stream,
                      llvm::json::Value &json_model, std::string sim_granularity,
-                     bool verbose) {
-  impl = std::make_unique<AIRRunner_impl>(trace_stream, json_model,
-                                          sim_granularity, verbose);
+                     bool verbose, bool full_simulation,
+                     bool parallel_segments, std::string trace_format,
+                     std::string trace_level, bool fold_cores) {
+  impl = std::make_unique<AIRRunner_impl>(
+      trace_stream, json_model, sim_granularity, verbose, full_simulation,
+      parallel_segments, trace_format, trace_level, fold_cores);
   if (verbose) {
     llvm::DebugFlag = true;
     llvm::setCurrentDebugType(DEBUG_TYPE);
@@ -786,6 +2028,137 @@ void AIRRunner::scheduleFunction(func::FuncOp &toplevel) {
   impl->scheduleFunction(toplevel);
 }
 
+void AIRRunner::scheduleFunction(AIRRunnerProgram &program) {
+  impl->scheduleFunction(program);
+}
+
+const AIRRunnerResults &AIRRunner::getResults() { return impl->getResults(); }
+
+void writeRunnerReport(llvm::raw_ostream &os, const AIRRunnerResults &results) {
+  llvm::json::Array resources;
+  for (auto &r : results.resources) {
+    double busy =
+        results.cycles ? (double)r.busy_cycles / results.cycles : 0.0;
+    resources.push_back(llvm::json::Object{
+        {"name", r.name},
+        {"kind", r.kind},
+        {"busy_cycles", (int64_t)r.busy_cycles},
+        {"busy_fraction", busy},
+        {"idle_fraction", 1.0 - busy}});
+  }
+  llvm::json::Array channels;
+  for (auto &c : results.channels)
+    channels.push_back(llvm::json::Object{{"name", c.name},
+                                          {"ops", (int64_t)c.ops},
+                                          {"stall_cycles",
+                                           (int64_t)c.stall_cycles}});
+  llvm::json::Array channel_occupancy;
+  for (auto &c : results.channel_occupancy) {
+    llvm::json::Array cycles;
+    for (auto &level : c.cycles)
+      cycles.push_back(
+          llvm::json::Array{(int64_t)level.first, (int64_t)level.second});
+    channel_occupancy.push_back(
+        llvm::json::Object{{"name", c.name},
+                           {"depth", (int64_t)c.depth},
+                           {"peak", (int64_t)c.peak},
+                           {"cycles", std::move(cycles)}});
+  }
+  llvm::json::Array transfers;
+  for (auto &t : results.transfers)
+    transfers.push_back(llvm::json::Object{
+        {"src", t.src}, {"dst", t.dst}, {"bytes", t.bytes}});
+  llvm::json::Array memories;
+  for (auto &m : results.memories) {
+    llvm::json::Array timeline;
+    for (auto &entry : m.timeline)
+      timeline.push_back(
+          llvm::json::Array{(int64_t)entry.first, entry.second});
+    llvm::json::Array repeats;
+    for (auto &r : m.repeats)
+      repeats.push_back(llvm::json::Object{{"begin", (int64_t)r.begin},
+                                           {"end", (int64_t)r.end},
+                                           {"period", (int64_t)r.period},
+                                           {"count", (int64_t)r.count}});
+    memories.push_back(llvm::json::Object{
+        {"name", m.name},
+        {"memory_space", m.memory_space},
+        {"capacity_bytes", m.capacity_bytes},
+        {"peak_bytes", m.peak_bytes},
+        {"peak_fraction",
+         m.capacity_bytes ? m.peak_bytes / m.capacity_bytes : 0.0},
+        {"timeline", std::move(timeline)},
+        {"repeats", std::move(repeats)}});
+  }
+  llvm::json::Array allocation_stalls;
+  for (auto &a : results.allocation_stalls)
+    allocation_stalls.push_back(
+        llvm::json::Object{{"memory_space", a.memory_space},
+                           {"allocs", (int64_t)a.allocs},
+                           {"stall_cycles", (int64_t)a.stall_cycles}});
+  llvm::json::Array spans;
+  for (auto &s : results.spans)
+    spans.push_back(llvm::json::Object{{"name", s.name},
+                                       {"kind", s.kind},
+                                       {"id", s.id},
+                                       {"instances", (int64_t)s.instances},
+                                       {"start", (int64_t)s.start},
+                                       {"end", (int64_t)s.end}});
+  llvm::json::Array op_cycles;
+  for (auto &op : results.ops)
+    op_cycles.push_back(
+        llvm::json::Object{{"name", op.name},
+                           {"instances", (int64_t)op.instances},
+                           {"cycles", (int64_t)op.cycles}});
+  llvm::json::Array critical_paths;
+  for (auto &path : results.critical_paths) {
+    llvm::json::Array ops;
+    for (auto &op : path.ops)
+      ops.push_back(llvm::json::Object{{"name", op.name},
+                                       {"runner", op.runner},
+                                       {"start", (int64_t)op.start},
+                                       {"end", (int64_t)op.end}});
+    critical_paths.push_back(
+        llvm::json::Object{{"launch", path.launch},
+                           {"cycles", (int64_t)path.cycles},
+                           {"ops", std::move(ops)}});
+  }
+  llvm::json::Array launch_iterations;
+  for (auto &l : results.simulation.launches)
+    launch_iterations.push_back(llvm::json::Object{
+        {"name", l.name},
+        {"id", l.id},
+        {"iterations", (int64_t)l.iterations},
+        {"simulated_iterations", (int64_t)l.simulated_iterations},
+        {"fast_forwarded_iterations", (int64_t)l.fast_forwarded_iterations},
+        {"replayed", l.replayed},
+        {"period_cycles", (int64_t)l.period_cycles}});
+  llvm::json::Object report{
+      {"cycles", (int64_t)results.cycles},
+      {"latency_us", results.latency_us},
+      {"du_utilization", results.du_utilization},
+      {"tile_utilization", results.tile_utilization},
+      {"spans", std::move(spans)},
+      {"resources", std::move(resources)},
+      {"channels", std::move(channels)},
+      {"channel_occupancy", std::move(channel_occupancy)},
+      {"data_movement", std::move(transfers)},
+      {"memories", std::move(memories)},
+      {"allocation_stalls", std::move(allocation_stalls)},
+      {"ops", std::move(op_cycles)},
+      {"critical_paths", std::move(critical_paths)},
+      {"simulation",
+       llvm::json::Object{
+           {"compute_cost_hits",
+            (int64_t)results.simulation.compute_cost_hits},
+           {"compute_cost_misses",
+            (int64_t)results.simulation.compute_cost_misses},
+           {"events", (int64_t)results.simulation.events},
+           {"vertex_visits", (int64_t)results.simulation.vertex_visits},
+           {"launches", std::move(launch_iterations)}}}};
+  os << llvm::formatv("{0:2}", llvm::json::Value(std::move(report))) << "\n";
+}
+
 //===----------------------------------------------------------------------===//
 // Runner util. functions
 //===----------------------------------------------------------------------===//
@@ -826,11 +2199,5 @@ unsigned lookUpMemorySpaceIntFromString(std::string memory_space) {
   return output;
 }
 
-template <typename T> void push_back_if_unique(std::vector<T> &vec, T entry) {
-  if (std::find(vec.begin(), vec.end(), entry) == vec.end()) {
-    vec.push_back(entry);
-  }
-}
-
 } // namespace air
 } // namespace xilinx
\ No newline at end of file
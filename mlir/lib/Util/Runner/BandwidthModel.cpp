@@ -0,0 +1,118 @@
+//===- BandwidthModel.cpp ---------------------------------------*- C++ -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef AIR_UTIL_RUNNER_BANDWIDTH_MODEL
+#define AIR_UTIL_RUNNER_BANDWIDTH_MODEL
+
+namespace xilinx {
+namespace air {
+
+// Fluid-flow model of data movement contending for the device's ports.
+// Transfers between the same pair of memory spaces through the same port, or
+// issued by the same du, tile or device, share the data rate of one port of
+// that interface equally. Transfers through different ports do not slow each
+// other down. Whenever a transfer starts or finishes, the bytes moved so far
+// by the others on its link are accounted for, and their end times are
+// recomputed from the new share.
+class bandwidthModel {
+
+public:
+  void reset() {
+    links.clear();
+    flow_links.clear();
+  }
+
+  // Start a transfer of `bytes` from `src` to `dst` through `res`, the port
+  // or the du, tile or device carrying it. Sets the end time of the transfer's
+  // node, and updates those of the other transfers sharing the link.
+  void startFlow(device &d, resource *res, unsigned src, unsigned dst,
+                 double bytes, dependencyNodeEntry *node, runnerNode *runner,
+                 uint64_t time) {
+    auto it = links.find({res, src, dst});
+    if (it == links.end()) {
+      link l;
+      l.capacity = d.getInterfaceDataRate(src, dst) / d.clock;
+      it = links.insert({{res, src, dst}, l}).first;
+    }
+    auto &l = it->second;
+    advance(l, time);
+    l.flows.push_back({node, runner, bytes});
+    flow_links[node] = &l;
+    updateEndTimes(l, time);
+  }
+
+  // Finish the transfer of a node, if it is one, releasing its share of the
+  // link to the others
+  void finishFlow(dependencyNodeEntry *node, uint64_t time) {
+    auto it = flow_links.find(node);
+    if (it == flow_links.end())
+      return;
+    auto &l = *it->second;
+    flow_links.erase(it);
+    advance(l, time);
+    l.flows.erase(std::remove_if(l.flows.begin(), l.flows.end(),
+                                 [&](flow &f) { return f.node == node; }),
+                  l.flows.end());
+    updateEndTimes(l, time);
+  }
+
+private:
+  struct flow {
+    dependencyNodeEntry *node;
+    runnerNode *runner;
+    double remaining_bytes;
+  };
+
+  struct link {
+    // Data rate in bytes per cycle
+    double capacity = 0;
+    uint64_t last_update = 0;
+    std::vector<flow> flows;
+  };
+
+  // Keys: resource carrying the transfers, and source and destination memory
+  // spaces
+  std::map<std::tuple<resource *, unsigned, unsigned>, link> links;
+  std::unordered_map<dependencyNodeEntry *, link *> flow_links;
+
+  double getFlowRate(link &l) {
+    return l.capacity / l.flows.size();
+  }
+
+  // Deduct the bytes moved since the last update from the link's transfers
+  void advance(link &l, uint64_t time) {
+    if (!l.flows.empty()) {
+      double moved = getFlowRate(l) * (time - l.last_update);
+      for (auto &f : l.flows)
+        f.remaining_bytes = std::max(0.0, f.remaining_bytes - moved);
+    }
+    l.last_update = time;
+  }
+
+  // Reschedule the completion of the link's transfers at the current rate
+  void updateEndTimes(link &l, uint64_t time) {
+    if (l.flows.empty())
+      return;
+    double rate = getFlowRate(l);
+    if (rate <= 0)
+      return;
+    for (auto &f : l.flows) {
+      // Tolerate rounding errors in the bytes left
+      double cycles = std::max(0.0, std::ceil(f.remaining_bytes / rate - 1e-6));
+      uint64_t end_time = time + (uint64_t)cycles;
+      if (end_time != f.node->end_time) {
+        f.node->end_time = end_time;
+        f.runner->pushCompletionEvent(end_time);
+      }
+    }
+  }
+}; // bandwidthModel
+
+} // namespace air
+} // namespace xilinx
+
+#endif // AIR_UTIL_RUNNER_BANDWIDTH_MODEL
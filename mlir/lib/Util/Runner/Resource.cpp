@@ -119,6 +119,12 @@ public:
   int ops_per_core_per_cycle;
   // Key: datatype name; mapped: pair <efficiency, ops_per_core_per_cycle>
   std::map<std::string, std::pair<double, int>> datatypes;
+  // Key: datatype name; mapped: ops per core per cycle of the opcodes whose
+  // throughput differs from the datatype's ops_per_core_per_cycle
+  std::map<std::string, std::map<std::string, double>> opcode_throughputs;
+  // Key: datatype name; mapped: pair <L1 bytes loaded, L1 bytes stored> per
+  // core per cycle. A datatype without an entry is not memory bound.
+  std::map<std::string, std::pair<double, double>> l1_bandwidths;
 
   void push_to_datatypes(std::string datatype_name, std::optional<double> eff,
                          std::optional<int> vectorSize) {
@@ -130,6 +136,21 @@ public:
           std::make_pair(datatype_name, std::make_pair(0, 0)));
   }
 
+  void set_opcode_throughputs(std::string datatype_name,
+                              llvm::json::Object *opcodesObject) {
+    if (!opcodesObject)
+      return;
+    for (auto it = opcodesObject->begin(), ie = opcodesObject->end(); it != ie;
+         ++it) {
+      auto throughput = it->second.getAsNumber();
+      this->resource_assertion(throughput && *throughput > 0,
+                               "opcode " + it->first.str() +
+                                   " of datatype " + datatype_name +
+                                   " has no positive throughput");
+      this->opcode_throughputs[datatype_name][it->first.str()] = *throughput;
+    }
+  }
+
   kernel() {}
 
   kernel(resource *parent, llvm::json::Object *kernelObject) {
@@ -161,6 +182,15 @@ public:
                                        datatype_name +
                                        ", supported: ops_per_core_per_cycle, "
                                        "macs_per_core_per_cycle");
+        this->set_opcode_throughputs(datatype_name,
+                                     datatypeObject->getObject("opcodes"));
+        auto load_bytes = datatypeObject->getNumber("l1_load_bytes_per_cycle");
+        auto store_bytes =
+            datatypeObject->getNumber("l1_store_bytes_per_cycle");
+        if (load_bytes || store_bytes)
+          this->l1_bandwidths.insert(std::make_pair(
+              datatype_name,
+              std::make_pair(load_bytes.value_or(0), store_bytes.value_or(0))));
       }
       this->reset_reservation();
     }
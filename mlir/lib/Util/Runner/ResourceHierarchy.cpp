@@ -226,6 +226,13 @@ private:
 
 }; // du
 
+// A du, tile, port or memory whose usage is tracked over a simulation
+struct trackedResource {
+  std::string name;
+  std::string kind;
+  resource *res;
+};
+
 // Device hierarchy node entry.
 class device : public resourceHierarchy {
 
@@ -397,6 +404,93 @@ public:
       return 0;
   }
 
+  // List the device's L2 and L1 memories, each named by its path in the
+  // device, after `prefix`
+  std::vector<trackedResource>
+  getTrackedMemories(const std::string &prefix = "") {
+    std::vector<trackedResource> tracked;
+    for (unsigned i = 0; i < this->dus.size(); i++) {
+      auto d = this->dus[i];
+      std::string du_name = prefix + "du[" + std::to_string(i) + "]";
+      if (d->du_mem)
+        tracked.push_back({du_name + "/L2", "memory", d->du_mem});
+      for (unsigned j = 0; j < d->tiles.size(); j++) {
+        auto t = d->tiles[j];
+        if (t->tile_mem)
+          tracked.push_back(
+              {du_name + "/tile[" + std::to_string(j) + "]/L1", "memory",
+               t->tile_mem});
+      }
+    }
+    return tracked;
+  }
+
+  // Data rate of a single port of the interface between two memory spaces, or
+  // 0 if the device has no such interface. The interfaces are only read once
+  // the device is built, so this may be called from concurrent runners.
+  double getInterfaceDataRate(unsigned src, unsigned dst) const {
+    auto it = this->interfaces.find({src, dst});
+    if (it == this->interfaces.end())
+      return 0;
+    return it->second->data_rate;
+  }
+
+  // Snapshot of resource reservations and memory usage across the device.
+  // Two points in simulation with equal snapshots see the same resource state.
+  std::vector<double> getOccupancySnapshot() {
+    std::vector<double> snapshot;
+    auto pushPorts = [&](std::map<std::string, std::vector<port *>> &ports) {
+      for (auto &entry : ports)
+        for (auto p : entry.second)
+          snapshot.push_back(p->isReserved);
+    };
+    snapshot.push_back(this->isReserved);
+    pushPorts(this->ports);
+    for (auto &entry : this->interfaces)
+      snapshot.push_back(entry.second->isReserved);
+    for (auto d : this->dus) {
+      snapshot.push_back(d->isReserved);
+      if (d->du_mem)
+        snapshot.push_back(d->du_mem->bytes_used);
+      pushPorts(d->ports);
+      for (auto t : d->tiles) {
+        snapshot.push_back(t->isReserved);
+        if (t->tile_mem)
+          snapshot.push_back(t->tile_mem->bytes_used);
+        pushPorts(t->ports);
+      }
+    }
+    return snapshot;
+  }
+
+  // List the device's dus, tiles and ports, each named by its path in the
+  // device, after `prefix`. The device's own ports are named after `prefix`,
+  // or "device/" without one.
+  std::vector<trackedResource>
+  getTrackedResources(const std::string &prefix = "") {
+    std::vector<trackedResource> tracked;
+    auto pushPorts = [&](const std::string &path,
+                         std::map<std::string, std::vector<port *>> &ports) {
+      for (auto &entry : ports)
+        for (auto p : entry.second)
+          tracked.push_back({path + p->name, "port", p});
+    };
+    pushPorts(prefix.empty() ? "device/" : prefix, this->ports);
+    for (unsigned i = 0; i < this->dus.size(); i++) {
+      auto d = this->dus[i];
+      std::string du_name = prefix + "du[" + std::to_string(i) + "]";
+      tracked.push_back({du_name, "du", d});
+      pushPorts(du_name + "/", d->ports);
+      for (unsigned j = 0; j < d->tiles.size(); j++) {
+        auto t = d->tiles[j];
+        std::string tile_name = du_name + "/tile[" + std::to_string(j) + "]";
+        tracked.push_back({tile_name, "tile", t});
+        pushPorts(tile_name + "/", t->ports);
+      }
+    }
+    return tracked;
+  }
+
   device(std::string name = "", resource *parent = nullptr,
          unsigned clock = 0) {
     this->set_name(name);
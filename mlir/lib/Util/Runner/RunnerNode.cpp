@@ -11,6 +11,110 @@
 namespace xilinx {
 namespace air {
 
+class runnerNode;
+
+// A completion event on the simulation timeline. First element is the time
+// stamp at which an event on the wavefront finishes, and second element is
+// the runner node whose wavefront holds the event.
+typedef std::pair<uint64_t, runnerNode *> completionEvent;
+
+// Order completion events by time stamp only, so that the earliest event sits
+// at the top of the queue.
+struct completionEventCompare {
+  bool operator()(const completionEvent &a, const completionEvent &b) const {
+    return a.first > b.first;
+  }
+};
+
+typedef std::priority_queue<completionEvent, std::vector<completionEvent>,
+                            completionEventCompare>
+    completionEventQueue;
+
+// Trace thread ids are laid out in pages of this many ids per core, so that
+// the threads of each core sit together in the trace. Threads beyond the
+// first page of a core go to the next page after those of all cores.
+constexpr unsigned trace_threads_per_core = 10;
+
+// A set of vertices which remembers the order they were inserted in. Vertices
+// are indexed by their descriptor, so that lookups, insertions and erasures
+// take constant time.
+class vertexSet {
+
+public:
+  bool contains(Graph::vertex_descriptor v) const {
+    return v < index.size() && index[v] != npos;
+  }
+
+  // Insert a vertex at the back, unless it is already in the set
+  bool insert(Graph::vertex_descriptor v) {
+    if (contains(v))
+      return false;
+    if (v >= index.size())
+      index.resize(v + 1, npos);
+    index[v] = order.size();
+    order.push_back(v);
+    num_vertices++;
+    return true;
+  }
+
+  bool erase(Graph::vertex_descriptor v) {
+    if (!contains(v))
+      return false;
+    order[index[v]] = Graph::null_vertex();
+    index[v] = npos;
+    num_vertices--;
+    // Drop erased slots once they make up most of the order
+    if (2 * num_vertices < order.size())
+      compact();
+    return true;
+  }
+
+  void clear() {
+    for (auto v : order)
+      if (v != Graph::null_vertex())
+        index[v] = npos;
+    order.clear();
+    num_vertices = 0;
+  }
+
+  size_t size() const { return num_vertices; }
+  bool empty() const { return !num_vertices; }
+
+  // Vertices in the order they were inserted
+  std::vector<Graph::vertex_descriptor> vector() const {
+    std::vector<Graph::vertex_descriptor> vertices;
+    vertices.reserve(num_vertices);
+    for (auto v : order)
+      if (v != Graph::null_vertex())
+        vertices.push_back(v);
+    return vertices;
+  }
+
+private:
+  static constexpr size_t npos = ~(size_t)0;
+  // Inserted vertices, with erased ones replaced by null vertices
+  std::vector<Graph::vertex_descriptor> order;
+  // Position of each vertex in `order`, or npos
+  std::vector<size_t> index;
+  size_t num_vertices = 0;
+
+  void compact() {
+    order = vector();
+    for (size_t i = 0; i < order.size(); i++)
+      index[order[i]] = i;
+  }
+}; // vertexSet
+
+// An event on a runner node's wavefront
+struct wavefrontEntry {
+  Graph::vertex_descriptor v;
+  // Resources consumed by the event
+  std::vector<resource *> reserved_resources;
+  // Trace thread slot held by the event, or 0 for the runner node's start
+  // signal, which is not traced
+  unsigned slot;
+};
+
 class runnerNode {
 
 public:
@@ -20,37 +124,61 @@ public:
   dependencyGraph *ctrl_g;
   // Runner node hierarchy type
   std::string runner_node_type;
-  // Each entry is an std::tuple. First element is vertex, second element is
-  // vector of resoruces consumed, and third element is thread id.
-  // TODO: Replace thread id with id which better reflects resource slots.
-  std::vector<
-      std::tuple<Graph::vertex_descriptor, std::vector<resource *>, unsigned>>
-      wavefront;
-  // A vector of vertices processed by the current runner node
-  std::vector<Graph::vertex_descriptor> processed_vertices;
-  // An incomplete vector of vertices as candidates to wavefront
-  std::vector<Graph::vertex_descriptor> latent_wavefront_candidates;
+  // Events started and not yet executed, in the order they started
+  std::vector<wavefrontEntry> wavefront;
+  // Vertices on the wavefront
+  std::unordered_set<Graph::vertex_descriptor> wavefront_vertices;
+  // Trace thread slots held by the wavefront. Bit i is set if slot i + 1 is
+  // held.
+  llvm::BitVector busy_thread_slots;
+  // Vertices processed by the current runner node
+  vertexSet processed_vertices;
+  // An incomplete set of vertices as candidates to wavefront
+  vertexSet latent_wavefront_candidates;
   // Sub runner nodes to the current runner node
   std::deque<runnerNode> sub_runner_nodes;
   // Resource hierarchies which are allocated to this runner node
   std::vector<resourceHierarchy *> resource_hiers;
+  // Min-heap of completion events, shared by all runner nodes under a launch.
+  // Only the launch runner node holds a valid pointer, except for the root of
+  // a sub-runner subtree being simulated in parallel, which holds its own.
+  completionEventQueue *completion_events = nullptr;
+  // Number of completion events which are due, but have not yet been executed
+  // from this runner node's wavefront.
+  unsigned completions_due = 0;
+  // Guards channel bookkeeping held by the launch runner node, if sub-runner
+  // nodes are simulated in parallel. Only the launch runner node holds it.
+  std::recursive_mutex *channel_state_mutex = nullptr;
+  // Depth of channels without a buffer_depth attribute. Only the launch runner
+  // node holds it.
+  unsigned default_channel_buffer_depth = 1;
 
   // Get a pool of vertices as candidates to be pushed to wavefront. This avoids
   // having to check every vertex in the graphs for dependency and resource
-  // fulfillment.
-  std::vector<Graph::vertex_descriptor> getCandidateVerticesForWavefront() {
+  // fulfillment. `visits` counts the vertices and edges looked at.
+  std::vector<Graph::vertex_descriptor>
+  getCandidateVerticesForWavefront(uint64_t &visits) {
     // Get candidate vertices to be pushed to wavefront
     std::vector<Graph::vertex_descriptor> next_vertex_set_candidates;
+    auto addCandidate = [&](Graph::vertex_descriptor v) {
+      if (v >= this->candidate_mask.size())
+        this->candidate_mask.resize(v + 1);
+      if (this->candidate_mask.test(v))
+        return;
+      this->candidate_mask.set(v);
+      next_vertex_set_candidates.push_back(v);
+    };
     // Get all adj. vertices to the procssed vertices as candidates
-    this->findAdjacentVerticesToProcessed(next_vertex_set_candidates);
-    for (auto v : this->latent_wavefront_candidates) {
-      push_back_if_unique<Graph::vertex_descriptor>(next_vertex_set_candidates,
-                                                    v);
-    }
+    this->findAdjacentVerticesToProcessed(addCandidate, visits);
+    visits += this->latent_wavefront_candidates.size();
+    for (auto v : this->latent_wavefront_candidates.vector())
+      addCandidate(v);
+    for (auto v : next_vertex_set_candidates)
+      this->candidate_mask.reset(v);
     // Remove candidate vertices already on wavefront
-    this->removeRepeatedVertices(
-        next_vertex_set_candidates,
-        this->getVectorOfFirstFromVectorOfTuples(this->wavefront));
+    llvm::erase_if(next_vertex_set_candidates, [&](Graph::vertex_descriptor v) {
+      return this->wavefront_vertices.count(v);
+    });
     // Remove candidate vertices which are filtered out by an affine.if, if
     // showing cores
     if (this->sim_granularity == "core") {
@@ -60,43 +188,142 @@ public:
     return next_vertex_set_candidates;
   }
 
+  void markVertexProcessed(Graph::vertex_descriptor v) {
+    if (this->processed_vertices.insert(v))
+      this->processed_frontier.push_back(v);
+  }
+
+  void unmarkVertexProcessed(Graph::vertex_descriptor v) {
+    if (this->processed_vertices.erase(v))
+      this->processed_frontier_stale = true;
+  }
+
+  void clearProcessedVertices() {
+    this->processed_vertices.clear();
+    this->processed_frontier.clear();
+    this->processed_frontier_stale = false;
+  }
+
   // Push runner "start" signal into wavefront
   void pushStartToWavefront(Graph::vertex_descriptor v) {
     std::vector<resource *> reserved_resources;
     // Allocate resources to this runner
     this->consumeResourceHiersWhenRunnerStarts(reserved_resources);
-    auto entry = std::make_tuple(v, reserved_resources, (unsigned)1);
-    for (auto i : this->wavefront) {
-      this->runner_assertion(std::get<2>(i) != std::get<2>(entry),
-                             "queried thread is busy");
-    }
-    this->wavefront.push_back(entry);
-  }
-
-  // Push an entry to wavefront
-  void pushToWavefront(Graph::vertex_descriptor v, unsigned core_id = 0) {
+    this->wavefront.push_back({v, reserved_resources, 0});
+    this->wavefront_vertices.insert(v);
+    this->pushCompletionEvent(this->ctrl_g->g[v].end_time);
+  }
+
+  // Schedule a completion event for an event on this runner node's wavefront
+  void pushCompletionEvent(uint64_t end_time) {
+    if (auto events = this->getCompletionEventQueue())
+      events->push(std::make_pair(end_time, this));
+  }
+
+  // Get the completion event queue of the closest ancestor holding one
+  completionEventQueue *getCompletionEventQueue() {
+    for (auto node = this; node; node = node->parent)
+      if (node->completion_events)
+        return node->completion_events;
+    return nullptr;
+  }
+
+  // Lock the channel bookkeeping held by the launch runner node, if sub-runner
+  // nodes are simulated in parallel
+  std::unique_lock<std::recursive_mutex> lockChannelState() {
+    auto launch_runner = this->getParentLaunchRunner();
+    if (launch_runner && launch_runner->channel_state_mutex)
+      return std::unique_lock<std::recursive_mutex>(
+          *launch_runner->channel_state_mutex);
+    return std::unique_lock<std::recursive_mutex>();
+  }
+
+  // Get the declaration of a channel op's symbol, from the channel index of
+  // the dependency context if there is one
+  air::ChannelOp getChannelDeclaration(air::ChannelInterface op) {
+    return getChannelDeclarationThroughSymbol(
+        op, this->dep_ctx ? this->dep_ctx->channel_uses.get() : nullptr);
+  }
+
+  // Get the number of transfers that the FIFO of a channel may hold, counting
+  // the transfer in progress
+  unsigned getChannelBufferDepth(air::ChannelInterface op) {
+    auto depth = this->getChannelDeclaration(op).getBufferDepth();
+    if (!depth)
+      return this->getParentLaunchRunner()->default_channel_buffer_depth;
+    this->runner_assertion(depth > 0, "channel buffer depth must be positive");
+    return depth;
+  }
+
+  // Get the number of transfers held by the FIFO of a channel: those buffered
+  // for their gets, and the one whose puts are in progress, if any
+  unsigned getChannelOccupancy(std::string chan_name) {
+    auto launch_runner = this->getParentLaunchRunner();
+    auto lock = this->lockChannelState();
+    unsigned occupancy = 0;
+    auto fifo = launch_runner->channel_fifos.find(chan_name);
+    if (fifo != launch_runner->channel_fifos.end())
+      occupancy += fifo->second.size();
+    if (launch_runner->getAlreadyDispatchedForDynamicDispatch(chan_name, "put"))
+      occupancy++;
+    return occupancy;
+  }
+
+  // Push an entry to wavefront, holding the lowest free trace thread slot
+  void pushToWavefront(Graph::vertex_descriptor v) {
     std::vector<resource *> reserved_resources;
     // Allocate resources to this event
     this->consumeOrReleaseResources(reserved_resources, v);
-    // Acquire available thread id for current op
-    unsigned max_num_threads_per_core =
-        10; // Hardcoded maximum number of threads per core
-    unsigned offset = core_id * max_num_threads_per_core;
-    unsigned tid = 0;
-    for (unsigned i = offset + 1; i < offset + this->wavefront.size() + 2;
-         i++) {
-      bool tid_i_unavailable = false;
-      for (auto j : this->wavefront) {
-        if (std::get<2>(j) == i) {
-          tid_i_unavailable = true;
-        }
-      }
-      if (!tid_i_unavailable) {
-        tid = i;
-        break;
-      }
-    }
-    this->wavefront.push_back(std::make_tuple(v, reserved_resources, tid));
+    int free_slot = this->busy_thread_slots.find_first_unset();
+    if (free_slot == -1) {
+      free_slot = this->busy_thread_slots.size();
+      this->busy_thread_slots.push_back(false);
+    }
+    this->busy_thread_slots.set(free_slot);
+    this->wavefront.push_back({v, reserved_resources, (unsigned)free_slot + 1});
+    this->wavefront_vertices.insert(v);
+  }
+
+  // Execute the events on the wavefront for which `done` holds, in wavefront
+  // order, and remove them from the wavefront
+  void popFromWavefront(llvm::function_ref<bool(wavefrontEntry &)> done,
+                        llvm::function_ref<void(wavefrontEntry &)> execute) {
+    unsigned kept = 0;
+    for (unsigned i = 0; i < this->wavefront.size(); i++) {
+      auto &entry = this->wavefront[i];
+      if (!done(entry)) {
+        if (kept != i)
+          this->wavefront[kept] = std::move(entry);
+        kept++;
+        continue;
+      }
+      execute(entry);
+      this->wavefront_vertices.erase(entry.v);
+      if (entry.slot)
+        this->busy_thread_slots.reset(entry.slot - 1);
+    }
+    this->wavefront.resize(kept);
+  }
+
+  // Get the trace thread id of a slot on the core at `position` of this runner
+  // node's herd
+  int64_t getTraceThreadId(unsigned slot, std::vector<unsigned> &position) {
+    if (!this->num_trace_cores) {
+      this->num_trace_cores = 1;
+      auto herd = dyn_cast<air::HerdOp>(this->ctrl_g->hierarchyOp);
+      if (herd && !position.empty())
+        for (auto size :
+             convertVecOfConstIndexToVecOfUInt(herd.getSizeOperands()))
+          this->num_trace_cores *= size;
+    }
+    unsigned core_id = this->canonicalizer.getIteratorFromPosition(
+        position, this->ctrl_g->hierarchyOp);
+    // Slots are numbered from 1, and take ids 1 to trace_threads_per_core of
+    // their page
+    unsigned page = (slot - 1) / trace_threads_per_core;
+    return ((int64_t)page * this->num_trace_cores + core_id) *
+               trace_threads_per_core +
+           (slot - 1) % trace_threads_per_core + 1;
   }
 
   // Initialize sub runner nodes from launch graph tree
@@ -124,21 +351,11 @@ public:
     }
   }
 
-  // Get time stamps from wavefront
-  void getTimeStampsFromWavefront(std::vector<uint64_t> &next_times) {
-    for (auto it = this->wavefront.begin(); it != this->wavefront.end(); it++) {
-      auto command_node = this->ctrl_g->g[std::get<0>(*it)];
-      if (command_node.is_started() && (command_node.end_time)) {
-        next_times.push_back(command_node.end_time);
-      }
-    }
-  }
-
   // Execute an mlir op in runner node
   void executeOpImpls(Graph::vertex_descriptor it, uint64_t time) {
-    Graph G = this->ctrl_g->g;
-    auto node = G[it];
-    if (node.asyncEventType == "start") {
+    Graph &G = this->ctrl_g->g;
+    auto &node = G[it];
+    if (node.asyncEventType == dependencyEventType::Start) {
       this->executeOp(it);
     } else if (auto Op = dyn_cast<xilinx::air::HierarchyInterface>(node.op)) {
       for (auto sub_dependency_graph : node.nextDependencyGraphs) {
@@ -181,16 +398,15 @@ public:
       for (auto v : vertices) {
         this->resetVertex(v, G, time, push_to_latent_wavefront_candidates);
         // If v is a hierarchy op, then recursively clear the entire subgraph
-        if (G[v].asyncEventType == "hierarchy") {
+        if (G[v].asyncEventType == dependencyEventType::Hierarchy) {
           for (auto sub_c : G[v].nextDependencyGraphs) {
-            auto sub_g = sub_c->g;
             auto sub_runner = sub_c->runner_node;
             sub_runner->resetGraph(time);
           }
         }
         // Else if v is an scf.for op, then clear the cached trip count from
         // runner node
-        else if (G[v].asyncEventType == "for_loop") {
+        else if (G[v].asyncEventType == dependencyEventType::ForLoop) {
           // Clear for loop trip count from runner node's cache
           for (auto it = this->loop_trip_count.begin();
                it != this->loop_trip_count.end(); it++) {
@@ -218,7 +434,7 @@ public:
     auto inv_adj_set = boost::inv_adjacent_vertices(it, G);
     for (auto inv_adj_v = inv_adj_set.first; inv_adj_v != inv_adj_set.second;
          ++inv_adj_v) {
-      if (G[*inv_adj_v].asyncEventType == "for_loop") {
+      if (G[*inv_adj_v].asyncEventType == dependencyEventType::ForLoop) {
         int th = this->tokenCountThresholdForExecution(
             G[it].op); // Consume all iter_arg tokens
         this->runner_assertion(
@@ -234,8 +450,8 @@ public:
 
   // Check if all dependencies of an async op have been fulfilled
   bool checkAllDependenciesFulfillment(
-      std::vector<std::pair<dependencyNodeEntry, std::string>> dep_list,
-      dependencyNodeEntry node, uint64_t time, bool isBlocking) {
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> &dep_list,
+      dependencyNodeEntry &node, uint64_t time, bool isBlocking) {
     bool dep_fulfilled = true;
     if (isBlocking) {
       dep_fulfilled = true;
@@ -255,40 +471,27 @@ public:
     return dep_fulfilled;
   }
 
-  // Remove a vertex from a vector of vertices
-  void removeVertexFromVertices(std::vector<Graph::vertex_descriptor> &vector,
-                                Graph::vertex_descriptor a) {
-    if (vector.size()) {
-      for (auto it = vector.begin(); it != vector.end(); ++it) {
-        if (*it == a) {
-          vector.erase(it);
-          it--;
-        }
-      }
-    }
-  }
-
   void buildVertexDependencyList(
       Graph::vertex_descriptor v,
-      std::vector<std::pair<dependencyNodeEntry, std::string>> &dep_list) {
-    Graph G = this->ctrl_g->g;
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> &dep_list) {
+    Graph &G = this->ctrl_g->g;
     // If current vertex is ChannelGet, then add implicit ChannelPut vertex to
     // dep list
     if (air::ChannelGetOp channel_get = dyn_cast<air::ChannelGetOp>(G[v].op)) {
-      dep_list.push_back(std::make_pair(G[v], "sym"));
+      dep_list.push_back(std::make_pair(&G[v], "sym"));
     }
     auto inv_adj_set = boost::inv_adjacent_vertices(v, G);
     for (auto inv_adj_v = inv_adj_set.first; inv_adj_v != inv_adj_set.second;
          ++inv_adj_v) {
       // If dependent on a hierarchy op, then push its terminator into dep_list
       // instead
-      if (G[*inv_adj_v].asyncEventType == "hierarchy") {
+      if (G[*inv_adj_v].asyncEventType == dependencyEventType::Hierarchy) {
         for (auto sub_g : G[*inv_adj_v].nextDependencyGraphs) {
           auto terminator_v = sub_g->terminator_vertex;
           auto &terminator_node = sub_g->g[terminator_v];
-          dep_list.push_back(std::make_pair(terminator_node, "ssa"));
+          dep_list.push_back(std::make_pair(&terminator_node, "ssa"));
         }
-      } else if (G[*inv_adj_v].asyncEventType == "for_loop") {
+      } else if (G[*inv_adj_v].asyncEventType == dependencyEventType::ForLoop) {
         pushToDepListIfAffineIfHit(dep_list, G[*inv_adj_v],
                                    this->ctrl_g->position, "ssa_loop_yield");
       } else {
@@ -299,8 +502,9 @@ public:
   }
 
   // Try to reserve resources for an event
-  bool checkResourceFulfillmentForOpImpls(dependencyNodeEntry node) {
-    return checkResourceFulfillmentForOpImpls(node.op, node.asyncEventName);
+  bool checkResourceFulfillmentForOpImpls(dependencyNodeEntry &node) {
+    return checkResourceFulfillmentForOpImpls(node.op,
+                                              node.getAsyncEventName());
   }
   bool checkResourceFulfillmentForOpImpls(Operation *op,
                                           std::string name = "") {
@@ -351,7 +555,8 @@ public:
 
   ~runnerNode() {
     wavefront.clear();
-    processed_vertices.clear();
+    wavefront_vertices.clear();
+    clearProcessedVertices();
     loop_trip_count.clear();
     sub_runner_nodes.clear();
     channel_token_counts.clear();
@@ -365,6 +570,15 @@ private:
   xilinx::air::dependencyContext *dep_ctx;
   // Simulation granularity.
   std::string sim_granularity;
+  // Number of cores whose trace threads share a page, computed on first use
+  unsigned num_trace_cores = 0;
+  // Processed vertices which may have unprocessed adjacent vertices, in the
+  // order they were processed. It is rebuilt from processed_vertices when
+  // stale, i.e. once a vertex was unprocessed.
+  std::vector<Graph::vertex_descriptor> processed_frontier;
+  bool processed_frontier_stale = false;
+  // Scratch bits marking the vertices already gathered as wavefront candidates
+  llvm::BitVector candidate_mask;
   // Each entry is an std::tuple. First element is for op's id, second element
   // is the loop's async token id, and third element is trip counter.
   std::vector<std::tuple<unsigned, unsigned, unsigned>> loop_trip_count;
@@ -380,6 +594,10 @@ private:
   std::map<std::pair<std::string, std::string>,
            std::pair<unsigned, std::vector<resource *>>>
       channel_ops_in_progress;
+  // Transfers whose puts completed into the FIFO of their channel while its
+  // gets were still draining older transfers. Keys: channel name; mapped:
+  // number of put dispatches of each buffered transfer, oldest first.
+  std::map<std::string, std::deque<unsigned>> channel_fifos;
 
   // Get a pool of available resources
   void getDUsPool(std::vector<resource *> &resource_pool) {
@@ -457,8 +675,8 @@ private:
     double memory_pool = 0;
     for (auto res_hier : this->resource_hiers) {
       // Get L2 memories from dus
-      if (auto col = static_cast<du *>(res_hier)) {
-        auto col_mem = col->du_mem;
+      if (this->runner_node_type == "segment") {
+        auto col_mem = static_cast<du *>(res_hier)->du_mem;
         auto free_memory = col_mem->bytes - col_mem->bytes_used;
         // If returning free memories
         if (free_memory_only && free_memory > 0.0f) {
@@ -472,8 +690,8 @@ private:
         }
       }
       // Get L1 memories from tiles
-      else if (auto til = static_cast<tile *>(res_hier)) {
-        auto tile_mem = til->tile_mem;
+      else if (this->runner_node_type == "herd") {
+        auto tile_mem = static_cast<tile *>(res_hier)->tile_mem;
         auto free_memory = tile_mem->bytes - tile_mem->bytes_used;
         // If returning free memories
         if (free_memory_only && free_memory > 0.0f) {
@@ -528,8 +746,9 @@ private:
     double datawidth = 0;
     auto d = this->getDeviceHier();
     this->runner_assertion(d, "'device' resource not found");
-    if (auto bytes = d->datatypes[getElementTypeAsString(ty)]) {
-      datawidth = bytes;
+    auto datatype = d->datatypes.find(getElementTypeAsString(ty));
+    if (datatype != d->datatypes.end() && datatype->second) {
+      datawidth = datatype->second;
     } else {
       this->runner_assertion(false, "data type not found in JSON model");
     }
@@ -624,7 +843,7 @@ private:
                                  Graph::vertex_descriptor v) {
     Graph &G = this->ctrl_g->g;
     this->allocateEventToResourcesImpls(reserved_resources, G[v].op,
-                                        G[v].asyncEventName);
+                                        G[v].getAsyncEventName());
   }
 
   // Try to reserve resources for an event
@@ -693,7 +912,10 @@ private:
     unsigned remaining =
         launch_runner->getRemainingDispatchesForDynamicDispatch(putOp);
 
-    return std::min(remaining, (unsigned)src_resource_pool.size());
+    // Symmetric cores folded into one runner node dispatch together
+    unsigned dispatchable =
+        std::min(remaining, (unsigned)src_resource_pool.size());
+    return dispatchable < this->getFoldedCoreCount() ? 0 : dispatchable;
   }
   unsigned checkResourceFulfillmentForOp(air::ChannelGetOp getOp) {
 
@@ -710,7 +932,10 @@ private:
     unsigned remaining =
         launch_runner->getRemainingDispatchesForDynamicDispatch(getOp);
 
-    return std::min(remaining, (unsigned)dst_resource_pool.size());
+    // Symmetric cores folded into one runner node dispatch together
+    unsigned dispatchable =
+        std::min(remaining, (unsigned)dst_resource_pool.size());
+    return dispatchable < this->getFoldedCoreCount() ? 0 : dispatchable;
   }
 
   // Allocate event to resources
@@ -802,6 +1027,7 @@ private:
   }
   void allocateEventToResources(air::ChannelPutOp Op,
                                 std::vector<resource *> &reserved_resources) {
+    auto lock = this->lockChannelState();
     auto chan_interface = dyn_cast<air::ChannelInterface>(Op.getOperation());
     unsigned dispatched = 0;
 
@@ -836,6 +1062,7 @@ private:
   }
   void allocateEventToResources(air::ChannelGetOp Op,
                                 std::vector<resource *> &reserved_resources) {
+    auto lock = this->lockChannelState();
     auto chan_interface = dyn_cast<air::ChannelInterface>(Op.getOperation());
     unsigned dispatched = 0;
     // Check how many evnets need to be dispatched in this op
@@ -898,7 +1125,7 @@ private:
     // If simulating at per-core granularity, then one operation can at most be
     // dispatched once per core
     if (this->sim_granularity == "core" && Op->getParentOfType<air::HerdOp>()) {
-      dispatched = std::min(dispatched, (unsigned)1);
+      dispatched = std::min(dispatched, this->getFoldedCoreCount());
     }
 
     // Dispatch all events that can be dispatched
@@ -925,7 +1152,7 @@ private:
     auto chan_op = dyn_cast<air::ChannelInterface>(op);
     if (!chan_op)
       return 1;
-    auto chan_declr = getChannelDeclarationThroughSymbol(chan_op);
+    auto chan_declr = this->getChannelDeclaration(chan_op);
     if (chan_declr->hasAttr("broadcast_shape")) {
       unsigned bcast_size = 1;
       auto size =
@@ -946,6 +1173,7 @@ private:
   // event
   unsigned getAlreadyDispatchedForDynamicDispatch(std::string chan_name,
                                                   std::string put_or_get) {
+    auto lock = this->lockChannelState();
     unsigned already_dispatched = 0;
     std::pair<std::string, std::string> key =
         std::make_pair(chan_name, put_or_get);
@@ -959,6 +1187,16 @@ private:
     return already_dispatched;
   }
 
+  // Get the number of put dispatches of the transfer that the gets of a channel
+  // drain: the oldest buffered transfer, or else the one in progress
+  unsigned getDispatchesToDrain(std::string chan_name) {
+    auto lock = this->lockChannelState();
+    auto fifo = this->channel_fifos.find(chan_name);
+    if (fifo != this->channel_fifos.end() && !fifo->second.empty())
+      return fifo->second.front();
+    return this->getAlreadyDispatchedForDynamicDispatch(chan_name, "put");
+  }
+
   // Get the number of remaining dispatches in a dynamically dispatched event
   // (e.g., events in scf.parallel)
   unsigned getRemainingDispatchesForDynamicDispatch(air::ChannelPutOp putOp) {
@@ -974,6 +1212,15 @@ private:
     unsigned already_dispatched = this->getAlreadyDispatchedForDynamicDispatch(
         putOp.getChanName().str(), "put");
 
+    // Back-pressure: no put starts while the channel's FIFO is full
+    {
+      auto lock = this->lockChannelState();
+      auto fifo = this->channel_fifos.find(putOp.getChanName().str());
+      if (fifo != this->channel_fifos.end() &&
+          fifo->second.size() >= this->getChannelBufferDepth(putOp))
+        return 0;
+    }
+
     // Check how many remaining evnets need to be dispatched in this op
     unsigned remaining = total - already_dispatched;
     return remaining;
@@ -988,8 +1235,8 @@ private:
     // difference to put op
     unsigned get_dispatched = this->getAlreadyDispatchedForDynamicDispatch(
         getOp.getChanName().str(), "get");
-    unsigned put_dispatched = this->getAlreadyDispatchedForDynamicDispatch(
-        getOp.getChanName().str(), "put");
+    unsigned put_dispatched =
+        this->getDispatchesToDrain(getOp.getChanName().str());
 
     // Channel broadcast
     unsigned bcast_factor =
@@ -1014,9 +1261,9 @@ private:
                                " is busy");
     sub_runner_node->pushStartToWavefront(sub_start_v);
 
-    sub_runner_node->processed_vertices.clear();
+    sub_runner_node->clearProcessedVertices();
 
-    this->processed_vertices.push_back(it);
+    this->markVertexProcessed(it);
   }
 
   void executeOp(scf::YieldOp op, uint64_t time, scf::ForOp for_op,
@@ -1063,7 +1310,7 @@ private:
     }
 
     if (allAsyncTokensFulfilled) {
-      this->processed_vertices.push_back(it);
+      this->markVertexProcessed(it);
       trip_count_fulfilled = true;
     } else {
       // If trip count unfulfilled, then iterate.
@@ -1138,10 +1385,11 @@ private:
               G[*adj_v].op); // Lock number = number of dependent iter_args
     }
 
-    this->processed_vertices.push_back(it);
+    this->markVertexProcessed(it);
   }
 
   void executeOp(air::ChannelPutOp op, Graph::vertex_descriptor it) {
+    auto lock = this->lockChannelState();
 
     // Get launch runner node
     auto launch_runner = this;
@@ -1158,13 +1406,31 @@ private:
     if (launch_runner->channel_ops_in_progress.count(key)) {
       processed = launch_runner->channel_ops_in_progress[key].first;
       if (processed == total_count) {
-        this->processed_vertices.push_back(it);
+        this->markVertexProcessed(it);
+        // In a buffered channel, the transfer waits in the FIFO for its gets,
+        // freeing its ports and the channel for the next put
+        if (this->getChannelBufferDepth(op) > 1) {
+          auto &progress = launch_runner->channel_ops_in_progress[key];
+          launch_runner->channel_fifos[key.first].push_back(progress.first);
+          for (auto p : progress.second)
+            p->isReserved = false;
+          progress.first = 0;
+          progress.second.clear();
+        }
+      }
+      // Else if under per-core simulation mode, then complete the work for
+      // this core, as its transfer may be buffered before the others finish
+      else if (this->getChannelBufferDepth(op) > 1 &&
+               this->sim_granularity == "core" &&
+               op->getParentOfType<air::HerdOp>()) {
+        this->markVertexProcessed(it);
       }
     } else
       this->runner_assertion(false, "unknown channel.put op");
   }
 
   void executeOp(air::ChannelGetOp op, Graph::vertex_descriptor it) {
+    auto lock = this->lockChannelState();
 
     // Get launch runner node
     auto launch_runner = this;
@@ -1182,6 +1448,26 @@ private:
     unsigned total_count =
         this->tokenSpatialFactorForResource<air::HierarchyInterface>(op, {});
 
+    // Gets of a buffered transfer drain the channel's FIFO, whose puts have
+    // already released their ports
+    auto &fifo = launch_runner->channel_fifos[op.getChanName().str()];
+    if (!fifo.empty()) {
+      auto &progress = launch_runner->channel_ops_in_progress[std::make_pair(
+          op.getChanName().str(), "get")];
+      if (get_processed == total_count) {
+        this->markVertexProcessed(it);
+        for (auto g : progress.second)
+          g->isReserved = false;
+        progress.first = 0;
+        progress.second.clear();
+        fifo.pop_front();
+      } else if (this->sim_granularity == "core" &&
+                 op->getParentOfType<air::HerdOp>()) {
+        this->markVertexProcessed(it);
+      }
+      return;
+    }
+
     // Calculate how many src and dst ports to deallocate
     std::pair<std::string, std::string> put_key =
         std::make_pair(op.getChanName().str(), "put");
@@ -1235,7 +1521,7 @@ private:
     // If data movement is complete, clear put and get progresses
     if ((put_processed * bcast_factor == total_count) &&
         (get_processed == total_count)) {
-      this->processed_vertices.push_back(it);
+      this->markVertexProcessed(it);
       launch_runner->channel_ops_in_progress[get_key].first = 0;
       launch_runner->channel_ops_in_progress[get_key].second.clear();
       launch_runner->channel_ops_in_progress[put_key].first = 0;
@@ -1244,13 +1530,13 @@ private:
     // Else if a previous executeOp has already cleared the progresses
     else if (!launch_runner->channel_ops_in_progress[get_key].first &&
              !launch_runner->channel_ops_in_progress[put_key].first) {
-      this->processed_vertices.push_back(it);
+      this->markVertexProcessed(it);
     }
     // Else if under per-core simulation mode, then complete the work for this
     // core
     else if (this->sim_granularity == "core" &&
              op->getParentOfType<air::HerdOp>()) {
-      this->processed_vertices.push_back(it);
+      this->markVertexProcessed(it);
     }
     // Else, continue dispatching get events
     else {
@@ -1258,7 +1544,7 @@ private:
   }
 
   void executeOp(Graph::vertex_descriptor it) {
-    this->processed_vertices.push_back(it);
+    this->markVertexProcessed(it);
   }
 
   // Adds pointer between runner node and command graph
@@ -1275,7 +1561,7 @@ private:
                    bool push_to_latent_wavefront_candidates = false) {
 
     // Remove start_v from processed_vertices
-    this->removeVertexFromVertices(this->processed_vertices, v);
+    this->unmarkVertexProcessed(v);
 
     // Reset node's start_time and end_time, if the async event represented by
     // the vertex is complete
@@ -1291,33 +1577,62 @@ private:
       auto adj_set = boost::adjacent_vertices(v, G);
       for (auto adj_v = adj_set.first; adj_v != adj_set.second; ++adj_v) {
         if (!isa<scf::YieldOp>(G[*adj_v].op) && !G[*adj_v].is_started()) {
-          push_back_if_unique<Graph::vertex_descriptor>(
-              this->latent_wavefront_candidates, *adj_v);
+          this->latent_wavefront_candidates.insert(*adj_v);
         }
       }
     }
   }
 
+  // Collect all vertices on any path from start_v to end_v, in depth-first
+  // pre-order. Each vertex is visited at most once.
   bool hasPath(Graph::vertex_descriptor start_v, Graph::vertex_descriptor end_v,
                Graph &G, SmallVector<Graph::vertex_descriptor, 1> &vec) {
 
-    vec.push_back(start_v);
-    if (start_v == end_v)
-      return true;
-    int pathCount = 0;
-    auto adj_set = boost::adjacent_vertices(start_v, G);
-    for (auto adj_v = adj_set.first; adj_v != adj_set.second; ++adj_v) {
-      SmallVector<Graph::vertex_descriptor, 1> tmp_vec;
-      if (this->hasPath(*adj_v, end_v, G, tmp_vec)) {
-        pathCount++;
-        // Concatenate
-        vec.insert(vec.end(), tmp_vec.begin(), tmp_vec.end());
+    // Mark all vertices which can reach end_v
+    std::vector<bool> reaches_end(boost::num_vertices(G), false);
+    std::vector<Graph::vertex_descriptor> worklist = {end_v};
+    reaches_end[end_v] = true;
+    while (!worklist.empty()) {
+      auto v = worklist.back();
+      worklist.pop_back();
+      auto inv_adj_set = boost::inv_adjacent_vertices(v, G);
+      for (auto inv_adj_v = inv_adj_set.first; inv_adj_v != inv_adj_set.second;
+           ++inv_adj_v) {
+        if (!reaches_end[*inv_adj_v]) {
+          reaches_end[*inv_adj_v] = true;
+          worklist.push_back(*inv_adj_v);
+        }
       }
     }
-    if (pathCount)
-      return true;
-    vec.pop_back();
-    return false;
+    if (!reaches_end[start_v])
+      return false;
+
+    // Walk from start_v, only entering vertices which can reach end_v
+    std::vector<bool> visited(boost::num_vertices(G), false);
+    std::vector<std::pair<Graph::vertex_descriptor, Graph::adjacency_iterator>>
+        stack;
+    visited[start_v] = true;
+    vec.push_back(start_v);
+    if (start_v != end_v)
+      stack.push_back(
+          std::make_pair(start_v, boost::adjacent_vertices(start_v, G).first));
+    while (!stack.empty()) {
+      auto v = stack.back().first;
+      auto adj_v = stack.back().second;
+      if (adj_v == boost::adjacent_vertices(v, G).second) {
+        stack.pop_back();
+        continue;
+      }
+      stack.back().second++;
+      if (visited[*adj_v] || !reaches_end[*adj_v])
+        continue;
+      visited[*adj_v] = true;
+      vec.push_back(*adj_v);
+      if (*adj_v != end_v)
+        stack.push_back(
+            std::make_pair(*adj_v, boost::adjacent_vertices(*adj_v, G).first));
+    }
+    return true;
   }
 
   // Get a vector of async tokens which are ready to advance to the next loop
@@ -1336,7 +1651,7 @@ private:
 
       // Check each token's dependence fulfillment at scf.yield
       std::string node_type = "ssa";
-      auto dep_pair_entry = std::make_pair(dep_node, node_type);
+      auto dep_pair_entry = std::make_pair(&dep_node, node_type);
       if (checkEachDependenceFulfillment(dep_pair_entry, time)) {
         token_ids.push_back(token_id);
       }
@@ -1388,17 +1703,18 @@ private:
   }
 
   // Check if a channel dependence has been fulfilled
-  bool checkChannelDependenceFulfillment(dependencyNodeEntry dep_node,
-                                         std::vector<unsigned> position) {
+  bool checkChannelDependenceFulfillment(dependencyNodeEntry &dep_node,
+                                         std::vector<unsigned> &position) {
     auto channel_op = dyn_cast<air::ChannelInterface>(dep_node.op);
     this->runner_assertion(channel_op, "op being checked is not a channel op");
     std::string chan_name = channel_op.getChanName().str();
+    auto lock = this->lockChannelState();
     unsigned th =
         (position.size())
             ? (this->tokenSpatialFactorForDependency(dep_node.op, position))
             : (1);
     bool found_entry = false;
-    for (auto entry : *channel_token_counts_ptr) {
+    for (auto &entry : *channel_token_counts_ptr) {
       if ((!found_entry) && entry.first == chan_name) {
         found_entry = true;
         if (entry.second < th) {
@@ -1414,10 +1730,10 @@ private:
 
   // Check if a dependence has been fulfilled
   bool checkEachDependenceFulfillment(
-      std::pair<dependencyNodeEntry, std::string> &dep,
-      dependencyNodeEntry &node, std::vector<unsigned> position,
+      std::pair<dependencyNodeEntry *, std::string> &dep,
+      dependencyNodeEntry &node, std::vector<unsigned> &position,
       uint64_t time) {
-    dependencyNodeEntry &dep_node = dep.first;
+    dependencyNodeEntry &dep_node = *dep.first;
     if (dep.second == "ssa") {
       if ((!dep_node.is_started()) || (!dep_node.is_done(time))) {
         // If source and sink of dep are both under the same loop
@@ -1455,11 +1771,11 @@ private:
 
   // Check if a dependence has been fulfilled
   bool checkEachDependenceFulfillment(
-      std::pair<dependencyNodeEntry, std::string> &dep, uint64_t time) {
+      std::pair<dependencyNodeEntry *, std::string> &dep, uint64_t time) {
     if (dep.second == "ssa") {
-      this->runner_assertion(dep.first.start_time >= 0,
+      this->runner_assertion(dep.first->start_time >= 0,
                              "invalid event start timestamp");
-      if ((!dep.first.is_started()) || (!dep.first.is_done(time))) {
+      if ((!dep.first->is_started()) || (!dep.first->is_done(time))) {
         // If source and sink of dep are both under the same loop
         return false;
       }
@@ -1468,8 +1784,9 @@ private:
       // node depend on
       return false;
     } else if (dep.second == "sym") {
-      dependencyNodeEntry &dep_node = dep.first;
-      if (!this->checkChannelDependenceFulfillment(dep_node, {})) {
+      dependencyNodeEntry &dep_node = *dep.first;
+      std::vector<unsigned> no_position;
+      if (!this->checkChannelDependenceFulfillment(dep_node, no_position)) {
         return false;
       }
     } else {
@@ -1501,7 +1818,7 @@ private:
     // fanout
     if (isa<air::ChannelPutOp>(op)) {
       auto channel_op = dyn_cast<air::ChannelInterface>(op);
-      auto chan = getChannelDeclarationThroughSymbol(channel_op);
+      auto chan = this->getChannelDeclaration(channel_op);
       if (chan->hasAttr("broadcast_shape")) {
         auto size = extractFromI64ArrayAttr(chan->getAttr("broadcast_shape"));
         for (auto s : size) {
@@ -1529,6 +1846,7 @@ private:
         }
       } else if (auto hier = dyn_cast<air::HierarchyInterface>(parent)) {
         if (this->sim_granularity == "core" && isa<air::HerdOp>(parent)) {
+          output *= this->getFoldedCoreCount();
         } else {
           output *= canonicalizer.getTripCountInHierarchyOp(hier);
         }
@@ -1565,7 +1883,7 @@ private:
     // fanout
     if (isa<air::ChannelPutOp>(op)) {
       auto channel_op = dyn_cast<air::ChannelInterface>(op);
-      auto chan = getChannelDeclarationThroughSymbol(channel_op);
+      auto chan = this->getChannelDeclaration(channel_op);
       if (chan->hasAttr("broadcast_shape")) {
         auto size = extractFromI64ArrayAttr(chan->getAttr("broadcast_shape"));
         for (auto s : size) {
@@ -1593,6 +1911,7 @@ private:
         }
       } else if (auto hier = dyn_cast<air::HierarchyInterface>(parent)) {
         if (this->sim_granularity == "core" && isa<air::HerdOp>(parent)) {
+          output *= this->getFoldedCoreCount();
         } else {
           output *= this->canonicalizer.getTripCountInHierarchyOp(hier);
         }
@@ -1736,7 +2055,8 @@ private:
       if (this->sim_granularity == "herd" || use_multiplier) {
         return this->getResourceUsageMultiplier(op, false);
       } else if (this->sim_granularity == "core") {
-        return this->getResourceUsageMultiplier(op, true);
+        return this->getResourceUsageMultiplier(op, true) *
+               this->getFoldedCoreCount();
       }
       // TODO: add other simulation granularities
     } else if (isa<air::SegmentOp>(op)) {
@@ -1772,7 +2092,7 @@ private:
   }
 
   bool pushToDepListIfAffineIfHit(
-      std::vector<std::pair<dependencyNodeEntry, std::string>> &dep_list,
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> &dep_list,
       dependencyNodeEntry &node, std::vector<unsigned> position,
       std::string dep_type = "") {
     bool pushed = false;
@@ -1784,16 +2104,24 @@ private:
                                           spatial_loop);
       if (positionHitsAffineIfCondition(node.op, spatial_loop, affine_if_nest,
                                         this->ctrl_g->position)) {
-        dep_list.push_back(std::make_pair(node, dep_type));
+        dep_list.push_back(std::make_pair(&node, dep_type));
         pushed = true;
       }
     } else {
-      dep_list.push_back(std::make_pair(node, dep_type));
+      dep_list.push_back(std::make_pair(&node, dep_type));
       pushed = true;
     }
     return pushed;
   }
 
+  // Number of cores simulated by this runner node. Symmetric cores folded into
+  // a core's runner node share its simulation.
+  unsigned getFoldedCoreCount() {
+    if (!this->ctrl_g)
+      return 1;
+    return 1 + this->ctrl_g->folded_positions.size();
+  }
+
   // Get parent launch runner node
   runnerNode *getParentLaunchRunner() {
     runnerNode *parent_runner = this;
@@ -1836,51 +2164,35 @@ private:
     }
   }
 
-  // Get a vector of first elements from a vector of tuples
-  std::vector<Graph::vertex_descriptor> getVectorOfFirstFromVectorOfTuples(
-      std::vector<std::tuple<Graph::vertex_descriptor, std::vector<resource *>,
-                             unsigned>>
-          tuples) {
-    std::vector<Graph::vertex_descriptor> items;
-    std::transform(
-        tuples.begin(), tuples.end(), std::back_inserter(items),
-        [](const std::tuple<Graph::vertex_descriptor, std::vector<resource *>,
-                            unsigned> &p) { return std::get<0>(p); });
-    return items;
-  }
-
-  // Find all vertices adjacent to given vertices in graph
+  // Visit the unprocessed vertices adjacent to the processed vertices, in the
+  // order the processed vertices were processed. Processed vertices whose
+  // adjacent vertices are all processed are dropped from the frontier, until a
+  // vertex is unprocessed again. `visits` counts the frontier vertices and
+  // their out edges.
   void findAdjacentVerticesToProcessed(
-      std::vector<Graph::vertex_descriptor> &adjacent_vertices) {
-    Graph G = this->ctrl_g->g;
-    for (auto v : this->processed_vertices) {
+      llvm::function_ref<void(Graph::vertex_descriptor)> visit,
+      uint64_t &visits) {
+    Graph &G = this->ctrl_g->g;
+    if (this->processed_frontier_stale) {
+      this->processed_frontier = this->processed_vertices.vector();
+      this->processed_frontier_stale = false;
+    }
+    unsigned kept = 0;
+    for (auto v : this->processed_frontier) {
+      bool exhausted = true;
       auto adj_set = boost::adjacent_vertices(v, G);
+      visits++;
       for (auto v1 = adj_set.first; v1 != adj_set.second; ++v1) {
-        bool found_duplicate = false;
-        for (auto v2 : adjacent_vertices) {
-          if (*v1 == v2) {
-            found_duplicate = true;
-          }
-        }
-        bool is_in_vertices = false;
-        for (auto v3 : this->processed_vertices) {
-          if (*v1 == v3) {
-            is_in_vertices = true;
-          }
-        }
-        if (!found_duplicate && !is_in_vertices) {
-          adjacent_vertices.push_back(*v1);
-        }
+        visits++;
+        if (this->processed_vertices.contains(*v1))
+          continue;
+        exhausted = false;
+        visit(*v1);
       }
+      if (!exhausted)
+        this->processed_frontier[kept++] = v;
     }
-  }
-
-  // Remove vertices in vector a which already exist in vector b
-  void removeRepeatedVertices(std::vector<Graph::vertex_descriptor> &a,
-                              std::vector<Graph::vertex_descriptor> b) {
-    for (auto v : b) {
-      this->removeVertexFromVertices(a, v);
-    }
+    this->processed_frontier.resize(kept);
   }
 
   // Remove ops in affine.if which aren't running on this core
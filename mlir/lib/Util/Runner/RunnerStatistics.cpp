@@ -0,0 +1,257 @@
+//===- RunnerStatistics.cpp -------------------------------------*- C++ -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef AIR_UTIL_RUNNER_STATISTICS
+#define AIR_UTIL_RUNNER_STATISTICS
+
+namespace xilinx {
+namespace air {
+
+// Cycles during which the instances of a hierarchy op ran
+struct hierarchySpan {
+  uint64_t instances = 0;
+  uint64_t start = 0;
+  uint64_t end = 0;
+};
+
+// Occupancy of the FIFO of a channel
+struct channelOccupancy {
+  unsigned depth = 1;
+  unsigned peak = 0;
+  // Keys: number of transfers held; mapped: cycles spent holding them
+  std::map<unsigned, uint64_t> cycles;
+};
+
+// Counters gathered over a simulation, for the utilization report
+struct runnerStatistics {
+  // Reserved cycles of each resource, in the order of
+  // device::getTrackedResources
+  std::vector<uint64_t> busy_cycles;
+  // Keys: channel symbol; mapped: number of channel ops started and the cycles
+  // they stalled
+  std::map<std::string, std::pair<uint64_t, uint64_t>> channel_stalls;
+  // Keys: source and destination memory spaces; mapped: bytes moved
+  std::map<std::pair<unsigned, unsigned>, double> transferred_bytes;
+  // Peak live bytes of each memory, in the order of
+  // device::getTrackedMemories
+  std::vector<double> peak_bytes;
+  // Keys: memory space; mapped: number of allocations which waited for memory
+  // and the cycles they waited
+  std::map<unsigned, std::pair<uint64_t, uint64_t>> allocation_stalls;
+  // Keys: air.launch, air.segment or air.herd op
+  std::map<mlir::Operation *, hierarchySpan> spans;
+  // Keys: interned name and description of data movement and compute ops;
+  // mapped: number of ops which ran and their cycles
+  std::map<std::pair<unsigned, unsigned>, std::pair<uint64_t, uint64_t>>
+      op_cycles;
+  // Keys: channel symbol
+  std::map<std::string, channelOccupancy> channel_occupancy;
+
+  // Repeat the counts gathered since `before` another `times` times, each
+  // repetition lasting `period` cycles
+  void repeatSince(const runnerStatistics &before, uint64_t times,
+                   uint64_t period) {
+    for (unsigned i = 0; i < busy_cycles.size(); i++) {
+      uint64_t prev = i < before.busy_cycles.size() ? before.busy_cycles[i] : 0;
+      busy_cycles[i] += (busy_cycles[i] - prev) * times;
+    }
+    repeatCounts(channel_stalls, before.channel_stalls, times);
+    repeatCounts(allocation_stalls, before.allocation_stalls, times);
+    repeatCounts(op_cycles, before.op_cycles, times);
+    for (auto &entry : channel_occupancy) {
+      auto it = before.channel_occupancy.find(entry.first);
+      for (auto &level : entry.second.cycles) {
+        uint64_t prev = 0;
+        if (it != before.channel_occupancy.end() &&
+            it->second.cycles.count(level.first))
+          prev = it->second.cycles.at(level.first);
+        level.second += (level.second - prev) * times;
+      }
+    }
+    for (auto &entry : transferred_bytes) {
+      double prev = 0;
+      auto it = before.transferred_bytes.find(entry.first);
+      if (it != before.transferred_bytes.end())
+        prev = it->second;
+      entry.second += (entry.second - prev) * times;
+    }
+    for (auto &entry : spans) {
+      hierarchySpan prev;
+      auto it = before.spans.find(entry.first);
+      if (it != before.spans.end())
+        prev = it->second;
+      if (entry.second.instances == prev.instances)
+        continue;
+      auto &span = entry.second;
+      span.instances += (span.instances - prev.instances) * times;
+      span.end += period * times;
+    }
+  }
+
+  // Add the counts gathered from `before` to `after`, moving the spans started
+  // in between from time `from` to time `to`. Peak memory footprints are left
+  // to the caller.
+  void addSince(const runnerStatistics &before, const runnerStatistics &after,
+                uint64_t from, uint64_t to) {
+    for (unsigned i = 0; i < busy_cycles.size(); i++)
+      busy_cycles[i] += after.busy_cycles[i] - before.busy_cycles[i];
+    addCounts(channel_stalls, before.channel_stalls, after.channel_stalls);
+    addCounts(allocation_stalls, before.allocation_stalls,
+              after.allocation_stalls);
+    addCounts(op_cycles, before.op_cycles, after.op_cycles);
+    for (auto &entry : after.channel_occupancy) {
+      auto &occupancy = channel_occupancy[entry.first];
+      occupancy.depth = entry.second.depth;
+      occupancy.peak = std::max(occupancy.peak, entry.second.peak);
+      auto it = before.channel_occupancy.find(entry.first);
+      for (auto &level : entry.second.cycles) {
+        uint64_t prev = 0;
+        if (it != before.channel_occupancy.end() &&
+            it->second.cycles.count(level.first))
+          prev = it->second.cycles.at(level.first);
+        occupancy.cycles[level.first] += level.second - prev;
+      }
+    }
+    for (auto &entry : after.transferred_bytes) {
+      double prev = 0;
+      auto it = before.transferred_bytes.find(entry.first);
+      if (it != before.transferred_bytes.end())
+        prev = it->second;
+      transferred_bytes[entry.first] += entry.second - prev;
+    }
+    for (auto &entry : after.spans) {
+      if (before.spans.count(entry.first))
+        continue;
+      auto &span = spans[entry.first];
+      span.instances += entry.second.instances;
+      if (span.instances == entry.second.instances)
+        span.start = entry.second.start - from + to;
+      span.end = std::max(span.end, entry.second.end - from + to);
+    }
+  }
+
+private:
+  template <typename K>
+  static void
+  addCounts(std::map<K, std::pair<uint64_t, uint64_t>> &counts,
+            const std::map<K, std::pair<uint64_t, uint64_t>> &before,
+            const std::map<K, std::pair<uint64_t, uint64_t>> &after) {
+    for (auto &entry : after) {
+      std::pair<uint64_t, uint64_t> prev = {0, 0};
+      auto it = before.find(entry.first);
+      if (it != before.end())
+        prev = it->second;
+      auto &count = counts[entry.first];
+      count.first += entry.second.first - prev.first;
+      count.second += entry.second.second - prev.second;
+    }
+  }
+
+  template <typename K>
+  static void
+  repeatCounts(std::map<K, std::pair<uint64_t, uint64_t>> &counts,
+               const std::map<K, std::pair<uint64_t, uint64_t>> &before,
+               uint64_t times) {
+    for (auto &entry : counts) {
+      std::pair<uint64_t, uint64_t> prev = {0, 0};
+      auto it = before.find(entry.first);
+      if (it != before.end())
+        prev = it->second;
+      entry.second.first += (entry.second.first - prev.first) * times;
+      entry.second.second += (entry.second.second - prev.second) * times;
+    }
+  }
+};
+
+// Log of the ops started during a launch iteration. Each op is linked to the
+// dependency which finished last before it started, so that following the
+// links back from the launch terminator gives the iteration's critical path.
+class criticalPathLog {
+
+public:
+  struct opInstance {
+    dependencyNodeEntry *node;
+    int64_t pid;
+    uint64_t start_time;
+    uint64_t end_time;
+    // Index of the op's critical predecessor, or -1 if it has none
+    int64_t predecessor;
+  };
+
+  void clear() {
+    instances.clear();
+    latest_instance.clear();
+    latest_instance_of_op.clear();
+  }
+
+  // Log an op which started. Its predecessor is chosen among the ops of its
+  // dependency list and `partner_ops`. Ops without any logged dependency are
+  // linked to the hierarchy op which started their runner node.
+  void record(
+      dependencyNodeEntry *node, int64_t pid, uint64_t start_time,
+      uint64_t end_time,
+      std::vector<std::pair<dependencyNodeEntry *, std::string>> &dep_list,
+      std::vector<mlir::Operation *> &partner_ops,
+      mlir::Operation *parent_hierarchy_op) {
+    int64_t predecessor = -1;
+    auto consider = [&](size_t idx) {
+      if (predecessor == -1 ||
+          instances[idx].end_time > instances[predecessor].end_time)
+        predecessor = idx;
+    };
+    for (auto &dep : dep_list) {
+      if (dep.first == node)
+        continue;
+      auto it = latest_instance.find(dep.first);
+      if (it != latest_instance.end())
+        consider(it->second);
+    }
+    for (auto op : partner_ops) {
+      auto it = latest_instance_of_op.find(op);
+      if (it != latest_instance_of_op.end())
+        consider(it->second);
+    }
+    if (predecessor == -1) {
+      auto it = latest_instance_of_op.find(parent_hierarchy_op);
+      if (it != latest_instance_of_op.end())
+        predecessor = it->second;
+    }
+    latest_instance[node] = instances.size();
+    latest_instance_of_op[node->op] = instances.size();
+    instances.push_back({node, pid, start_time, end_time, predecessor});
+  }
+
+  // Update the end time of the last instance of `node`
+  void setEndTime(dependencyNodeEntry *node, uint64_t end_time) {
+    auto it = latest_instance.find(node);
+    if (it != latest_instance.end())
+      instances[it->second].end_time = end_time;
+  }
+
+  // Ops on the critical path ending at the last instance of `node`
+  std::vector<opInstance> getPathTo(dependencyNodeEntry *node) {
+    std::vector<opInstance> path;
+    auto it = latest_instance.find(node);
+    if (it == latest_instance.end())
+      return path;
+    for (int64_t idx = it->second; idx != -1;
+         idx = instances[idx].predecessor)
+      path.push_back(instances[idx]);
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+
+private:
+  std::vector<opInstance> instances;
+  std::unordered_map<dependencyNodeEntry *, size_t> latest_instance;
+  std::unordered_map<mlir::Operation *, size_t> latest_instance_of_op;
+}; // criticalPathLog
+
+} // namespace air
+} // namespace xilinx
+
+#endif // AIR_UTIL_RUNNER_STATISTICS
@@ -0,0 +1,300 @@
+//===- TraceWriter.cpp ------------------------------------------*- C++ -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef AIR_UTIL_RUNNER_TRACE_WRITER
+#define AIR_UTIL_RUNNER_TRACE_WRITER
+
+namespace xilinx {
+namespace air {
+
+// Output format of the simulated trace. Json is the multi-line Chrome trace
+// format, Compact writes one Chrome trace event per line, and Perfetto writes
+// a binary Perfetto protobuf trace.
+enum class traceFormat { Json, Compact, Perfetto };
+
+// Events written to the trace. Hierarchy only keeps the events of launch,
+// segment and herd ops and their terminators.
+enum class traceLevel { None, Hierarchy, All };
+
+inline std::optional<traceFormat> symbolizeTraceFormat(llvm::StringRef str) {
+  return llvm::StringSwitch<std::optional<traceFormat>>(str)
+      .Case("json", traceFormat::Json)
+      .Case("compact", traceFormat::Compact)
+      .Case("perfetto", traceFormat::Perfetto)
+      .Default(std::nullopt);
+}
+
+inline std::optional<traceLevel> symbolizeTraceLevel(llvm::StringRef str) {
+  return llvm::StringSwitch<std::optional<traceLevel>>(str)
+      .Case("none", traceLevel::None)
+      .Case("hierarchy", traceLevel::Hierarchy)
+      .Case("all", traceLevel::All)
+      .Default(std::nullopt);
+}
+
+// Protobuf wire-format encoder, sufficient for Perfetto trace packets
+struct protoMessage {
+  std::string bytes;
+
+  void addVarint(unsigned field, uint64_t value) {
+    writeVarint((uint64_t)field << 3);
+    writeVarint(value);
+  }
+  void addBytes(unsigned field, llvm::StringRef value) {
+    writeVarint(((uint64_t)field << 3) | 2);
+    writeVarint(value.size());
+    bytes.append(value.data(), value.size());
+  }
+  void addMessage(unsigned field, const protoMessage &message) {
+    addBytes(field, message.bytes);
+  }
+
+private:
+  void writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+      bytes.push_back((char)((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    bytes.push_back((char)value);
+  }
+};
+
+// Streams trace events to an output stream. Events are formatted into a
+// buffer which is written to the stream in large blocks. Time stamps are given
+// in cycles and converted with the device clock.
+class traceWriter {
+
+public:
+  traceWriter(llvm::raw_ostream &os, traceFormat format = traceFormat::Json,
+              traceLevel level = traceLevel::All)
+      : os(os), format(format), level(level) {}
+
+  ~traceWriter() { flush(); }
+
+  // Whether events of vertices of a category are written to the trace
+  bool isEnabled(dependencyNodeCategory category) const {
+    if (level == traceLevel::Hierarchy)
+      return category == dependencyNodeCategory::Hierarchy;
+    return level == traceLevel::All;
+  }
+
+  void setClock(double clock) { ns_per_cycle = 1000000000.0 / clock; }
+
+  void writeHeader(llvm::raw_ostream &s) {
+    flush();
+    if (format != traceFormat::Perfetto)
+      s << "[\n";
+  }
+
+  void writeFooter(llvm::raw_ostream &s) {
+    flush();
+    if (format != traceFormat::Perfetto)
+      s << "{}]\n";
+  }
+
+  // Write an op's begin ('B') or end ('E') event. The event name is the
+  // concatenation of name and description.
+  void writeEvent(llvm::StringRef name, llvm::StringRef description,
+                  llvm::StringRef cat, char ph, uint64_t time, int64_t tid,
+                  int64_t pid) {
+    writeEvent(buffer, name, description, cat, ph, time, tid, pid);
+    if (buffer.size() >= flush_threshold)
+      flush();
+  }
+
+  // Write an event to a side buffer, to be appended to the trace later. Side
+  // buffers may be written concurrently as long as each (pid, tid) track is
+  // only written to one of them.
+  void writeEvent(std::string &out, llvm::StringRef name,
+                  llvm::StringRef description, llvm::StringRef cat, char ph,
+                  uint64_t time, int64_t tid, int64_t pid) {
+    uint64_t time_in_ns = (uint64_t)std::round(((double)time) / ns_per_cycle);
+    if (format == traceFormat::Perfetto) {
+      writePerfettoEvent(out, name, description, cat, ph, time_in_ns, tid,
+                         pid);
+      return;
+    }
+    llvm::raw_string_ostream s(out);
+    if (format == traceFormat::Compact) {
+      s << "{\"name\":\"" << name << description << "\",\"cat\":\"" << cat
+        << "\",\"ph\":\"" << ph << "\",\"ts\":";
+      writeTimeStamp(s, time_in_ns);
+      s << ",\"pid\":" << pid << ",\"tid\":" << tid << "},\n";
+      return;
+    }
+    s << "{\n  \"name\": \"" << name << description << "\",\n  \"cat\": \""
+      << cat << "\",\n  \"ph\": \"" << ph << "\",\n  \"ts\": ";
+    writeTimeStamp(s, time_in_ns);
+    s << ",\n  \"pid\": " << pid << ",\n  \"tid\": " << tid
+      << ",\n  \"args\": {}\n},\n";
+  }
+
+  // Write a metadata event naming or ordering a process or thread
+  void writeMetadata(llvm::StringRef item_name, llvm::StringRef arg_name,
+                     llvm::StringRef arg_entry, int64_t pid,
+                     int64_t tid = -1) {
+    if (level == traceLevel::None)
+      return;
+    if (format == traceFormat::Perfetto) {
+      // Perfetto orders tracks by name, so sort indices are dropped. Names
+      // are written even if an event already described the track, to rename
+      // it.
+      if (item_name == "process_name" || item_name == "thread_name") {
+        claimTrack(pid, tid);
+        writeTrackDescriptor(buffer, pid, tid, arg_entry);
+      }
+      return;
+    }
+    llvm::raw_string_ostream s(buffer);
+    if (format == traceFormat::Compact) {
+      s << "{\"name\":\"" << item_name << "\",\"ph\":\"M\",\"pid\":" << pid;
+      if (tid != -1)
+        s << ",\"tid\":" << tid;
+      s << ",\"args\":{\"" << arg_name << "\":\"" << arg_entry << "\"}},\n";
+      return;
+    }
+    s << "{\n  \"name\": \"" << item_name << "\",\n  \"ph\": \"M\",\n"
+      << "  \"pid\": " << pid << ",\n";
+    if (tid != -1)
+      s << "  \"tid\": " << tid << ",\n";
+    s << "  \"args\": {\n    \"" << arg_name << "\": \"" << arg_entry
+      << "\"\n  }\n},\n";
+  }
+
+  // Append events previously written to a side buffer
+  void append(llvm::StringRef events) {
+    buffer.append(events.data(), events.size());
+    if (buffer.size() >= flush_threshold)
+      flush();
+  }
+
+  void flush() {
+    os << buffer;
+    buffer.clear();
+  }
+
+private:
+  llvm::raw_ostream &os;
+  traceFormat format;
+  traceLevel level;
+  double ns_per_cycle = 1.0;
+
+  // Formatted events not yet written to the output stream
+  std::string buffer;
+  static constexpr size_t flush_threshold = 1 << 20;
+
+  // Perfetto tracks which have been described in the trace
+  std::set<std::pair<int64_t, int64_t>> described_tracks;
+  std::mutex described_tracks_mutex;
+
+  // Write a time stamp in us, with 3 d.p.
+  void writeTimeStamp(llvm::raw_ostream &s, uint64_t time_in_ns) {
+    uint64_t frac_part = time_in_ns % 1000;
+    s << time_in_ns / 1000 << ".";
+    if (frac_part < 100)
+      s << "0";
+    if (frac_part < 10)
+      s << "0";
+    s << frac_part;
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Perfetto
+  //===--------------------------------------------------------------------===//
+
+  // Field numbers of the Perfetto trace protos
+  enum perfettoField : unsigned {
+    TracePacket = 1,
+    PacketTimestamp = 8,
+    PacketSequenceId = 10,
+    PacketTrackEvent = 11,
+    PacketTrackDescriptor = 60,
+    EventType = 9,
+    EventTrackUuid = 11,
+    EventCategories = 22,
+    EventName = 23,
+    DescriptorUuid = 1,
+    DescriptorName = 2,
+    DescriptorProcess = 3,
+    DescriptorParentUuid = 5,
+    ProcessPid = 1,
+    ProcessName = 6,
+  };
+  static constexpr uint64_t perfetto_slice_begin = 1;
+  static constexpr uint64_t perfetto_slice_end = 2;
+  static constexpr uint64_t perfetto_sequence_id = 1;
+
+  // Processes get a track of their own, and each thread a child track
+  static uint64_t getTrackUuid(int64_t pid, int64_t tid) {
+    return ((uint64_t)(pid & 0xffffffff) << 32) | (uint64_t)(tid + 1);
+  }
+
+  void writePacket(std::string &out, const protoMessage &packet) {
+    protoMessage trace;
+    trace.addMessage(TracePacket, packet);
+    out += trace.bytes;
+  }
+
+  // Record a track as described, returning whether it was not yet. The lookup
+  // and the insertion take the lock once, so that only one of the partitions
+  // writing concurrently describes a track.
+  bool claimTrack(int64_t pid, int64_t tid) {
+    std::lock_guard<std::mutex> lock(described_tracks_mutex);
+    return described_tracks.insert({pid, tid}).second;
+  }
+
+  void writeTrackDescriptor(std::string &out, int64_t pid, int64_t tid,
+                            llvm::StringRef name) {
+    protoMessage descriptor;
+    descriptor.addVarint(DescriptorUuid, getTrackUuid(pid, tid));
+    descriptor.addBytes(DescriptorName, name);
+    if (tid == -1) {
+      protoMessage process;
+      process.addVarint(ProcessPid, (uint64_t)pid);
+      process.addBytes(ProcessName, name);
+      descriptor.addMessage(DescriptorProcess, process);
+    } else {
+      descriptor.addVarint(DescriptorParentUuid, getTrackUuid(pid, -1));
+    }
+    protoMessage packet;
+    packet.addVarint(PacketSequenceId, perfetto_sequence_id);
+    packet.addMessage(PacketTrackDescriptor, descriptor);
+    writePacket(out, packet);
+  }
+
+  // Describe a track before its first event, if no metadata named it
+  void describeTrackIfNew(std::string &out, int64_t pid, int64_t tid) {
+    if (claimTrack(pid, -1))
+      writeTrackDescriptor(out, pid, -1, "process " + std::to_string(pid));
+    if (claimTrack(pid, tid))
+      writeTrackDescriptor(out, pid, tid, "thread " + std::to_string(tid));
+  }
+
+  void writePerfettoEvent(std::string &out, llvm::StringRef name,
+                          llvm::StringRef description, llvm::StringRef cat,
+                          char ph, uint64_t time_in_ns, int64_t tid,
+                          int64_t pid) {
+    describeTrackIfNew(out, pid, tid);
+    protoMessage event;
+    event.addVarint(EventType,
+                    ph == 'B' ? perfetto_slice_begin : perfetto_slice_end);
+    event.addVarint(EventTrackUuid, getTrackUuid(pid, tid));
+    event.addBytes(EventCategories, cat);
+    if (ph == 'B')
+      event.addBytes(EventName, (name + description).str());
+    protoMessage packet;
+    packet.addVarint(PacketTimestamp, time_in_ns);
+    packet.addVarint(PacketSequenceId, perfetto_sequence_id);
+    packet.addMessage(PacketTrackEvent, event);
+    writePacket(out, packet);
+  }
+}; // traceWriter
+
+} // namespace air
+} // namespace xilinx
+
+#endif // AIR_UTIL_RUNNER_TRACE_WRITER
@@ -333,9 +333,104 @@ void air::eraseAIRHierarchyOperand(air::HierarchyInterface op, unsigned index) {
   op->setAttr(attrName, Builder(op->getContext()).getDenseI32ArrayAttr(sizes));
 }
 
+air::ChannelSymbolUses::ChannelSymbolUses(Operation *root,
+                                          bool enclosingDeclarations)
+    : root(root) {
+  if (enclosingDeclarations) {
+    for (Operation *parent = root->getParentOp(); parent;
+         parent = parent->getParentOp()) {
+      if (!parent->hasTrait<OpTrait::SymbolTable>())
+        continue;
+      for (auto &region : parent->getRegions())
+        for (auto &block : region)
+          for (auto channel : block.getOps<air::ChannelOp>())
+            insert(channel);
+    }
+  }
+  root->walk([&](Operation *op) { insert(op); });
+}
+
+air::ChannelOp
+air::ChannelSymbolUses::getChannel(air::ChannelInterface op) const {
+  auto it = channels.find(op.getChanName());
+  if (it == channels.end())
+    return air::ChannelOp();
+  // The nearest symbol table declaring the symbol holds it
+  Operation *parent = op;
+  while ((parent = parent->getParentOp())) {
+    if (!parent->hasTrait<OpTrait::SymbolTable>())
+      continue;
+    for (auto channel : it->second)
+      if (channel->getParentOp() == parent)
+        return channel;
+  }
+  return air::ChannelOp();
+}
+
+// Keep the ops of a channel symbol under `scope`, if given
+template <typename T>
+static std::vector<T>
+getChannelOpsInScope(const llvm::StringMap<std::vector<T>> &ops,
+                     air::ChannelOp channel, Operation *scope,
+                     Operation *root) {
+  auto it = ops.find(channel.getSymName());
+  if (it == ops.end())
+    return {};
+  if (!scope || scope == root)
+    return it->second;
+  std::vector<T> inScope;
+  for (auto op : it->second)
+    if (scope->isProperAncestor(op))
+      inScope.push_back(op);
+  return inScope;
+}
+
+std::vector<air::ChannelPutOp>
+air::ChannelSymbolUses::getPuts(air::ChannelOp channel,
+                                Operation *scope) const {
+  return getChannelOpsInScope(puts, channel, scope, root);
+}
+
+std::vector<air::ChannelGetOp>
+air::ChannelSymbolUses::getGets(air::ChannelOp channel,
+                                Operation *scope) const {
+  return getChannelOpsInScope(gets, channel, scope, root);
+}
+
+void air::ChannelSymbolUses::insert(Operation *op) {
+  if (auto channel = dyn_cast<air::ChannelOp>(op))
+    channels[channel.getSymName()].push_back(channel);
+  else if (auto put = dyn_cast<air::ChannelPutOp>(op))
+    puts[put.getChanName()].push_back(put);
+  else if (auto get = dyn_cast<air::ChannelGetOp>(op))
+    gets[get.getChanName()].push_back(get);
+}
+
+// Remove an op from the ops of its channel symbol
+template <typename T>
+static void eraseChannelOp(llvm::StringMap<std::vector<T>> &ops,
+                           StringRef name, T op) {
+  auto it = ops.find(name);
+  if (it == ops.end())
+    return;
+  llvm::erase_value(it->second, op);
+}
+
+void air::ChannelSymbolUses::erase(Operation *op) {
+  if (auto channel = dyn_cast<air::ChannelOp>(op))
+    eraseChannelOp(channels, channel.getSymName(), channel);
+  else if (auto put = dyn_cast<air::ChannelPutOp>(op))
+    eraseChannelOp(puts, put.getChanName(), put);
+  else if (auto get = dyn_cast<air::ChannelGetOp>(op))
+    eraseChannelOp(gets, get.getChanName(), get);
+}
+
 // Get channel declaration through channel symbol
 air::ChannelOp
-air::getChannelDeclarationThroughSymbol(air::ChannelInterface op) {
+air::getChannelDeclarationThroughSymbol(air::ChannelInterface op,
+                                        const air::ChannelSymbolUses *uses) {
+  if (uses)
+    return uses->getChannel(op);
   Operation *parent = op;
   while (parent = parent->getParentOp()) {
     if (parent->hasTrait<OpTrait::SymbolTable>()) {
@@ -350,7 +445,11 @@ air::getChannelDeclarationThroughSymbol(air::ChannelInterface op) {
 
 // Get ChannelPutOp through ChannelOp
 std::vector<air::ChannelPutOp>
-air::getChannelPutOpThroughSymbol(air::ChannelOp channel, Operation *scope) {
+air::getChannelPutOpThroughSymbol(air::ChannelOp channel, Operation *scope,
+                                  const air::ChannelSymbolUses *uses) {
+
+  if (uses)
+    return uses->getPuts(channel, scope);
 
   if (!scope)
     scope = channel->getParentOfType<ModuleOp>();
@@ -372,7 +471,11 @@ air::getChannelPutOpThroughSymbol(air::ChannelOp channel, Operation *scope) {
 
 // Get ChannelGetOps through ChannelOp
 std::vector<air::ChannelGetOp>
-air::getChannelGetOpThroughSymbol(air::ChannelOp channel, Operation *scope) {
+air::getChannelGetOpThroughSymbol(air::ChannelOp channel, Operation *scope,
+                                  const air::ChannelSymbolUses *uses) {
+
+  if (uses)
+    return uses->getGets(channel, scope);
 
   if (!scope)
     scope = channel->getParentOfType<ModuleOp>();
@@ -394,18 +497,20 @@ air::getChannelGetOpThroughSymbol(air::ChannelOp channel, Operation *scope) {
 
 // Get the other channel op through channel symbol
 std::vector<air::ChannelGetOp>
-air::getTheOtherChannelOpThroughSymbol(air::ChannelPutOp put) {
+air::getTheOtherChannelOpThroughSymbol(air::ChannelPutOp put,
+                                       const air::ChannelSymbolUses *uses) {
   auto channel_op = getChannelDeclarationThroughSymbol(
-      dyn_cast<air::ChannelInterface>(put.getOperation()));
-  return getChannelGetOpThroughSymbol(channel_op);
+      dyn_cast<air::ChannelInterface>(put.getOperation()), uses);
+  return getChannelGetOpThroughSymbol(channel_op, nullptr, uses);
 }
 
 // Get the other channel op through channel symbol
 std::vector<air::ChannelPutOp>
-air::getTheOtherChannelOpThroughSymbol(air::ChannelGetOp get) {
+air::getTheOtherChannelOpThroughSymbol(air::ChannelGetOp get,
+                                       const air::ChannelSymbolUses *uses) {
   auto channel_op = getChannelDeclarationThroughSymbol(
-      dyn_cast<air::ChannelInterface>(get.getOperation()));
-  return getChannelPutOpThroughSymbol(channel_op);
+      dyn_cast<air::ChannelInterface>(get.getOperation()), uses);
+  return getChannelPutOpThroughSymbol(channel_op, nullptr, uses);
 }
 
 // Get sizes from integerset
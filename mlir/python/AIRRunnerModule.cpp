@@ -14,10 +14,98 @@
 #include "mlir/Bindings/Python/PybindAdaptors.h"
 
 #include <string>
+#include <vector>
 
 namespace xilinx {
 namespace air {
 
+namespace py = pybind11;
+
+namespace {
+
+std::string toString(MlirStringRef str) {
+  return std::string(str.data, str.length);
+}
+
+// Convert simulation results into a dict, freeing them
+py::dict toDict(AirRunnerResults results) {
+  py::dict output;
+  output["cycles"] = airRunnerResultsGetCycles(results);
+  output["latency_us"] = airRunnerResultsGetLatencyUs(results);
+  output["du_utilization"] = airRunnerResultsGetDuUtilization(results);
+  output["tile_utilization"] = airRunnerResultsGetTileUtilization(results);
+
+  py::list spans;
+  for (intptr_t i = 0; i < airRunnerResultsGetNumSpans(results); i++) {
+    auto span = airRunnerResultsGetSpan(results, i);
+    py::dict entry;
+    entry["name"] = toString(span.name);
+    entry["kind"] = toString(span.kind);
+    entry["id"] = span.id;
+    entry["instances"] = span.instances;
+    entry["start"] = span.start;
+    entry["end"] = span.end;
+    spans.append(entry);
+  }
+  output["spans"] = spans;
+
+  py::list resources;
+  for (intptr_t i = 0; i < airRunnerResultsGetNumResources(results); i++) {
+    auto resource = airRunnerResultsGetResource(results, i);
+    py::dict entry;
+    entry["name"] = toString(resource.name);
+    entry["kind"] = toString(resource.kind);
+    entry["busy_cycles"] = resource.busy_cycles;
+    resources.append(entry);
+  }
+  output["resources"] = resources;
+
+  py::list channels;
+  for (intptr_t i = 0; i < airRunnerResultsGetNumChannels(results); i++) {
+    auto channel = airRunnerResultsGetChannel(results, i);
+    py::dict entry;
+    entry["name"] = toString(channel.name);
+    entry["ops"] = channel.ops;
+    entry["stall_cycles"] = channel.stall_cycles;
+    channels.append(entry);
+  }
+  output["channels"] = channels;
+
+  std::string report;
+  airRunnerResultsPrintReport(
+      results,
+      [](MlirStringRef str, void *user_data) {
+        static_cast<std::string *>(user_data)->append(str.data, str.length);
+      },
+      &report);
+  output["report"] = report;
+
+  airRunnerResultsDestroy(results);
+  return output;
+}
+
+// Owns a session, destroying it with the python object
+class PySession {
+public:
+  PySession(AirRunnerSession session) : session(session) {}
+  PySession(const PySession &) = delete;
+  ~PySession() { airRunnerSessionDestroy(session); }
+
+  void invalidate(py::list changed_ops) {
+    std::vector<MlirOperation> ops;
+    for (auto op : changed_ops)
+      ops.push_back(op.cast<MlirOperation>());
+    airRunnerSessionInvalidate(session, ops.size(), ops.data());
+  }
+
+  py::dict simulate() { return toDict(airRunnerSessionSimulate(session)); }
+
+private:
+  AirRunnerSession session;
+};
+
+} // namespace
+
 void defineAIRRunnerModule(pybind11::module &m) {
   m.def("run",
         [](MlirModule module, std::string json, std::string outfile,
@@ -25,6 +113,46 @@ void defineAIRRunnerModule(pybind11::module &m) {
           airRunnerRun(module, json.c_str(), outfile.c_str(), function.c_str(),
                        sim_granularity.c_str(), verbose);
         });
+
+  // Simulate without touching the filesystem, unless a trace file is given,
+  // and return the results as a dict
+  m.def(
+      "simulate",
+      [](MlirModule module, std::string json_model, std::string function,
+         std::string sim_granularity, bool verbose,
+         std::string outfile) -> py::object {
+        auto results = airRunnerSimulate(
+            module, mlirStringRefCreate(json_model.data(), json_model.size()),
+            outfile.c_str(), function.c_str(), sim_granularity.c_str(),
+            verbose);
+        if (airRunnerResultsIsNull(results))
+          return py::none();
+        return toDict(results);
+      },
+      py::arg("module"), py::arg("json_model"), py::arg("function"),
+      py::arg("sim_granularity") = "herd", py::arg("verbose") = false,
+      py::arg("outfile") = "");
+
+  // Simulate a function repeatedly while editing it, re-simulating only the
+  // launches which changed
+  py::class_<PySession>(m, "Session")
+      .def("invalidate", &PySession::invalidate, py::arg("changed_ops"))
+      .def("simulate", &PySession::simulate);
+
+  m.def(
+      "session",
+      [](MlirModule module, std::string json_model, std::string function,
+         std::string sim_granularity) -> py::object {
+        auto session = airRunnerSessionCreate(
+            module, mlirStringRefCreate(json_model.data(), json_model.size()),
+            function.c_str(), sim_granularity.c_str());
+        if (airRunnerSessionIsNull(session))
+          return py::none();
+        return py::cast(new PySession(session),
+                        py::return_value_policy::take_ownership);
+      },
+      py::arg("module"), py::arg("json_model"), py::arg("function"),
+      py::arg("sim_granularity") = "herd");
 }
 
 } // namespace air
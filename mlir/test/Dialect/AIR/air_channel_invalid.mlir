@@ -0,0 +1,21 @@
+//===- air_channel_invalid.mlir --------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-opt %s -split-input-file -verify-diagnostics
+
+// expected-error@+1 {{'air.channel' op expects 'buffer_depth' to be a positive integer}}
+air.channel @channel_0 [1, 1] {buffer_depth = 0 : i64}
+
+// -----
+
+// expected-error@+1 {{'air.channel' op expects 'buffer_depth' to be a positive integer}}
+air.channel @channel_1 [1, 1] {buffer_depth = -2 : i64}
+
+// -----
+
+// expected-error@+1 {{'air.channel' op expects 'buffer_depth' to be a positive integer}}
+air.channel @channel_2 [1, 1] {buffer_depth = "2"}
@@ -0,0 +1,41 @@
+//===- disjoint_memref_regions.mlir ----------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-opt %s -air-dependency | FileCheck %s
+
+// Dependency tracing proves that the herd only reads the half of the buffer
+// written by the second dma, over all of its tiles.
+
+// CHECK-LABEL: func.func @disjoint_memref_regions
+// CHECK: %[[EVENT1:.*]] = air.dma_memcpy_nd async {{.*}}id = 1 : i32
+// CHECK: %[[EVENT2:.*]] = air.dma_memcpy_nd async {{.*}}id = 2 : i32
+// CHECK: air.herd async [%[[EVENT2]]]{{.*}}tile
+// CHECK: air.herd_terminator
+
+#map = affine_map<()[s0] -> (s0 * 64)>
+module {
+  func.func @disjoint_memref_regions(%arg0: memref<256xi32>) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c2 = arith.constant 2 : index
+    %c128 = arith.constant 128 : index
+    %0 = memref.alloc() : memref<256xi32, 1>
+    air.dma_memcpy_nd (%0[%c128] [%c128] [%c1], %arg0[%c128] [%c128] [%c1]) {id = 1 : i32} : (memref<256xi32, 1>, memref<256xi32>)
+    air.dma_memcpy_nd (%0[%c0] [%c128] [%c1], %arg0[%c0] [%c128] [%c1]) {id = 2 : i32} : (memref<256xi32, 1>, memref<256xi32>)
+    air.herd tile (%arg1, %arg2) in (%arg3=%c2, %arg4=%c1) args(%arg5=%0) : memref<256xi32, 1> {
+      %c1_0 = arith.constant 1 : index
+      %c64 = arith.constant 64 : index
+      %1 = affine.apply #map()[%arg1]
+      %2 = memref.alloc() : memref<64xi32, 2>
+      air.dma_memcpy_nd (%2[] [] [], %arg5[%1] [%c64] [%c1_0]) {id = 3 : i32} : (memref<64xi32, 2>, memref<256xi32, 1>)
+      memref.dealloc %2 : memref<64xi32, 2>
+      air.herd_terminator
+    }
+    memref.dealloc %0 : memref<256xi32, 1>
+    return
+  }
+}
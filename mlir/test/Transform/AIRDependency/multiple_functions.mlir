@@ -0,0 +1,53 @@
+//===- multiple_functions.mlir ---------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-opt %s -air-dependency | FileCheck %s
+// RUN: air-opt %s -air-dependency -mlir-disable-threading | FileCheck %s
+
+// Each function is traced on its own, with its own dependency graph and event
+// ids, whether or not functions are traced concurrently: the executes created
+// in each function are numbered from 1.
+
+// CHECK-LABEL: func.func @first
+// CHECK: %[[EVENT0:.*]], %[[VALUE0:.*]] = air.execute
+// CHECK-NEXT: memref.alloc()
+// CHECK-NEXT: air.execute_terminator
+// CHECK-NEXT: } {id = 1 : i32}
+// CHECK: %[[DMA0:.*]] = air.dma_memcpy_nd async [%[[EVENT0]]]{{.*}}id = 1 : i32
+// CHECK: air.execute [{{.*}}%[[DMA0]]{{.*}}]
+// CHECK-NEXT: memref.dealloc %[[VALUE0]]
+// CHECK-NEXT: } {id = 2 : i32}
+// CHECK-LABEL: func.func @second
+// CHECK: %[[EVENT1:.*]], %[[VALUE1:.*]] = air.execute
+// CHECK-NEXT: memref.alloc()
+// CHECK-NEXT: air.execute_terminator
+// CHECK-NEXT: } {id = 1 : i32}
+// CHECK: %[[DMA1:.*]] = air.dma_memcpy_nd async [%[[EVENT1]]]{{.*}}id = 1 : i32
+// CHECK: air.execute [{{.*}}%[[DMA1]]{{.*}}]
+// CHECK-NEXT: memref.dealloc %[[VALUE1]]
+// CHECK-NEXT: } {id = 2 : i32}
+
+module {
+  func.func @first(%arg0: memref<64xi32>) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c64 = arith.constant 64 : index
+    %0 = memref.alloc() : memref<64xi32, 1>
+    air.dma_memcpy_nd (%0[%c0] [%c64] [%c1], %arg0[%c0] [%c64] [%c1]) {id = 1 : i32} : (memref<64xi32, 1>, memref<64xi32>)
+    memref.dealloc %0 : memref<64xi32, 1>
+    return
+  }
+  func.func @second(%arg0: memref<64xi32>) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c64 = arith.constant 64 : index
+    %0 = memref.alloc() : memref<64xi32, 1>
+    air.dma_memcpy_nd (%0[%c0] [%c64] [%c1], %arg0[%c0] [%c64] [%c1]) {id = 1 : i32} : (memref<64xi32, 1>, memref<64xi32>)
+    memref.dealloc %0 : memref<64xi32, 1>
+    return
+  }
+}
@@ -0,0 +1,55 @@
+//===- fluid.mlir ----------------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch.json --trace-level=none -o %t.json --report=json --report-file=%t.fixed
+// RUN: FileCheck %s --check-prefix=FIXED --input-file=%t.fixed
+// RUN: air-runner %s -f test -m %S/arch_fluid.json --trace-level=none -o %t.json --report=json --report-file=%t.fluid
+// RUN: FileCheck %s --check-prefix=FLUID --input-file=%t.fluid
+
+// Two concurrent 2KB L3 to L2 transfers issued by the same segment, over a
+// single port of 100 bytes per cycle. Each takes 21 cycles at the full rate of
+// the port, and 41 cycles when they share its bandwidth.
+
+// FIXED: "memories": [
+// FIXED: "ops": [
+// FIXED: "cycles": 42,
+// FIXED-NEXT: "instances": 2,
+// FIXED-NEXT: "name": "DmaMemcpyNdOp"
+
+// FLUID: "memories": [
+// FLUID: "ops": [
+// FLUID: "cycles": 82,
+// FLUID-NEXT: "instances": 2,
+// FLUID-NEXT: "name": "DmaMemcpyNdOp"
+
+module {
+  func.func @test(%arg0: memref<64x64xbf16>) {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg1, %arg2) in (%arg3=%c1, %arg4=%c1) args(%arg5=%arg0) : memref<64x64xbf16> attributes {id = 1 : i32} {
+      %1 = air.segment async  args(%arg6=%arg5) : memref<64x64xbf16> attributes {id = 2 : i32, x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c0 = arith.constant 0 : index
+        %c1_0 = arith.constant 1 : index
+        %c32 = arith.constant 32 : index
+        %c64 = arith.constant 64 : index
+        %async_token, %results = air.execute -> (memref<32x32xbf16, 1>) {
+          %alloc = memref.alloc() : memref<32x32xbf16, 1>
+          air.execute_terminator %alloc : memref<32x32xbf16, 1>
+        }
+        %async_token_1, %results_2 = air.execute -> (memref<32x32xbf16, 1>) {
+          %alloc = memref.alloc() : memref<32x32xbf16, 1>
+          air.execute_terminator %alloc : memref<32x32xbf16, 1>
+        }
+        %2 = air.dma_memcpy_nd async [%async_token] (%results[] [] [], %arg6[%c0, %c0] [%c32, %c32] [%c64, %c1_0]) : (memref<32x32xbf16, 1>, memref<64x64xbf16>)
+        %3 = air.dma_memcpy_nd async [%async_token_1] (%results_2[] [] [], %arg6[%c32, %c0] [%c32, %c32] [%c64, %c1_0]) : (memref<32x32xbf16, 1>, memref<64x64xbf16>)
+        %4 = air.wait_all async [%2, %3]
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+}
@@ -0,0 +1,109 @@
+//===- ports.mlir ----------------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f separate -m %S/arch_fluid.json --trace-level=none -o %t.json --report=json --report-file=%t.separate
+// RUN: FileCheck %s --check-prefix=SEPARATE --input-file=%t.separate
+// RUN: air-runner %s -f shared -m %S/arch_fluid.json --trace-level=none -o %t.json --report=json --report-file=%t.shared
+// RUN: FileCheck %s --check-prefix=SHARED --input-file=%t.shared
+
+// Concurrent 1KB L2 to L1 transfers, at 100 bytes per cycle per port. In
+// @separate, each is issued by its own herd, and goes through the port of
+// that herd's tile, so neither slows the other: each takes 11 cycles. In
+// @shared, both are issued by the same herd and share its tile's port, taking
+// 21 cycles.
+
+// SEPARATE: "memories": [
+// SEPARATE: "ops": [
+// SEPARATE: "cycles": 22,
+// SEPARATE-NEXT: "instances": 2,
+// SEPARATE-NEXT: "name": "DmaMemcpyNdOp"
+
+// SHARED: "memories": [
+// SHARED: "ops": [
+// SHARED: "cycles": 42,
+// SHARED-NEXT: "instances": 2,
+// SHARED-NEXT: "name": "DmaMemcpyNdOp"
+
+module {
+  func.func @separate() {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg0, %arg1) in (%arg2=%c1, %arg3=%c1) attributes {id = 1 : i32} {
+      %1 = air.segment async  attributes {id = 2 : i32, x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c1_0 = arith.constant 1 : index
+        %async_token, %results = air.execute -> (memref<16x32xbf16, 1>) {
+          %alloc = memref.alloc() : memref<16x32xbf16, 1>
+          air.execute_terminator %alloc : memref<16x32xbf16, 1>
+        }
+        %2 = air.herd @herd_0 async [%async_token]  tile (%arg4, %arg5) in (%arg6=%c1_0, %arg7=%c1_0) args(%arg8=%results) : memref<16x32xbf16, 1> attributes {id = 3 : i32} {
+          %async_token_1, %results_2 = air.execute -> (memref<16x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<16x32xbf16, 2>
+            air.execute_terminator %alloc : memref<16x32xbf16, 2>
+          }
+          %4 = air.dma_memcpy_nd async [%async_token_1] (%results_2[] [] [], %arg8[] [] []) : (memref<16x32xbf16, 2>, memref<16x32xbf16, 1>)
+          %async_token_3 = air.execute [%4] {
+            memref.dealloc %results_2 : memref<16x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        %3 = air.herd @herd_1 async [%async_token]  tile (%arg4, %arg5) in (%arg6=%c1_0, %arg7=%c1_0) args(%arg8=%results) : memref<16x32xbf16, 1> attributes {id = 4 : i32} {
+          %async_token_1, %results_2 = air.execute -> (memref<16x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<16x32xbf16, 2>
+            air.execute_terminator %alloc : memref<16x32xbf16, 2>
+          }
+          %4 = air.dma_memcpy_nd async [%async_token_1] (%results_2[] [] [], %arg8[] [] []) : (memref<16x32xbf16, 2>, memref<16x32xbf16, 1>)
+          %async_token_3 = air.execute [%4] {
+            memref.dealloc %results_2 : memref<16x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        %async_token_4 = air.execute [%2, %3] {
+          memref.dealloc %results : memref<16x32xbf16, 1>
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+  func.func @shared() {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg0, %arg1) in (%arg2=%c1, %arg3=%c1) attributes {id = 1 : i32} {
+      %1 = air.segment async  attributes {id = 2 : i32, x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c1_0 = arith.constant 1 : index
+        %async_token, %results = air.execute -> (memref<16x32xbf16, 1>) {
+          %alloc = memref.alloc() : memref<16x32xbf16, 1>
+          air.execute_terminator %alloc : memref<16x32xbf16, 1>
+        }
+        %2 = air.herd @herd_0 async [%async_token]  tile (%arg4, %arg5) in (%arg6=%c1_0, %arg7=%c1_0) args(%arg8=%results) : memref<16x32xbf16, 1> attributes {id = 3 : i32} {
+          %async_token_1, %results_2 = air.execute -> (memref<16x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<16x32xbf16, 2>
+            air.execute_terminator %alloc : memref<16x32xbf16, 2>
+          }
+          %async_token_3, %results_4 = air.execute -> (memref<16x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<16x32xbf16, 2>
+            air.execute_terminator %alloc : memref<16x32xbf16, 2>
+          }
+          %3 = air.dma_memcpy_nd async [%async_token_1] (%results_2[] [] [], %arg8[] [] []) : (memref<16x32xbf16, 2>, memref<16x32xbf16, 1>)
+          %4 = air.dma_memcpy_nd async [%async_token_3] (%results_4[] [] [], %arg8[] [] []) : (memref<16x32xbf16, 2>, memref<16x32xbf16, 1>)
+          %async_token_5 = air.execute [%3] {
+            memref.dealloc %results_2 : memref<16x32xbf16, 2>
+          }
+          %async_token_6 = air.execute [%4] {
+            memref.dealloc %results_4 : memref<16x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        %async_token_7 = air.execute [%2] {
+          memref.dealloc %results : memref<16x32xbf16, 1>
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+}
@@ -0,0 +1,70 @@
+//===- calibration.mlir ----------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/measured_arch.json --trace-level=none -o %t.trace --op-cycles-file=%t.csv
+// RUN: FileCheck %s --check-prefix=CSV < %t.csv
+// RUN: air-runner %s -f test -m %S/../arch.json --calibrate=%t.csv | FileCheck %s
+
+// Test fitting a json model to op cycles measured with a model whose
+// linalg.matmul runs at half efficiency.
+
+// CSV: op,instances,cycles
+// CSV: LinalgOp(linalg.matmul),{{[0-9]+}},512.000
+
+// CHECK: "linalg.matmul": {
+// CHECK-NEXT: "datatypes": {
+// CHECK-NEXT: "bf16": {
+// CHECK-NEXT: "efficiency": 0.5,
+// CHECK-NEXT: "ops_per_core_per_cycle": 8
+// CHECK-NEXT: },
+// CHECK-NEXT: "f32": {
+// CHECK-NEXT: "efficiency": 1,
+
+module {
+  func.func @test(%arg0: memref<256x1024xbf16>, %arg1: memref<1024x1024xbf16>, %arg2: memref<1024x1024xbf16>, %arg3: memref<1024x1024xbf16>) -> memref<256x1024xbf16> {
+    %c1 = arith.constant 1 : index
+    %async_token_1, %results_2 = air.execute -> (memref<256x1024xbf16>) {
+      %alloc = memref.alloc() {alignment = 128 : i64} : memref<256x1024xbf16>
+      air.execute_terminator %alloc : memref<256x1024xbf16>
+    }
+    %0 = air.launch async [%async_token_1] (%arg4, %arg5) in (%arg6=%c1, %arg7=%c1) args(%arg8=%arg0, %arg9=%arg1) : memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {id = 7 : i32} {
+      %1 = air.segment async  args(%arg15=%arg4, %arg16=%arg5, %arg17=%arg6, %arg18=%arg7, %arg19=%arg8, %arg20=%arg9) : index, index, index, index, memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c4 = arith.constant 4 : index
+        %2 = air.herd @herd_0 async tile (%arg21, %arg22) in (%arg23=%c4, %arg24=%c4) {
+          %async_token_3, %results_4 = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_5, %results_6 = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_7, %results_8 = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_9 = air.execute [%async_token_5, %async_token_7] {
+            linalg.matmul ins(%results_4, %results_6 : memref<32x32xbf16, 2>, memref<32x32xbf16, 2>) outs(%results_8 : memref<32x32xbf16, 2>)
+          }
+          %async_token_10 = air.execute [%async_token_9] {
+            memref.dealloc %results_4 : memref<32x32xbf16, 2>
+          }
+          %async_token_11 = air.execute [%async_token_9] {
+            memref.dealloc %results_6 : memref<32x32xbf16, 2>
+          }
+          %async_token_12 = air.execute [%async_token_9] {
+            memref.dealloc %results_8 : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return %results_2 : memref<256x1024xbf16>
+  }
+}
@@ -0,0 +1,144 @@
+//===- channel_buffer_depth.mlir -------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch.json --trace-format=compact -o %t.json --report=json --report-file=%t.report
+// RUN: FileCheck %s --input-file=%t.report
+// RUN: FileCheck %s --input-file=%t.json --check-prefix=BUF
+// RUN: FileCheck %s --input-file=%t.json --check-prefix=UNBUF
+
+// Channels holding several transfers in their FIFOs, and the occupancy of
+// each channel in the report. Puts take a cycle and gets take hundreds, so
+// the puts to the buffered channel fill its FIFO before its first get ends,
+// and its occupancy climbs to its depth and drains back one transfer at a
+// time. The unbuffered channel holds one transfer at most. Both channels are
+// tracked over the whole launch, so the cycles at each of their occupancies
+// add up to the launch's span.
+
+// CHECK: "channel_occupancy": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "cycles": [
+// CHECK-NEXT: [
+// CHECK-NEXT: {{^ *}}0,
+// CHECK-NEXT: [[#B0:]]
+// CHECK-NEXT: ],
+// CHECK-NEXT: [
+// CHECK-NEXT: {{^ *}}1,
+// CHECK-NEXT: [[#B1:]]
+// CHECK-NEXT: ],
+// CHECK-NEXT: [
+// CHECK-NEXT: {{^ *}}2,
+// CHECK-NEXT: [[#B2:]]
+// CHECK-NEXT: ],
+// CHECK-NEXT: [
+// CHECK-NEXT: {{^ *}}3,
+// CHECK-NEXT: [[#B3:]]
+// CHECK-NEXT: ],
+// CHECK-NEXT: [
+// CHECK-NEXT: {{^ *}}4,
+// CHECK-NEXT: [[#B4:]]
+// CHECK-NEXT: ]
+// CHECK-NEXT: ],
+// CHECK-NEXT: "depth": 4,
+// CHECK-NEXT: "name": "channel_buffered",
+// CHECK-NEXT: "peak": 4
+// CHECK-NEXT: },
+// CHECK-NEXT: {
+// CHECK-NEXT: "cycles": [
+// CHECK-NEXT: [
+// CHECK-NEXT: {{^ *}}0,
+// CHECK-NEXT: [[#U0:]]
+// CHECK-NEXT: ],
+// CHECK-NEXT: [
+// CHECK-NEXT: {{^ *}}1,
+// CHECK-NEXT: [[#B0+B1+B2+B3+B4-U0]]
+// CHECK-NEXT: ]
+// CHECK-NEXT: ],
+// CHECK-NEXT: "depth": 1,
+// CHECK-NEXT: "name": "channel_unbuffered",
+// CHECK-NEXT: "peak": 1
+
+// CHECK: "spans": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "end": [[#END:]],
+// CHECK-NEXT: "instances": 1,
+// CHECK-NEXT: "kind": "launch",
+// CHECK-NEXT: "name": "air.launch",
+// CHECK-NEXT: "start": [[#END-B0-B1-B2-B3-B4]]
+
+// All four puts to the buffered channel end before any of its gets
+// BUF-NOT: "name":"ChannelGetOp@channel_buffered{{.*}}"ph":"E"
+// BUF: "name":"ChannelPutOp@channel_buffered{{.*}}"ph":"E"
+// BUF-NOT: "name":"ChannelGetOp@channel_buffered{{.*}}"ph":"E"
+// BUF: "name":"ChannelPutOp@channel_buffered{{.*}}"ph":"E"
+// BUF-NOT: "name":"ChannelGetOp@channel_buffered{{.*}}"ph":"E"
+// BUF: "name":"ChannelPutOp@channel_buffered{{.*}}"ph":"E"
+// BUF-NOT: "name":"ChannelGetOp@channel_buffered{{.*}}"ph":"E"
+// BUF: "name":"ChannelPutOp@channel_buffered{{.*}}"ph":"E"
+// BUF: "name":"ChannelGetOp@channel_buffered{{.*}}"ph":"E"
+
+// Each put to the unbuffered channel starts after the get of the previous
+// transfer ended
+// UNBUF: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF-NOT: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF: "name":"ChannelGetOp@channel_unbuffered{{.*}}"ph":"E"
+// UNBUF: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF-NOT: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF: "name":"ChannelGetOp@channel_unbuffered{{.*}}"ph":"E"
+// UNBUF: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF-NOT: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF: "name":"ChannelGetOp@channel_unbuffered{{.*}}"ph":"E"
+// UNBUF: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF-NOT: "name":"ChannelPutOp@channel_unbuffered{{.*}}"ph":"B"
+// UNBUF: "name":"ChannelGetOp@channel_unbuffered{{.*}}"ph":"E"
+
+module {
+  air.channel @channel_buffered [1, 1] {buffer_depth = 4 : i64}
+  air.channel @channel_unbuffered [1, 1]
+  func.func @test(%arg0: memref<256x256xbf16>, %arg1: memref<256x256xbf16>) {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg2, %arg3) in (%arg4=%c1, %arg5=%c1) args(%arg6=%arg0, %arg7=%arg1) : memref<256x256xbf16>, memref<256x256xbf16> {
+      %c0 = arith.constant 0 : index
+      %c1_0 = arith.constant 1 : index
+      %c64 = arith.constant 64 : index
+      %c256 = arith.constant 256 : index
+      %1 = air.wait_all async
+      %2 = scf.for %arg8 = %c0 to %c256 step %c64 iter_args(%arg9 = %1) -> (!air.async.token) {
+        %5 = air.channel.put async [%arg9]  @channel_buffered[] (%arg6[%arg8, %c0] [%c64, %c256] [%c256, %c1_0]) : (memref<256x256xbf16>)
+        scf.yield %5 : !air.async.token
+      }
+      %3 = scf.for %arg8 = %c0 to %c256 step %c64 iter_args(%arg9 = %1) -> (!air.async.token) {
+        %5 = air.channel.put async [%arg9]  @channel_unbuffered[] (%arg7[%arg8, %c0] [%c64, %c256] [%c256, %c1_0]) : (memref<256x256xbf16>)
+        scf.yield %5 : !air.async.token
+      }
+      %4 = air.segment async attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c0_1 = arith.constant 0 : index
+        %c64_2 = arith.constant 64 : index
+        %c256_3 = arith.constant 256 : index
+        %cst = arith.constant 0.000000e+00 : bf16
+        %5 = air.wait_all async
+        %6 = scf.for %arg8 = %c0_1 to %c256_3 step %c64_2 iter_args(%arg9 = %5) -> (!air.async.token) {
+          %async_token, %results = air.execute [%arg9] -> (memref<64x256xbf16, 1>) {
+            %alloc = memref.alloc() : memref<64x256xbf16, 1>
+            air.execute_terminator %alloc : memref<64x256xbf16, 1>
+          }
+          %7 = air.channel.get async [%async_token]  @channel_buffered[] (%results[] [] []) : (memref<64x256xbf16, 1>)
+          %8 = air.channel.get async [%7]  @channel_unbuffered[] (%results[] [] []) : (memref<64x256xbf16, 1>)
+          %async_token_4 = air.execute [%8] {
+            linalg.fill ins(%cst : bf16) outs(%results : memref<64x256xbf16, 1>)
+          }
+          %async_token_5 = air.execute [%async_token_4] {
+            memref.dealloc %results : memref<64x256xbf16, 1>
+          }
+          scf.yield %async_token_5 : !air.async.token
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+}
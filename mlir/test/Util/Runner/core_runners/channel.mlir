@@ -6,8 +6,11 @@
 //===----------------------------------------------------------------------===//
 
 // RUN: air-runner %s -f test -m %S/../arch.json -g core | FileCheck %s
+// RUN: air-runner %s -f test -m %S/../arch.json -g core --fold-cores | FileCheck %s
 
-// Air channel ops, running each core in a herd
+// Air channel ops, running each core in a herd. The herd's cores are
+// symmetric, so with --fold-cores one core is simulated and its events are
+// replayed on the others.
 
 // CHECK-COUNT-4096: "name": "ChannelGetOp@channel_1(L1<--L2)",
 
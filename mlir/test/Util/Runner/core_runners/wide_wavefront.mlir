@@ -0,0 +1,128 @@
+//===- wide_wavefront.mlir -------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/../arch.json -g core --trace-format=compact | FileCheck %s
+// RUN: air-runner %s -f test -m %S/../arch.json -g core --trace-format=compact | FileCheck %s --check-prefix=NOT
+
+// Twelve ops running at once on each core of a 2x1 herd. The first ten take
+// the trace threads of their core, the others go to the next page of threads,
+// after those of both cores, which is named in the trace metadata.
+
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":1},
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":10},
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":11},
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":20},
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":21},
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":22},
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":31},
+// CHECK-DAG: "name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B",{{.*}}"tid":32},
+// CHECK-DAG: {"name":"thread_name","ph":"M",{{.*}}"tid":21,"args":{"name":"core [0,0] page 2"}},
+// CHECK-DAG: {"name":"thread_name","ph":"M",{{.*}}"tid":31,"args":{"name":"core [1,0] page 2"}},
+// CHECK-DAG: {"name":"thread_sort_index","ph":"M",{{.*}}"tid":30,
+// NOT-NOT: "name":"AllocOp(L1, 1024, bf16)",{{.*}}"tid":{{(0|23|33)}}},
+
+module {
+  func.func @test() {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg0, %arg1) in (%arg2=%c1, %arg3=%c1) {
+      %1 = air.segment async attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c2 = arith.constant 2 : index
+        %c1_0 = arith.constant 1 : index
+        %2 = air.herd @herd_0 async tile (%arg4, %arg5) in (%arg6=%c2, %arg7=%c1_0) {
+            %async_token_0, %results_0 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_1, %results_1 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_2, %results_2 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_3, %results_3 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_4, %results_4 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_5, %results_5 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_6, %results_6 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_7, %results_7 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_8, %results_8 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_9, %results_9 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_10, %results_10 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_11, %results_11 = air.execute -> (memref<32x32xbf16, 2>) {
+              %alloc = memref.alloc() : memref<32x32xbf16, 2>
+              air.execute_terminator %alloc : memref<32x32xbf16, 2>
+            }
+            %async_token_12 = air.execute [%async_token_0] {
+              memref.dealloc %results_0 : memref<32x32xbf16, 2>
+            }
+            %async_token_13 = air.execute [%async_token_1] {
+              memref.dealloc %results_1 : memref<32x32xbf16, 2>
+            }
+            %async_token_14 = air.execute [%async_token_2] {
+              memref.dealloc %results_2 : memref<32x32xbf16, 2>
+            }
+            %async_token_15 = air.execute [%async_token_3] {
+              memref.dealloc %results_3 : memref<32x32xbf16, 2>
+            }
+            %async_token_16 = air.execute [%async_token_4] {
+              memref.dealloc %results_4 : memref<32x32xbf16, 2>
+            }
+            %async_token_17 = air.execute [%async_token_5] {
+              memref.dealloc %results_5 : memref<32x32xbf16, 2>
+            }
+            %async_token_18 = air.execute [%async_token_6] {
+              memref.dealloc %results_6 : memref<32x32xbf16, 2>
+            }
+            %async_token_19 = air.execute [%async_token_7] {
+              memref.dealloc %results_7 : memref<32x32xbf16, 2>
+            }
+            %async_token_20 = air.execute [%async_token_8] {
+              memref.dealloc %results_8 : memref<32x32xbf16, 2>
+            }
+            %async_token_21 = air.execute [%async_token_9] {
+              memref.dealloc %results_9 : memref<32x32xbf16, 2>
+            }
+            %async_token_22 = air.execute [%async_token_10] {
+              memref.dealloc %results_10 : memref<32x32xbf16, 2>
+            }
+            %async_token_23 = air.execute [%async_token_11] {
+              memref.dealloc %results_11 : memref<32x32xbf16, 2>
+            }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+}
@@ -0,0 +1,68 @@
+//===- compute_cost_cache.mlir ---------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch_roofline.json --full-sim --trace-level=none -o %t.json --report=json --report-file=%t.report
+// RUN: FileCheck %s --input-file=%t.report
+
+// The cost of each linalg op is modelled once. Its instances in the later
+// iterations of the air.launch find it in the compute cost cache.
+
+// CHECK: "simulation": {
+// CHECK-NEXT: "compute_cost_hits": {{[1-9][0-9]*}},
+// CHECK-NEXT: "compute_cost_misses": 2
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+module {
+  func.func @test(%arg0: memref<256x1024xi32>, %arg1: memref<1024x1024xi32>, %arg2: memref<1024x1024xi32>, %arg3: memref<1024x1024xi32>) -> memref<256x1024xi32> {
+    %c2 = arith.constant 2 : index
+    %async_token_1, %results_2 = air.execute -> (memref<256x1024xi32>) {
+      %alloc = memref.alloc() {alignment = 128 : i64} : memref<256x1024xi32>
+      air.execute_terminator %alloc : memref<256x1024xi32>
+    }
+    %0 = air.launch async [%async_token_1] (%arg4, %arg5) in (%arg6=%c2, %arg7=%c2) args(%arg8=%arg0, %arg9=%arg1) : memref<256x1024xi32>, memref<1024x1024xi32> attributes {id = 7 : i32} {
+      %1 = air.segment async  args(%arg15=%arg4, %arg16=%arg5, %arg17=%arg6, %arg18=%arg7, %arg19=%arg8, %arg20=%arg9) : index, index, index, index, memref<256x1024xi32>, memref<1024x1024xi32> attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c4 = arith.constant 4 : index
+        %2 = air.herd @herd_0 async tile (%arg21, %arg22) in (%arg23=%c4, %arg24=%c4) {
+          %cst_8 = arith.constant 2 : i32
+          %cst_9 = arith.constant 1 : i32
+          %cst_10 = arith.constant 1 : i32
+          %async_token_3, %results_4 = air.execute -> (memref<32x32xi32, 2>) {
+            %alloc = memref.alloc() : memref<32x32xi32, 2>
+            air.execute_terminator %alloc : memref<32x32xi32, 2>
+          }
+          %async_token_5, %results_6 = air.execute -> (memref<32x32xi32, 2>) {
+            %alloc = memref.alloc() : memref<32x32xi32, 2>
+            air.execute_terminator %alloc : memref<32x32xi32, 2>
+          }
+          %async_token_12 = air.execute [%async_token_3] {
+            linalg.fill ins(%cst_9 : i32) outs(%results_4 : memref<32x32xi32, 2>)
+          }
+          %async_token_7 = air.execute [%async_token_12, %async_token_5] {
+            linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%results_4 : memref<32x32xi32, 2>) outs(%results_6 : memref<32x32xi32, 2>) {
+            ^bb0(%in: i32, %out: i32):
+              %9 = arith.divsi %in, %cst_8 : i32
+              %11 = arith.addi %9, %cst_9 : i32
+              %12 = arith.muli %11, %cst_10 : i32
+              %13 = arith.muli %in, %12 : i32
+              linalg.yield %13 : i32
+            }
+          }
+          %async_token_10 = air.execute [%async_token_7] {
+            memref.dealloc %results_4 : memref<32x32xi32, 2>
+          }
+          %async_token_11 = air.execute [%async_token_7] {
+            memref.dealloc %results_6 : memref<32x32xi32, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return %results_2 : memref<256x1024xi32>
+  }
+}
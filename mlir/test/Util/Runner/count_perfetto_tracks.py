@@ -0,0 +1,57 @@
+# Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+# SPDX-License-Identifier: MIT
+
+# Count the track descriptors of a Perfetto trace written by air-runner, and
+# the tracks described more than once.
+
+import sys
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def read_fields(data):
+    pos = 0
+    while pos < len(data):
+        key, pos = read_varint(data, pos)
+        field, wire_type = key >> 3, key & 7
+        if wire_type == 0:
+            value, pos = read_varint(data, pos)
+        elif wire_type == 2:
+            length, pos = read_varint(data, pos)
+            value = data[pos : pos + length]
+            pos += length
+        else:
+            sys.exit("unexpected wire type %d" % wire_type)
+        yield field, value
+
+
+TRACE_PACKET = 1
+PACKET_TRACK_DESCRIPTOR = 60
+DESCRIPTOR_UUID = 1
+
+with open(sys.argv[1], "rb") as f:
+    trace = f.read()
+
+uuids = []
+for field, packet in read_fields(trace):
+    if field != TRACE_PACKET:
+        continue
+    for packet_field, descriptor in read_fields(packet):
+        if packet_field != PACKET_TRACK_DESCRIPTOR:
+            continue
+        for descriptor_field, uuid in read_fields(descriptor):
+            if descriptor_field == DESCRIPTOR_UUID:
+                uuids.append(uuid)
+
+print("descriptors: %d" % len(uuids))
+print("duplicates: %d" % (len(uuids) - len(set(uuids))))
@@ -0,0 +1,119 @@
+//===- launch_steady_state.mlir --------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch.json -o %t.json --report=json --report-file=%t.report
+// RUN: air-runner %s -f test -m %S/arch.json --full-sim -o %t.full.json --report=json --report-file=%t.full.report
+// RUN: diff %t.json %t.full.json
+// RUN: FileCheck %s --input-file=%t.json
+// RUN: FileCheck %s --check-prefix=REPORT --input-file=%t.report
+// RUN: FileCheck %s --check-prefix=FULL --input-file=%t.full.report
+// RUN: air-runner %s -f leak -m %S/arch.json -o %t.leak.json --report=json --report-file=%t.leak.report
+// RUN: air-runner %s -f leak -m %S/arch.json --full-sim -o %t.leak.full.json
+// RUN: diff %t.leak.json %t.leak.full.json
+// RUN: FileCheck %s --check-prefix=LEAK --input-file=%t.leak.report
+
+// Iterations of an air.launch past the steady state are extrapolated; the
+// trace must match full simulation of every iteration.
+
+// CHECK-COUNT-32: "name": "LaunchTerminator",
+
+// The report gives the iterations which were fast-forwarded, each taking one
+// period, which is only non-zero once a steady state was reached. The L1
+// footprint changes of the last simulated iteration are recorded once, with
+// the number of fast-forwarded iterations repeating them.
+
+// REPORT: "memories": [
+// REPORT: "repeats": [{{$}}
+// REPORT-NEXT: {
+// REPORT-NEXT: "begin": {{[0-9]+}},
+// REPORT-NEXT: "count": [[#FF:]],
+// REPORT-NEXT: "end": {{[1-9][0-9]*}},
+// REPORT-NEXT: "period": [[#PERIOD:]]
+// REPORT: "launches": [
+// REPORT-NEXT: {
+// REPORT-NEXT: "fast_forwarded_iterations": [[#FF]],
+// REPORT-NEXT: "id": 7,
+// REPORT-NEXT: "iterations": 16,
+// REPORT-NEXT: "name": "air.launch",
+// REPORT-NEXT: "period_cycles": [[#PERIOD]],
+// REPORT-NEXT: "replayed": false,
+// REPORT-NEXT: "simulated_iterations": [[#16 - FF]]
+
+// FULL-NOT: "repeats": [{{$}}
+// FULL: "launches": [
+// FULL-NEXT: {
+// FULL-NEXT: "fast_forwarded_iterations": 0,
+// FULL-NEXT: "id": 7,
+// FULL-NEXT: "iterations": 16,
+// FULL-NEXT: "name": "air.launch",
+// FULL-NEXT: "period_cycles": 0,
+// FULL-NEXT: "replayed": false,
+// FULL-NEXT: "simulated_iterations": 16
+
+// Each iteration of @leak leaves one more L1 buffer allocated, so no two
+// iterations leave the device in the same state and every iteration must be
+// simulated.
+
+// LEAK: "launches": [
+// LEAK-NEXT: {
+// LEAK-NEXT: "fast_forwarded_iterations": 0,
+// LEAK-NEXT: "id": 8,
+// LEAK-NEXT: "iterations": 16,
+// LEAK-NEXT: "name": "air.launch",
+// LEAK-NEXT: "period_cycles": 0,
+// LEAK-NEXT: "replayed": false,
+// LEAK-NEXT: "simulated_iterations": 16
+
+module {
+  func.func @test(%arg0: memref<256x1024xbf16>, %arg1: memref<1024x1024xbf16>) -> memref<256x1024xbf16> {
+    %c4 = arith.constant 4 : index
+    %async_token_1, %results_2 = air.execute -> (memref<256x1024xbf16>) {
+      %alloc = memref.alloc() {alignment = 128 : i64} : memref<256x1024xbf16>
+      air.execute_terminator %alloc : memref<256x1024xbf16>
+    }
+    %0 = air.launch async [%async_token_1] (%arg4, %arg5) in (%arg6=%c4, %arg7=%c4) args(%arg8=%arg0, %arg9=%arg1) : memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {id = 7 : i32} {
+      %1 = air.segment async  args(%arg15=%arg4, %arg16=%arg5, %arg17=%arg6, %arg18=%arg7, %arg19=%arg8, %arg20=%arg9) : index, index, index, index, memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c2 = arith.constant 2 : index
+        %2 = air.herd @herd_0 async tile (%arg21, %arg22) in (%arg23=%c2, %arg24=%c2) {
+          %async_token_3, %results_4 = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_5 = air.execute [%async_token_3] {
+            memref.dealloc %results_4 : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return %results_2 : memref<256x1024xbf16>
+  }
+  func.func @leak(%arg0: memref<256x1024xbf16>, %arg1: memref<1024x1024xbf16>) -> memref<256x1024xbf16> {
+    %c4 = arith.constant 4 : index
+    %async_token_1, %results_2 = air.execute -> (memref<256x1024xbf16>) {
+      %alloc = memref.alloc() {alignment = 128 : i64} : memref<256x1024xbf16>
+      air.execute_terminator %alloc : memref<256x1024xbf16>
+    }
+    %0 = air.launch async [%async_token_1] (%arg4, %arg5) in (%arg6=%c4, %arg7=%c4) args(%arg8=%arg0, %arg9=%arg1) : memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {id = 8 : i32} {
+      %1 = air.segment async  args(%arg15=%arg4, %arg16=%arg5, %arg17=%arg6, %arg18=%arg7, %arg19=%arg8, %arg20=%arg9) : index, index, index, index, memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c2 = arith.constant 2 : index
+        %2 = air.herd @herd_0 async tile (%arg21, %arg22) in (%arg23=%c2, %arg24=%c2) {
+          %async_token_3, %results_4 = air.execute -> (memref<16x16xbf16, 2>) {
+            %alloc = memref.alloc() : memref<16x16xbf16, 2>
+            air.execute_terminator %alloc : memref<16x16xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return %results_2 : memref<256x1024xbf16>
+  }
+}
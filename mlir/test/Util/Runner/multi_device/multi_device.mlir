@@ -0,0 +1,154 @@
+//===- multi_device.mlir ---------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.one
+// RUN: FileCheck %s --check-prefix=ONE --input-file=%t.one
+// RUN: air-runner %s -f test -m %S/arch.json --trace-level=none -o %t.json --report=json --report-file=%t.two
+// RUN: FileCheck %s --check-prefix=TWO --input-file=%t.two
+// RUN: air-runner %s -f small -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.small
+// RUN: FileCheck %s --check-prefix=SMALL --input-file=%t.small
+
+// Independent launches run back-to-back on one device, and concurrently on
+// two devices. The launch depending on the first one waits for it on either.
+
+// ONE: "name": "du[0]/tile[0]"
+// ONE: "spans": [
+// ONE: "kind": "launch",
+// ONE-NEXT: "name": "air.launch",
+// ONE-NEXT: "start": 1{{$}}
+// ONE: "kind": "launch",
+// ONE-NEXT: "name": "air.launch",
+// ONE-NEXT: "start": {{([2-9]|[1-9][0-9]+)}}
+// ONE: "kind": "launch",
+// ONE-NEXT: "name": "air.launch",
+// ONE-NEXT: "start": {{([2-9]|[1-9][0-9]+)}}
+
+// TWO: "name": "device[0]/du[0]/tile[0]"
+// TWO: "name": "device[1]/du[0]/tile[0]"
+// TWO: "spans": [
+// TWO: "kind": "launch",
+// TWO-NEXT: "name": "air.launch",
+// TWO-NEXT: "start": 1{{$}}
+// TWO: "kind": "launch",
+// TWO-NEXT: "name": "air.launch",
+// TWO-NEXT: "start": 1{{$}}
+// TWO: "kind": "launch",
+// TWO-NEXT: "name": "air.launch",
+// TWO-NEXT: "start": {{([2-9]|[1-9][0-9]+)}}
+
+// Launches on the same device never overlap, even when the device has the
+// resources to run them concurrently: the two launches of @small each use a
+// single du of the 16 of the device, yet the second starts when the first
+// ends.
+
+// SMALL: "spans": [
+// SMALL-NEXT: {
+// SMALL-NEXT: "end": [[#END:]],
+// SMALL-NEXT: "id": {{-?[0-9]+}},
+// SMALL-NEXT: "instances": 1,
+// SMALL-NEXT: "kind": "launch",
+// SMALL-NEXT: "name": "air.launch",
+// SMALL-NEXT: "start": 1{{$}}
+// SMALL: "kind": "launch",
+// SMALL-NEXT: "name": "air.launch",
+// SMALL-NEXT: "start": [[#END]]{{$}}
+
+module {
+  func.func @test() {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg2, %arg3) in (%arg4=%c1, %arg5=%c1) {
+      %1 = air.segment async attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c4 = arith.constant 4 : index
+        %2 = air.herd @herd_0 async tile (%arg6, %arg7) in (%arg8=%c4, %arg9=%c4) {
+          %async_token, %results = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_0 = air.execute [%async_token] {
+            memref.dealloc %results : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    %3 = air.launch async (%arg2, %arg3) in (%arg4=%c1, %arg5=%c1) {
+      %4 = air.segment async attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c4 = arith.constant 4 : index
+        %5 = air.herd @herd_3 async tile (%arg6, %arg7) in (%arg8=%c4, %arg9=%c4) {
+          %async_token, %results = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_0 = air.execute [%async_token] {
+            memref.dealloc %results : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    %6 = air.launch async [%0] (%arg2, %arg3) in (%arg4=%c1, %arg5=%c1) {
+      %7 = air.segment async attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c4 = arith.constant 4 : index
+        %8 = air.herd @herd_6 async tile (%arg6, %arg7) in (%arg8=%c4, %arg9=%c4) {
+          %async_token, %results = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_0 = air.execute [%async_token] {
+            memref.dealloc %results : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+  func.func @small() {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg2, %arg3) in (%arg4=%c1, %arg5=%c1) {
+      %1 = air.segment async attributes {x_loc = 0 : i64, x_size = 1 : i64, y_loc = 0 : i64, y_size = 1 : i64} {
+        %c1_0 = arith.constant 1 : index
+        %2 = air.herd @herd_0 async tile (%arg6, %arg7) in (%arg8=%c1_0, %arg9=%c1_0) {
+          %async_token, %results = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_0 = air.execute [%async_token] {
+            memref.dealloc %results : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    %3 = air.launch async (%arg2, %arg3) in (%arg4=%c1, %arg5=%c1) {
+      %4 = air.segment async attributes {x_loc = 0 : i64, x_size = 1 : i64, y_loc = 0 : i64, y_size = 1 : i64} {
+        %c1_0 = arith.constant 1 : index
+        %5 = air.herd @herd_3 async tile (%arg6, %arg7) in (%arg8=%c1_0, %arg9=%c1_0) {
+          %async_token, %results = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_0 = air.execute [%async_token] {
+            memref.dealloc %results : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+}
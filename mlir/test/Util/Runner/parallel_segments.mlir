@@ -0,0 +1,147 @@
+//===- parallel_segments.mlir ----------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch.json -o %t.json
+// RUN: air-runner %s -f test -m %S/arch.json --parallel-segments -o %t.par.json
+// RUN: diff %t.json %t.par.json
+// RUN: FileCheck %s --input-file=%t.par.json
+// RUN: air-runner %s -f test -m %S/arch.json --trace-format=perfetto -o %t.pftrace
+// RUN: air-runner %s -f test -m %S/arch.json --trace-format=perfetto --parallel-segments -o %t.par.pftrace
+// RUN: cmp %t.pftrace %t.par.pftrace
+// RUN: %python %S/count_perfetto_tracks.py %t.par.pftrace | FileCheck %s --check-prefix=TRACKS
+
+// Segments 2 and 4 share no channel and are simulated in separate groups;
+// segments 6 and 8 communicate through @channel_4 and stay in one group.
+
+// With --parallel-segments, partitions describing tracks concurrently still
+// describe each Perfetto track once, and in the same order as without.
+
+// TRACKS: descriptors: {{[1-9][0-9]*}}
+// TRACKS-NEXT: duplicates: 0
+
+// CHECK: "name": "ChannelGetOp@channel_0(L2<--L3)",
+// CHECK: "name": "ChannelGetOp@channel_1(L2<--L3)",
+// CHECK: "name": "ChannelGetOp@channel_4(L2<--L2)",
+
+// CHECK: "name": "LaunchTerminator",
+// CHECK: "ph": "B",
+
+// CHECK: "name": "LaunchTerminator",
+// CHECK: "ph": "E",
+
+module {
+  air.channel @channel_0 [1, 1]
+  air.channel @channel_1 [1, 1]
+  air.channel @channel_2 [1, 1]
+  air.channel @channel_3 [1, 1]
+  air.channel @channel_4 [1, 1]
+  func.func @test(%arg0: memref<1024x1024xbf16>, %arg1: memref<1024x1024xbf16>) {
+    %c1 = arith.constant 1 : index
+    %0 = air.launch async (%arg2, %arg3) in (%arg4=%c1, %arg5=%c1) args(%arg6=%arg0, %arg7=%arg1) : memref<1024x1024xbf16>, memref<1024x1024xbf16> attributes {id = 1 : i32} {
+      %c1_0 = arith.constant 1 : index
+      %c0 = arith.constant 0 : index
+      %c1024 = arith.constant 1024 : index
+      %c128 = arith.constant 128 : index
+      %1 = air.wait_all async
+      %2 = scf.for %arg8 = %c0 to %c1024 step %c128 iter_args(%arg9 = %1) -> (!air.async.token) {
+        %13 = air.channel.put async [%arg9]  @channel_0[] (%arg6[%arg8, %c0] [%c128, %c128] [%c1024, %c1_0]) {id = 2 : i32} : (memref<1024x1024xbf16>)
+        scf.yield %13 : !air.async.token
+      }
+      %3 = air.wait_all async
+      %4 = scf.for %arg8 = %c0 to %c1024 step %c128 iter_args(%arg9 = %3) -> (!air.async.token) {
+        %13 = air.channel.put async [%arg9]  @channel_1[] (%arg7[%arg8, %c0] [%c128, %c128] [%c1024, %c1_0]) {id = 3 : i32} : (memref<1024x1024xbf16>)
+        scf.yield %13 : !air.async.token
+      }
+      %5 = air.wait_all async
+      %6 = scf.for %arg8 = %c0 to %c1024 step %c128 iter_args(%arg9 = %5) -> (!air.async.token) {
+        %13 = air.channel.put async [%arg9]  @channel_2[] (%arg6[%c0, %arg8] [%c128, %c128] [%c1024, %c1_0]) {id = 4 : i32} : (memref<1024x1024xbf16>)
+        scf.yield %13 : !air.async.token
+      }
+      %7 = air.wait_all async
+      %8 = scf.for %arg8 = %c0 to %c1024 step %c128 iter_args(%arg9 = %7) -> (!air.async.token) {
+        %13 = air.channel.get async [%arg9]  @channel_3[] (%arg7[%c0, %arg8] [%c128, %c128] [%c1024, %c1_0]) {id = 5 : i32} : (memref<1024x1024xbf16>)
+        scf.yield %13 : !air.async.token
+      }
+      %9 = air.segment async  attributes {id = 2 : i32, x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c0_1 = arith.constant 0 : index
+        %c1024_2 = arith.constant 1024 : index
+        %c128_3 = arith.constant 128 : index
+        %13 = air.wait_all async
+        %14 = scf.for %arg8 = %c0_1 to %c1024_2 step %c128_3 iter_args(%arg9 = %13) -> (!air.async.token) {
+          %async_token, %results = air.execute [%arg9] -> (memref<128x128xbf16, 1>) {
+            %alloc = memref.alloc() : memref<128x128xbf16, 1>
+            air.execute_terminator %alloc : memref<128x128xbf16, 1>
+          }
+          %15 = air.channel.get async [%async_token]  @channel_0[] (%results[] [] []) {id = 6 : i32} : (memref<128x128xbf16, 1>)
+          %async_token_4 = air.execute [%15] {
+            memref.dealloc %results : memref<128x128xbf16, 1>
+          }
+          scf.yield %async_token_4 : !air.async.token
+        }
+        air.segment_terminator
+      }
+      %10 = air.segment async  attributes {id = 4 : i32, x_loc = 4 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c0_1 = arith.constant 0 : index
+        %c1024_2 = arith.constant 1024 : index
+        %c128_3 = arith.constant 128 : index
+        %13 = air.wait_all async
+        %14 = scf.for %arg8 = %c0_1 to %c1024_2 step %c128_3 iter_args(%arg9 = %13) -> (!air.async.token) {
+          %async_token, %results = air.execute [%arg9] -> (memref<128x128xbf16, 1>) {
+            %alloc = memref.alloc() : memref<128x128xbf16, 1>
+            air.execute_terminator %alloc : memref<128x128xbf16, 1>
+          }
+          %15 = air.channel.get async [%async_token]  @channel_1[] (%results[] [] []) {id = 7 : i32} : (memref<128x128xbf16, 1>)
+          %async_token_4 = air.execute [%15] {
+            memref.dealloc %results : memref<128x128xbf16, 1>
+          }
+          scf.yield %async_token_4 : !air.async.token
+        }
+        air.segment_terminator
+      }
+      %11 = air.segment async  attributes {id = 6 : i32, x_loc = 8 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c0_1 = arith.constant 0 : index
+        %c1024_2 = arith.constant 1024 : index
+        %c128_3 = arith.constant 128 : index
+        %13 = air.wait_all async
+        %14 = scf.for %arg8 = %c0_1 to %c1024_2 step %c128_3 iter_args(%arg9 = %13) -> (!air.async.token) {
+          %async_token, %results = air.execute [%arg9] -> (memref<128x128xbf16, 1>) {
+            %alloc = memref.alloc() : memref<128x128xbf16, 1>
+            air.execute_terminator %alloc : memref<128x128xbf16, 1>
+          }
+          %15 = air.channel.get async [%async_token]  @channel_2[] (%results[] [] []) {id = 8 : i32} : (memref<128x128xbf16, 1>)
+          %16 = air.channel.put async [%15]  @channel_4[] (%results[] [] []) {id = 9 : i32} : (memref<128x128xbf16, 1>)
+          %async_token_4 = air.execute [%16] {
+            memref.dealloc %results : memref<128x128xbf16, 1>
+          }
+          scf.yield %async_token_4 : !air.async.token
+        }
+        air.segment_terminator
+      }
+      %12 = air.segment async  attributes {id = 8 : i32, x_loc = 12 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c0_1 = arith.constant 0 : index
+        %c1024_2 = arith.constant 1024 : index
+        %c128_3 = arith.constant 128 : index
+        %13 = air.wait_all async
+        %14 = scf.for %arg8 = %c0_1 to %c1024_2 step %c128_3 iter_args(%arg9 = %13) -> (!air.async.token) {
+          %async_token, %results = air.execute [%arg9] -> (memref<128x128xbf16, 1>) {
+            %alloc = memref.alloc() : memref<128x128xbf16, 1>
+            air.execute_terminator %alloc : memref<128x128xbf16, 1>
+          }
+          %15 = air.channel.get async [%async_token]  @channel_4[] (%results[] [] []) {id = 10 : i32} : (memref<128x128xbf16, 1>)
+          %16 = air.channel.put async [%15]  @channel_3[] (%results[] [] []) {id = 11 : i32} : (memref<128x128xbf16, 1>)
+          %async_token_4 = air.execute [%16] {
+            memref.dealloc %results : memref<128x128xbf16, 1>
+          }
+          scf.yield %async_token_4 : !air.async.token
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+}
@@ -0,0 +1,33 @@
+# Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+# SPDX-License-Identifier: MIT
+
+# Generate an air.launch whose herd body is N dependent air.wait_all events,
+# split into C independent chains (one by default), used to check that
+# air-runner scales with graph size.
+
+import sys
+
+num_events = int(sys.argv[1]) if len(sys.argv) > 1 else 1000
+num_chains = int(sys.argv[2]) if len(sys.argv) > 2 else 1
+
+print("module {")
+print("  func.func @test() {")
+print("    %c1 = arith.constant 1 : index")
+print("    %0 = air.launch async (%arg0, %arg1) in (%arg2=%c1, %arg3=%c1) {")
+print("      %1 = air.segment async attributes {x_loc = 0 : i64, x_size = 1 : i64, y_loc = 0 : i64, y_size = 1 : i64} {")
+print("        %c1_0 = arith.constant 1 : index")
+print("        %2 = air.herd @herd_0 async tile (%arg4, %arg5) in (%arg6=%c1_0, %arg7=%c1_0) {")
+for i in range(num_events):
+    if i < num_chains:
+        print("          %%t%d = air.wait_all async" % i)
+    else:
+        print("          %%t%d = air.wait_all async [%%t%d]" % (i, i - num_chains))
+print("          air.herd_terminator")
+print("        }")
+print("        air.segment_terminator")
+print("      }")
+print("      air.launch_terminator")
+print("    }")
+print("    return")
+print("  }")
+print("}")
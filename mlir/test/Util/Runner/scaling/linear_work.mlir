@@ -0,0 +1,32 @@
+//===- linear_work.mlir ----------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// The vertices and edges that the scheduler looks at grow linearly with the
+// number of simulated events, both along one long chain and across 50
+// parallel chains, where many processed vertices are adjacent to the
+// wavefront of each time stamp. Unlike scheduling time, which
+// air-runner-benchmark measures, the reported counts do not depend on the
+// machine.
+
+// RUN: %python %S/gen_dependency_chain.py 500 > %t.500.mlir
+// RUN: %python %S/gen_dependency_chain.py 1000 > %t.1000.mlir
+// RUN: %python %S/gen_dependency_chain.py 2000 > %t.2000.mlir
+// RUN: air-runner %t.500.mlir -f test -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.500.report
+// RUN: air-runner %t.1000.mlir -f test -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.1000.report
+// RUN: air-runner %t.2000.mlir -f test -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.2000.report
+// RUN: %python %S/work_growth.py %t.500.report %t.1000.report %t.2000.report | FileCheck %s
+
+// RUN: %python %S/gen_dependency_chain.py 1000 50 > %t.wide.1000.mlir
+// RUN: %python %S/gen_dependency_chain.py 2000 50 > %t.wide.2000.mlir
+// RUN: %python %S/gen_dependency_chain.py 4000 50 > %t.wide.4000.mlir
+// RUN: air-runner %t.wide.1000.mlir -f test -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.wide.1000.report
+// RUN: air-runner %t.wide.2000.mlir -f test -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.wide.2000.report
+// RUN: air-runner %t.wide.4000.mlir -f test -m %S/../arch.json --trace-level=none -o %t.json --report=json --report-file=%t.wide.4000.report
+// RUN: %python %S/work_growth.py %t.wide.1000.report %t.wide.2000.report %t.wide.4000.report | FileCheck %s
+
+// CHECK: events: work growth 1.0
+// CHECK-NEXT: events: work growth 1.0
@@ -0,0 +1,20 @@
+//===- long_dependency_chain.mlir ------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// Smoke test of the simulation of long chains of dependent events. Scheduling
+// time is measured by air-runner-benchmark, e.g.
+// `air-runner-benchmark -m arch.json --vertices=10000,100000 --max-growth=2`,
+// which fails if it grows faster than the graph.
+
+// RUN: %python %S/gen_dependency_chain.py 500 > %t.500.mlir
+// RUN: air-runner %t.500.mlir -f test -m %S/../arch.json | FileCheck %s
+// RUN: %python %S/gen_dependency_chain.py 1000 > %t.1000.mlir
+// RUN: air-runner %t.1000.mlir -f test -m %S/../arch.json | FileCheck %s
+
+// CHECK: "name": "WaitAllOp",
+// CHECK: "name": "HerdTerminator",
+// CHECK: "name": "LaunchTerminator",
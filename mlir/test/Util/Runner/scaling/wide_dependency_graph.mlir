@@ -0,0 +1,17 @@
+//===- wide_dependency_graph.mlir ------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// Smoke test of the simulation of a graph of 50 parallel chains, where many
+// processed vertices are adjacent to the wavefront of each time stamp.
+// Scheduling time is measured by air-runner-benchmark, e.g.
+// `air-runner-benchmark -m arch.json --vertices=5000,50000 --chains=50`.
+
+// RUN: %python %S/gen_dependency_chain.py 2000 50 > %t.mlir
+// RUN: air-runner %t.mlir -f test -m %S/../arch.json --trace-level=hierarchy | FileCheck %s
+
+// CHECK: "name": "HerdTerminator",
+// CHECK: "name": "LaunchTerminator",
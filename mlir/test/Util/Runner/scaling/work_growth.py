@@ -0,0 +1,19 @@
+# Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+# SPDX-License-Identifier: MIT
+
+# Read the json reports of air-runner simulations of growing graphs, in order,
+# and print how much faster than the number of simulated events the
+# scheduler's vertex visits grew from each report to the next: 1 is linear.
+
+import json
+import sys
+
+work = []
+for filename in sys.argv[1:]:
+    with open(filename) as f:
+        simulation = json.load(f)["simulation"]
+    work.append((simulation["events"], simulation["vertex_visits"]))
+
+for (events, visits), (next_events, next_visits) in zip(work, work[1:]):
+    growth = (next_visits / visits) / (next_events / events)
+    print("%d -> %d events: work growth %.1f" % (events, next_events, growth))
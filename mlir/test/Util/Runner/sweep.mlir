@@ -0,0 +1,82 @@
+//===- sweep.mlir ----------------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch.json -o %t.json > %t.txt
+// RUN: air-runner %s -f test -m %S/arch.json --sweep-param 'num_herd_slots=[1,2]' --sweep-param 'dus.ports.inbound.bytes_per_second=[100000000000,50000000000]' >> %t.txt
+// RUN: FileCheck %s --input-file=%t.txt
+// RUN: air-runner %s -f test --sweep-model %S/arch.json,%S/arch.json --sweep-format json | FileCheck %s --check-prefix=JSON
+
+// The first variant of the grid is the model given by -m, so it must reproduce
+// the latency of a standalone run.
+
+// CHECK: Latency: [[LAT:[0-9.]+]]us
+// CHECK: model,num_herd_slots,dus.ports.inbound.bytes_per_second,cycles,latency_us,du_utilization,tile_utilization
+// CHECK-NEXT: {{.*}}arch.json,1,100000000000,{{[0-9]+}},[[LAT]],{{[0-9.]+}},{{[0-9.]+}}
+// CHECK-NEXT: {{.*}}arch.json,1,50000000000,
+// CHECK-NEXT: {{.*}}arch.json,2,100000000000,
+// CHECK-NEXT: {{.*}}arch.json,2,50000000000,
+
+// JSON-COUNT-2: "model": "{{.*}}arch.json",
+
+module {
+  air.channel @channel_0 [1, 1]
+  air.channel @channel_1 [1, 1]
+  func.func @test(%arg0: memref<1024x1024xbf16>) {
+    %c2 = arith.constant 2 : index
+    %0 = air.launch async (%arg1, %arg2) in (%arg3=%c2, %arg4=%c2) args(%arg5=%arg0) : memref<1024x1024xbf16> attributes {id = 1 : i32} {
+      %c1 = arith.constant 1 : index
+      %c0 = arith.constant 0 : index
+      %c1024 = arith.constant 1024 : index
+      %c128 = arith.constant 128 : index
+      %1 = air.wait_all async
+      %2 = scf.for %arg6 = %c0 to %c1024 step %c128 iter_args(%arg7 = %1) -> (!air.async.token) {
+        %4 = air.channel.put async [%arg7]  @channel_0[] (%arg5[%arg6, %c0] [%c128, %c128] [%c1024, %c1]) {id = 2 : i32} : (memref<1024x1024xbf16>)
+        scf.yield %4 : !air.async.token
+      }
+      %3 = air.segment async  attributes {id = 3 : i32, x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c0_0 = arith.constant 0 : index
+        %c1_1 = arith.constant 1 : index
+        %c1024_2 = arith.constant 1024 : index
+        %c128_3 = arith.constant 128 : index
+        %4 = air.wait_all async
+        %5 = scf.for %arg6 = %c0_0 to %c1024_2 step %c128_3 iter_args(%arg7 = %4) -> (!air.async.token) {
+          %async_token, %results = air.execute [%arg7] -> (memref<128x128xbf16, 1>) {
+            %alloc = memref.alloc() : memref<128x128xbf16, 1>
+            air.execute_terminator %alloc : memref<128x128xbf16, 1>
+          }
+          %7 = air.channel.get async [%async_token]  @channel_0[] (%results[] [] []) {id = 3 : i32} : (memref<128x128xbf16, 1>)
+          %8 = air.channel.put async [%7]  @channel_1[] (%results[] [] []) {id = 4 : i32} : (memref<128x128xbf16, 1>)
+          %async_token_4 = air.execute [%8] {
+            memref.dealloc %results : memref<128x128xbf16, 1>
+          }
+          scf.yield %async_token_4 : !air.async.token
+        }
+        %6 = air.herd @herd_0 async tile (%arg8, %arg9) in (%arg10=%c1_1, %arg11=%c1_1) attributes {id = 5 : i32} {
+          %c0_5 = arith.constant 0 : index
+          %c1024_6 = arith.constant 1024 : index
+          %c128_7 = arith.constant 128 : index
+          %9 = air.wait_all async
+          %10 = scf.for %arg12 = %c0_5 to %c1024_6 step %c128_7 iter_args(%arg13 = %9) -> (!air.async.token) {
+            %async_token_8, %results_9 = air.execute [%arg13] -> (memref<64x64xbf16, 2>) {
+              %alloc = memref.alloc() : memref<64x64xbf16, 2>
+              air.execute_terminator %alloc : memref<64x64xbf16, 2>
+            }
+            %11 = air.channel.get async [%async_token_8]  @channel_1[] (%results_9[] [] []) {id = 6 : i32} : (memref<64x64xbf16, 2>)
+            %async_token_10 = air.execute [%11] {
+              memref.dealloc %results_9 : memref<64x64xbf16, 2>
+            }
+            scf.yield %async_token_10 : !air.async.token
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return
+  }
+}
@@ -0,0 +1,72 @@
+//===- memory_footprint.mlir -----------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch.json -g core --trace-level=none -o %t.json --report=json --report-file=%t.report
+// RUN: FileCheck %s --input-file=%t.report
+
+// Each core allocates two 2KB buffers in a 2KB L1 memory, so its second
+// allocation waits for the first buffer to be freed, and its tile peaks at
+// full capacity.
+
+// CHECK: "allocation_stalls": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "allocs": {{[1-9][0-9]*}},
+// CHECK-NEXT: "memory_space": "L1",
+// CHECK-NEXT: "stall_cycles": {{[1-9][0-9]*}}
+
+// CHECK: "memories": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "capacity_bytes": 262144,
+// CHECK-NEXT: "memory_space": "L2",
+// CHECK-NEXT: "name": "du[0]/L2",
+// CHECK-NEXT: "peak_bytes": 0,
+// CHECK: "capacity_bytes": 2048,
+// CHECK-NEXT: "memory_space": "L1",
+// CHECK-NEXT: "name": "du[0]/tile[{{[0-9]+}}]/L1",
+// CHECK-NEXT: "peak_bytes": 2048,
+// CHECK-NEXT: "peak_fraction": 1,
+// CHECK-NEXT: "repeats": [],
+// CHECK-NEXT: "timeline": [
+// CHECK-NEXT: [
+// CHECK-NEXT: {{[0-9]+}},
+// CHECK-NEXT: 2048
+
+module {
+  func.func @test(%arg0: memref<256x1024xbf16>, %arg1: memref<1024x1024xbf16>, %arg2: memref<1024x1024xbf16>, %arg3: memref<1024x1024xbf16>) -> memref<256x1024xbf16> {
+    %c1 = arith.constant 1 : index
+    %async_token_1, %results_2 = air.execute -> (memref<256x1024xbf16>) {
+      %alloc = memref.alloc() {alignment = 128 : i64} : memref<256x1024xbf16>
+      air.execute_terminator %alloc : memref<256x1024xbf16>
+    }
+    %0 = air.launch async [%async_token_1] (%arg4, %arg5) in (%arg6=%c1, %arg7=%c1) args(%arg8=%arg0, %arg9=%arg1) : memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {id = 7 : i32} {
+      %1 = air.segment async  args(%arg15=%arg4, %arg16=%arg5, %arg17=%arg6, %arg18=%arg7, %arg19=%arg8, %arg20=%arg9) : index, index, index, index, memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 1 : i64} {
+        %c1_1 = arith.constant 1 : index
+        %c4 = arith.constant 4 : index
+        %2 = air.herd @herd_0 async tile (%arg21, %arg22) in (%arg23=%c4, %arg24=%c1_1) {
+          %async_token_3, %results_4 = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_5, %results_6 = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_7 = air.execute [%async_token_3] {
+            memref.dealloc %results_4 : memref<32x32xbf16, 2>
+          }
+          %async_token_8 = air.execute [%async_token_5] {
+            memref.dealloc %results_6 : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return %results_2 : memref<256x1024xbf16>
+  }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+//===- trace_format.mlir ---------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-runner %s -f test -m %S/arch.json --trace-format=compact | FileCheck %s --check-prefix=COMPACT
+// RUN: air-runner %s -f test -m %S/arch.json --trace-level=hierarchy | FileCheck %s --check-prefix=HIER
+// RUN: air-runner %s -f test -m %S/arch.json --trace-level=none -o %t.json
+// RUN: FileCheck %s --check-prefix=NONE --input-file=%t.json
+
+// Test trace output formats and filtering
+
+// COMPACT: {"name":"process_name","ph":"M","pid":7,"args":{"name":"{{.*}}"}},
+// COMPACT: {"name":"SegmentOp[4, 4]","cat":"layer","ph":"B","ts":0.001,"pid":{{-?[0-9]+}},"tid":{{[0-9]+}}},
+// COMPACT: {"name":"AllocOp(L1, 1024, bf16)","cat":"layer","ph":"B","ts":0.003,
+// COMPACT: {"name":"LaunchTerminator","cat":"layer","ph":"E","ts":0.010,"pid":7,"tid":{{[0-9]+}}},
+// COMPACT-NEXT: {}]
+
+// HIER: "name": "SegmentOp[4, 4]",
+// HIER: "name": "HerdOp(herd_0)[4, 4]",
+// HIER-NOT: "name": "AllocOp
+// HIER-NOT: "name": "DeallocOp
+// HIER: "name": "HerdTerminator",
+// HIER: "name": "LaunchTerminator",
+// HIER: "name": "LaunchTerminator",
+// HIER-NEXT: "cat": "layer",
+// HIER-NEXT: "ph": "E",
+// HIER-NEXT: "ts": 0.010,
+
+// NONE: [
+// NONE-NEXT: {}]
+
+module {
+  ml_program.global private mutable @global_seed(dense<0> : tensor<i64>) : tensor<i64>
+  func.func @test(%arg0: memref<256x1024xbf16>, %arg1: memref<1024x1024xbf16>, %arg2: memref<1024x1024xbf16>, %arg3: memref<1024x1024xbf16>) -> memref<256x1024xbf16> {
+    %c1 = arith.constant 1 : index
+    %async_token_1, %results_2 = air.execute -> (memref<256x1024xbf16>) {
+      %alloc = memref.alloc() {alignment = 128 : i64} : memref<256x1024xbf16>
+      air.execute_terminator %alloc : memref<256x1024xbf16>
+    }
+    %0 = air.launch async [%async_token_1] (%arg4, %arg5) in (%arg6=%c1, %arg7=%c1) args(%arg8=%arg0, %arg9=%arg1) : memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {id = 7 : i32} {
+      %1 = air.segment async  args(%arg15=%arg4, %arg16=%arg5, %arg17=%arg6, %arg18=%arg7, %arg19=%arg8, %arg20=%arg9) : index, index, index, index, memref<256x1024xbf16>, memref<1024x1024xbf16> attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+        %c4 = arith.constant 4 : index
+        %2 = air.herd @herd_0 async tile (%arg21, %arg22) in (%arg23=%c4, %arg24=%c4) {
+          %async_token_3, %results_4 = air.execute -> (memref<32x32xbf16, 2>) {
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }
+          %async_token_5 = air.execute [%async_token_3] {
+            memref.dealloc %results_4 : memref<32x32xbf16, 2>
+          }
+          air.herd_terminator
+        }
+        air.segment_terminator
+      }
+      air.launch_terminator
+    }
+    return %results_2 : memref<256x1024xbf16>
+  }
+}
+
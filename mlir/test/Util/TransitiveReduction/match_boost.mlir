@@ -0,0 +1,25 @@
+//===- match_boost.mlir ----------------------------------------*- MLIR -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: air-tr-benchmark --verify --vertices=1,2,63,64,65,200,1000 --budget-bytes=1 | FileCheck %s
+// RUN: air-tr-benchmark --verify --vertices=1000 --window=8 --degree=8 | FileCheck %s --check-prefix=DENSE
+
+// The transitive reduction of async token graphs keeps the same edges, in the
+// same order, as boost::transitive_reduction, on random DAGs with redundant
+// and repeated edges. A budget of one byte reduces 64 target vertices at a
+// time, so that larger graphs take several chunks.
+
+// CHECK: vertices graphs edges kept result
+// CHECK-NEXT: {{^ *}}1 8 0 0 match
+// CHECK-NEXT: {{^ *}}2 8 {{[0-9]+ [0-9]+}} match
+// CHECK-NEXT: {{^ *}}63 8 {{[0-9]+ [0-9]+}} match
+// CHECK-NEXT: {{^ *}}64 8 {{[0-9]+ [0-9]+}} match
+// CHECK-NEXT: {{^ *}}65 8 {{[0-9]+ [0-9]+}} match
+// CHECK-NEXT: {{^ *}}200 8 {{[0-9]+ [0-9]+}} match
+// CHECK-NEXT: {{^ *}}1000 8 {{[0-9]+ [0-9]+}} match
+
+// DENSE: {{^ *}}1000 8 {{[0-9]+ [0-9]+}} match
@@ -70,17 +70,7 @@ class Runner:
             trace_tmpfile = tempfile.NamedTemporaryFile(delete=False)
             trace_filename = trace_tmpfile.name
         
-        # the json model can be:
-        #  1. json in string form
-        #  2. json in python object form
-        #  3. the name of a file containing (1)
-        json_model = self.json_model
-        if type(json_model) == str:
-            if '.json' in json_model:
-                with open(json_model) as f:
-                    json_model = json.loads(f.read())
-            else:
-                json_model = json.loads(json_model)
+        json_model = self._load_json_model()
 
         json_tmpfile = tempfile.NamedTemporaryFile(delete=False)
         json_tmpfile.write(str.encode(json.dumps(json_model)))
@@ -99,3 +89,45 @@ class Runner:
 
         return return_trace
 
+    def simulate(self, module, function):
+        """Simulate a function without writing any file, unless the runner
+        was given a trace filename. Returns a dict with the total cycles, the
+        spans of each launch, segment and herd, the busy cycles of each
+        resource, the stalls of each channel, and the full json report."""
+        air_module = _convert_module(module)
+        json_model = self._load_json_model()
+        results = runner.simulate(air_module, json.dumps(json_model), function,
+                                  self.sim_granularity, self.verbose,
+                                  self.trace_filename or "")
+        if results is None:
+            raise RuntimeError("failed to simulate " + function)
+        return results
+
+    def session(self, module, function):
+        """Parse a function once for repeated simulation while editing it.
+        After editing the function in place, pass the edited ops to the
+        session's invalidate(); its simulate() then re-simulates only the
+        launches containing them, and returns results like simulate()."""
+        if not isinstance(module, air.mlir.ir.Module):
+            raise TypeError("a session simulates an air module in place")
+        json_model = self._load_json_model()
+        session = runner.session(module, json.dumps(json_model), function,
+                                 self.sim_granularity)
+        if session is None:
+            raise RuntimeError("failed to parse " + function)
+        return session
+
+    def _load_json_model(self):
+        # the json model can be:
+        #  1. json in string form
+        #  2. json in python object form
+        #  3. the name of a file containing (1)
+        json_model = self.json_model
+        if type(json_model) == str:
+            if '.json' in json_model:
+                with open(json_model) as f:
+                    json_model = json.loads(f.read())
+            else:
+                json_model = json.loads(json_model)
+        return json_model
+
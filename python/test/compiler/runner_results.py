@@ -0,0 +1,59 @@
+# ./python/test/compiler/runner_results.py -*- Python -*-
+
+# Copyright (C) 2023, Advanced Micro Devices, Inc.
+# SPDX-License-Identifier: MIT
+
+# RUN: %PYTHON %s %S/../../../mlir/test/Util/Runner/arch.json | FileCheck %s
+import sys
+
+from air.mlir.ir import *
+from air.dialects import air as airdialect
+
+from air.compiler.util import Runner
+
+def run(f):
+  print("\nTEST:", f.__name__)
+  f()
+  return f
+
+# CHECK-LABEL: TEST: hierarchy_results
+# CHECK: cycles: True
+# CHECK: launch air.launch 1 1
+# CHECK: segment air.segment 1 1
+# CHECK: herd herd_0 1 2
+# CHECK: report: True
+@run
+def hierarchy_results():
+  with Context() as ctx, Location.unknown():
+    airdialect.register_dialect(ctx)
+    module = Module.parse("""
+      module {
+        func.func @test(%arg0: memref<256x1024xbf16>) {
+          %c1 = arith.constant 1 : index
+          %0 = air.launch async (%arg1, %arg2) in (%arg3=%c1, %arg4=%c1) {
+            %1 = air.segment async attributes {x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64} {
+              %c4 = arith.constant 4 : index
+              %2 = air.herd @herd_0 async tile (%arg5, %arg6) in (%arg7=%c4, %arg8=%c4) {
+                %async_token, %results = air.execute -> (memref<32x32xbf16, 2>) {
+                  %alloc = memref.alloc() : memref<32x32xbf16, 2>
+                  air.execute_terminator %alloc : memref<32x32xbf16, 2>
+                }
+                %async_token_0 = air.execute [%async_token] {
+                  memref.dealloc %results : memref<32x32xbf16, 2>
+                }
+                air.herd_terminator
+              }
+              air.segment_terminator
+            }
+            air.launch_terminator
+          }
+          return
+        }
+      }
+    """)
+    results = Runner(sys.argv[1]).simulate(module, "test")
+    print("cycles:", results["cycles"] > 0)
+    for span in results["spans"]:
+      print(span["kind"], span["name"], span["instances"], span["start"])
+      assert span["start"] < span["end"] <= results["cycles"]
+    print("report:", "critical_paths" in results["report"])
@@ -0,0 +1,90 @@
+# ./python/test/compiler/runner_session.py -*- Python -*-
+
+# Copyright (C) 2023, Advanced Micro Devices, Inc.
+# SPDX-License-Identifier: MIT
+
+# RUN: %PYTHON %s %S/../../../mlir/test/Util/Runner/arch.json | FileCheck %s
+import json
+import sys
+
+from air.mlir.ir import *
+from air.dialects import air as airdialect
+
+from air.compiler.util import Runner
+
+def run(f):
+  print("\nTEST:", f.__name__)
+  f()
+  return f
+
+def launch(herd):
+  return """
+    %{0} = air.launch async (%arg1, %arg2) in (%arg3=%c1, %arg4=%c1) {{
+      %1 = air.segment async attributes {{x_loc = 0 : i64, x_size = 4 : i64, y_loc = 0 : i64, y_size = 4 : i64}} {{
+        %c4 = arith.constant 4 : index
+        %2 = air.herd @{0} async tile (%arg5, %arg6) in (%arg7=%c4, %arg8=%c4) {{
+          %async_token, %results = air.execute -> (memref<32x32xbf16, 2>) {{
+            %alloc = memref.alloc() : memref<32x32xbf16, 2>
+            air.execute_terminator %alloc : memref<32x32xbf16, 2>
+          }}
+          %async_token_0 = air.execute [%async_token] {{
+            memref.dealloc %results : memref<32x32xbf16, 2>
+          }}
+          air.herd_terminator
+        }}
+        air.segment_terminator
+      }}
+      air.launch_terminator
+    }}
+  """.format(herd)
+
+def replayed(results):
+  launches = json.loads(results["report"])["simulation"]["launches"]
+  return [l["replayed"] for l in launches]
+
+# Results compared with a fresh simulation. Ids are left out, since the ops of
+# a re-parsed launch are numbered after those of the other launches.
+def summary(results):
+  spans = [(s["kind"], s["name"], s["instances"], s["start"], s["end"])
+           for s in results["spans"]]
+  resources = [(r["name"], r["busy_cycles"]) for r in results["resources"]]
+  return results["cycles"], sorted(spans), resources
+
+# Only the launch whose herd is resized is simulated again, and the results are
+# those of a fresh simulation of the edited function.
+
+# CHECK-LABEL: TEST: edit_one_launch
+# CHECK: first: [False, False]
+# CHECK: unchanged: [True, True]
+# CHECK: edited: [True, False]
+# CHECK: same as fresh: True
+@run
+def edit_one_launch():
+  with Context() as ctx, Location.unknown():
+    airdialect.register_dialect(ctx)
+    module = Module.parse("""
+      module {
+        func.func @test() {
+          %c1 = arith.constant 1 : index
+    """ + launch("herd_a") + launch("herd_b") + """
+          return
+        }
+      }
+    """)
+    runner = Runner(sys.argv[1])
+    session = runner.session(module, "test")
+    print("first:", replayed(session.simulate()))
+    print("unchanged:", replayed(session.simulate()))
+
+    func = module.body.operations[0]
+    launches = [op for op in func.regions[0].blocks[0].operations
+                if op.operation.name == "air.launch"]
+    segment = launches[1].regions[0].blocks[0].operations[0]
+    herd_size = segment.regions[0].blocks[0].operations[0]
+    herd_size.attributes["value"] = IntegerAttr.get(IndexType.get(), 2)
+    session.invalidate([herd_size])
+    results = session.simulate()
+    print("edited:", replayed(results))
+
+    fresh = runner.simulate(Module.parse(str(module)), "test")
+    print("same as fresh:", summary(results) == summary(fresh))
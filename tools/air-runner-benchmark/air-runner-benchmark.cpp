@@ -0,0 +1,192 @@
+//===- air-runner-benchmark.cpp ---------------------------------*- C++ -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// Time air-runner on synthetic chains of dependent air.wait_all events of
+// growing size. The events can be split into parallel chains, so that many
+// processed vertices are adjacent to the wavefront of each time stamp.
+// Scheduling a time stamp should not depend on the size of the dependency
+// graph, so simulation time should grow linearly with the number of events.
+// For each size after the first, the growth of the simulation time is reported
+// relative to the growth of the graph: 1 is linear, and a quadratic scheduler
+// reaches the size ratio, e.g. 10 for sizes a decade apart.
+
+#include "air/Dialect/AIR/AIRDialect.h"
+#include "air/Util/Runner.h"
+
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace mlir;
+
+static llvm::cl::list<unsigned>
+    clVertices("vertices", llvm::cl::desc("Number of events of each graph"),
+               llvm::cl::CommaSeparated);
+
+static llvm::cl::list<unsigned> clChains(
+    "chains",
+    llvm::cl::desc("Numbers of parallel chains to split the events into"),
+    llvm::cl::CommaSeparated);
+
+static llvm::cl::opt<std::string>
+    clModel("m", llvm::cl::desc("json architecture model"),
+            llvm::cl::value_desc("filename"), llvm::cl::Required);
+
+static llvm::cl::opt<double> clMaxGrowth(
+    "max-growth",
+    llvm::cl::desc("Fail if the simulation time grows faster than the graph "
+                   "by more than this factor between two sizes"),
+    llvm::cl::init(0));
+
+namespace {
+
+// An air.launch whose herd body is `num_events` dependent air.wait_all events,
+// split into `num_chains` independent chains
+std::string createProgram(unsigned num_events, unsigned num_chains) {
+  std::string s;
+  llvm::raw_string_ostream os(s);
+  os << "module {\n"
+     << "  func.func @test() {\n"
+     << "    %c1 = arith.constant 1 : index\n"
+     << "    %0 = air.launch async (%arg0, %arg1) in (%arg2=%c1, %arg3=%c1) "
+        "{\n"
+     << "      %1 = air.segment async attributes {x_loc = 0 : i64, x_size = "
+        "1 : i64, y_loc = 0 : i64, y_size = 1 : i64} {\n"
+     << "        %c1_0 = arith.constant 1 : index\n"
+     << "        %2 = air.herd @herd_0 async tile (%arg4, %arg5) in "
+        "(%arg6=%c1_0, %arg7=%c1_0) {\n";
+  for (unsigned i = 0; i < num_events; i++) {
+    os << "          %t" << i << " = air.wait_all async";
+    if (i >= num_chains)
+      os << " [%t" << i - num_chains << "]";
+    os << "\n";
+  }
+  os << "          air.herd_terminator\n"
+     << "        }\n"
+     << "        air.segment_terminator\n"
+     << "      }\n"
+     << "      air.launch_terminator\n"
+     << "    }\n"
+     << "    return\n"
+     << "  }\n"
+     << "}\n";
+  return os.str();
+}
+
+struct measurement {
+  // Parsing and canonicalizing the dependency graphs, and simulating them
+  double parse_seconds = 0;
+  double simulate_seconds = 0;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+LogicalResult measure(MLIRContext &context, llvm::json::Value &model,
+                      unsigned num_events, unsigned num_chains,
+                      measurement &result) {
+  auto module = parseSourceString<ModuleOp>(
+      createProgram(num_events, num_chains), ParserConfig(&context));
+  if (!module)
+    return failure();
+  auto toplevel = module->lookupSymbol<func::FuncOp>("test");
+
+  auto start = std::chrono::steady_clock::now();
+  xilinx::air::AIRRunnerProgram program(toplevel);
+  result.parse_seconds = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  xilinx::air::AIRRunner runner(llvm::nulls(), model, "herd", false, false,
+                                false, "json", "none");
+  runner.scheduleFunction(program);
+  result.simulate_seconds = secondsSince(start);
+  return success();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "AIR runner scheduling benchmark\n");
+
+  std::string errorMessage;
+  auto file = openInputFile(clModel, &errorMessage);
+  if (!file) {
+    llvm::errs() << errorMessage << "\n";
+    return 1;
+  }
+  auto model = llvm::json::parse(file->getBuffer());
+  if (!model) {
+    llvm::errs() << "failed to parse json model " << clModel << ": "
+                 << llvm::toString(model.takeError()) << "\n";
+    return 1;
+  }
+
+  std::vector<unsigned> sizes(clVertices.begin(), clVertices.end());
+  if (sizes.empty())
+    sizes = {10000, 100000};
+  std::vector<unsigned> chains(clChains.begin(), clChains.end());
+  if (chains.empty())
+    chains = {1};
+
+  MLIRContext context;
+  DialectRegistry registry;
+  registerAllDialects(registry);
+  registry.insert<xilinx::air::airDialect>();
+  context.appendDialectRegistry(registry);
+  context.loadAllAvailableDialects();
+
+  llvm::outs() << llvm::formatv("{0,10} {1,8} {2,12} {3,12} {4,12} {5,8}\n",
+                                "vertices", "chains", "parse_s", "simulate_s",
+                                "us/vertex", "growth");
+  bool too_slow = false;
+  for (unsigned num_chains : chains) {
+    measurement previous;
+    for (unsigned i = 0; i < sizes.size(); i++) {
+      measurement result;
+      if (failed(measure(context, *model, sizes[i], num_chains, result))) {
+        llvm::errs() << "measurement of " << sizes[i] << " vertices failed\n";
+        return 1;
+      }
+      std::string growth = "-";
+      if (i > 0 && previous.simulate_seconds > 0) {
+        double ratio = (result.simulate_seconds / previous.simulate_seconds) /
+                       ((double)sizes[i] / sizes[i - 1]);
+        growth = llvm::formatv("{0:f2}", ratio).str();
+        if (clMaxGrowth > 0 && ratio > clMaxGrowth)
+          too_slow = true;
+      }
+      llvm::outs() << llvm::formatv(
+          "{0,10} {1,8} {2,12:f3} {3,12:f3} {4,12:f3} {5,8}\n", sizes[i],
+          num_chains, result.parse_seconds, result.simulate_seconds,
+          result.simulate_seconds * 1e6 / sizes[i], growth);
+      previous = result;
+    }
+  }
+  if (too_slow) {
+    llvm::errs() << "simulation time grew faster than " << clMaxGrowth
+                 << " times the graph size\n";
+    return 1;
+  }
+  return 0;
+}
@@ -10,6 +10,7 @@
 #include "air/InitAll.h"
 #include "air/Util/Runner.h"
 
+#include "mlir/IR/Threading.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Support/FileUtilities.h"
@@ -17,11 +18,16 @@
 
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
 
+#include <cmath>
+#include <map>
+#include <optional>
 #include <vector>
 
 #define DEBUG_TYPE "air-runner"
@@ -33,6 +39,378 @@ using namespace mlir;
 
 namespace {
 
+// An architecture model evaluated in a design-space sweep
+struct SweepVariant {
+  std::string model_file;
+  // Values of the swept json fields, in the order of the sweep parameters
+  std::vector<llvm::json::Value> param_values;
+  llvm::json::Value model = nullptr;
+  xilinx::air::AIRRunnerResults results;
+};
+
+LogicalResult parseModelFile(StringRef filename, llvm::json::Value &model) {
+  std::string errorMessage;
+  auto file = openInputFile(filename, &errorMessage);
+  if (!file) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+  auto parsed = llvm::json::parse(file->getBuffer());
+  if (!parsed) {
+    llvm::errs() << "failed to parse json model " << filename << ": "
+                 << llvm::toString(parsed.takeError()) << "\n";
+    return failure();
+  }
+  model = std::move(*parsed);
+  return success();
+}
+
+// Set the field at a '.'-separated path of a json model. The objects along the
+// path must exist, the field itself is added if missing.
+LogicalResult setModelField(llvm::json::Value &model, StringRef path,
+                            const llvm::json::Value &value) {
+  SmallVector<StringRef> keys;
+  path.split(keys, '.');
+  llvm::json::Object *object = model.getAsObject();
+  for (unsigned i = 0; object && i + 1 < keys.size(); i++)
+    object = object->getObject(keys[i]);
+  if (!object) {
+    llvm::errs() << "sweep parameter path '" << path
+                 << "' not found in json model\n";
+    return failure();
+  }
+  (*object)[keys.back()] = value;
+  return success();
+}
+
+// Expand each base model over the grid spanned by the sweep parameters
+LogicalResult buildSweepVariants(ArrayRef<std::string> model_files,
+                                 ArrayRef<std::string> params,
+                                 std::vector<SweepVariant> &variants) {
+  for (auto &file : model_files) {
+    SweepVariant variant;
+    variant.model_file = file;
+    if (failed(parseModelFile(file, variant.model)))
+      return failure();
+    variants.push_back(std::move(variant));
+  }
+
+  for (auto &param : params) {
+    auto [path, values_str] = StringRef(param).split('=');
+    auto values = llvm::json::parse(values_str);
+    if (!values || !values->getAsArray() || values->getAsArray()->empty()) {
+      if (!values)
+        llvm::consumeError(values.takeError());
+      llvm::errs() << "sweep parameter '" << param
+                   << "' must be of the form <path>=<non-empty json array>\n";
+      return failure();
+    }
+    std::vector<SweepVariant> expanded;
+    for (auto &variant : variants) {
+      for (auto &value : *values->getAsArray()) {
+        SweepVariant v = variant;
+        if (failed(setModelField(v.model, path, value)))
+          return failure();
+        v.param_values.push_back(value);
+        expanded.push_back(std::move(v));
+      }
+    }
+    variants = std::move(expanded);
+  }
+  return success();
+}
+
+std::string toCSVField(StringRef field) {
+  if (field.find_first_of(",\"\n") == StringRef::npos)
+    return field.str();
+  std::string quoted = "\"";
+  for (char c : field) {
+    if (c == '"')
+      quoted += '"';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void writeSweepSummary(raw_ostream &os, ArrayRef<std::string> params,
+                       ArrayRef<SweepVariant> variants, StringRef format) {
+  if (format == "json") {
+    llvm::json::Array summary;
+    for (auto &variant : variants) {
+      llvm::json::Object parameters;
+      for (unsigned i = 0; i < params.size(); i++)
+        parameters[StringRef(params[i]).split('=').first] =
+            variant.param_values[i];
+      summary.push_back(llvm::json::Object{
+          {"model", variant.model_file},
+          {"parameters", std::move(parameters)},
+          {"cycles", (int64_t)variant.results.cycles},
+          {"latency_us", variant.results.latency_us},
+          {"du_utilization", variant.results.du_utilization},
+          {"tile_utilization", variant.results.tile_utilization}});
+    }
+    os << llvm::formatv("{0:2}", llvm::json::Value(std::move(summary)))
+       << "\n";
+    return;
+  }
+
+  os << "model";
+  for (auto &param : params)
+    os << "," << toCSVField(StringRef(param).split('=').first);
+  os << ",cycles,latency_us,du_utilization,tile_utilization\n";
+  for (auto &variant : variants) {
+    os << toCSVField(variant.model_file);
+    for (auto &value : variant.param_values)
+      os << "," << toCSVField(llvm::formatv("{0}", value).str());
+    os << "," << variant.results.cycles << ","
+       << llvm::formatv("{0:F3},{1:F4},{2:F4}", variant.results.latency_us,
+                        variant.results.du_utilization,
+                        variant.results.tile_utilization)
+       << "\n";
+  }
+}
+
+// Write the simulated instances and mean cycles of each op, in the format of
+// the logs read by --calibrate
+void writeOpCycles(raw_ostream &os,
+                   const xilinx::air::AIRRunnerResults &results) {
+  os << "op,instances,cycles\n";
+  for (auto &op : results.ops) {
+    double cycles = op.instances ? (double)op.cycles / op.instances : 0;
+    os << toCSVField(op.name) << "," << op.instances << ","
+       << llvm::formatv("{0:F3}", cycles) << "\n";
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Calibration
+//===----------------------------------------------------------------------===//
+
+// Instances of an op measured in calibration logs, and their total cycles
+struct MeasuredOp {
+  double instances = 0;
+  double cycles = 0;
+};
+
+// A json model field fitted by calibration, named by the keys along its path
+struct CalibrationParam {
+  std::vector<std::string> keys;
+  // Upper bound of the field, if any
+  std::optional<double> max_value;
+};
+
+// Each round of calibration tries scaling every parameter by the powers of
+// two within 4 steps of its value, then halves the step
+constexpr unsigned calibration_rounds = 8;
+constexpr int calibration_steps = 4;
+
+// Split a csv row into its fields, unquoting quoted fields
+std::vector<std::string> parseCSVRow(StringRef row) {
+  std::vector<std::string> fields(1);
+  bool quoted = false;
+  for (size_t i = 0; i < row.size(); i++) {
+    char c = row[i];
+    if (quoted && c == '"' && i + 1 < row.size() && row[i + 1] == '"') {
+      fields.back() += c;
+      i++;
+    } else if (c == '"') {
+      quoted = !quoted;
+    } else if (!quoted && c == ',') {
+      fields.emplace_back();
+    } else {
+      fields.back() += c;
+    }
+  }
+  return fields;
+}
+
+// Read a log of measured op cycles. It is a csv file with a header row naming
+// its "op" and "cycles" columns, and optionally an "instances" column
+// weighting each row. Rows of the same op are averaged.
+LogicalResult parseCalibrationLog(StringRef filename,
+                                  std::map<std::string, MeasuredOp> &ops) {
+  std::string errorMessage;
+  auto file = openInputFile(filename, &errorMessage);
+  if (!file) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+  SmallVector<StringRef> lines;
+  file->getBuffer().split(lines, '\n', -1, false);
+  std::optional<size_t> op_col, cycles_col, instances_col;
+  if (!lines.empty()) {
+    auto header = parseCSVRow(lines[0].rtrim());
+    for (size_t i = 0; i < header.size(); i++) {
+      if (header[i] == "op")
+        op_col = i;
+      else if (header[i] == "cycles")
+        cycles_col = i;
+      else if (header[i] == "instances")
+        instances_col = i;
+    }
+  }
+  if (!op_col || !cycles_col) {
+    llvm::errs() << "calibration log " << filename
+                 << " must have a header row with op and cycles columns\n";
+    return failure();
+  }
+  for (unsigned l = 1; l < lines.size(); l++) {
+    auto row = parseCSVRow(lines[l].rtrim());
+    double cycles, instances = 1;
+    if (row.size() <= std::max(*op_col, *cycles_col) ||
+        StringRef(row[*cycles_col]).trim().getAsDouble(cycles) ||
+        (instances_col && (row.size() <= *instances_col ||
+                           StringRef(row[*instances_col])
+                               .trim()
+                               .getAsDouble(instances)))) {
+      llvm::errs() << filename << ":" << l + 1 << ": malformed row\n";
+      return failure();
+    }
+    auto &op = ops[row[*op_col]];
+    op.instances += instances;
+    op.cycles += instances * cycles;
+  }
+  return success();
+}
+
+// Port bandwidths and kernel efficiencies of a json model
+std::vector<CalibrationParam> getCalibrationParams(llvm::json::Value &model) {
+  std::vector<CalibrationParam> params;
+  auto addPorts = [&](std::vector<std::string> keys,
+                      llvm::json::Object *ports) {
+    for (auto direction : {"inbound", "outbound"}) {
+      auto port = ports ? ports->getObject(direction) : nullptr;
+      if (!port || !port->getNumber("bytes_per_second"))
+        continue;
+      auto param_keys = keys;
+      param_keys.push_back(direction);
+      param_keys.push_back("bytes_per_second");
+      params.push_back({param_keys, std::nullopt});
+    }
+  };
+  auto root = model.getAsObject();
+  addPorts({"noc"}, root->getObject("noc"));
+  if (auto dus = root->getObject("dus")) {
+    addPorts({"dus", "ports"}, dus->getObject("ports"));
+    if (auto tiles = dus->getObject("tiles"))
+      addPorts({"dus", "tiles", "ports"}, tiles->getObject("ports"));
+  }
+  // Json objects are unordered, so list kernels by name
+  std::vector<CalibrationParam> efficiencies;
+  if (auto kernels = root->getObject("kernels")) {
+    for (auto &kernel : *kernels) {
+      auto kernel_obj = kernel.second.getAsObject();
+      auto datatypes =
+          kernel_obj ? kernel_obj->getObject("datatypes") : nullptr;
+      if (!datatypes)
+        continue;
+      for (auto &datatype : *datatypes) {
+        auto datatype_obj = datatype.second.getAsObject();
+        if (datatype_obj && datatype_obj->getNumber("efficiency"))
+          efficiencies.push_back({{"kernels", kernel.first.str(), "datatypes",
+                                   datatype.first.str(), "efficiency"},
+                                  1.0});
+      }
+    }
+  }
+  std::sort(efficiencies.begin(), efficiencies.end(),
+            [](auto &a, auto &b) { return a.keys < b.keys; });
+  params.insert(params.end(), efficiencies.begin(), efficiencies.end());
+  return params;
+}
+
+llvm::json::Value *getModelField(llvm::json::Value &model,
+                                 ArrayRef<std::string> keys) {
+  llvm::json::Object *object = model.getAsObject();
+  for (unsigned i = 0; object && i + 1 < keys.size(); i++)
+    object = object->getObject(keys[i]);
+  return object ? object->get(keys.back()) : nullptr;
+}
+
+// Weighted mean of the squared log ratios between the simulated and measured
+// cycles of the ops
+double getCalibrationError(const xilinx::air::AIRRunnerResults &results,
+                           const std::map<std::string, MeasuredOp> &measured) {
+  double error = 0, weight = 0;
+  for (auto &op : results.ops) {
+    auto it = measured.find(op.name);
+    if (it == measured.end() || !op.instances || !it->second.instances)
+      continue;
+    // Ops may take no cycles
+    double ratio =
+        std::log(((double)op.cycles / op.instances + 1) /
+                 (it->second.cycles / it->second.instances + 1));
+    error += it->second.instances * ratio * ratio;
+    weight += it->second.instances;
+  }
+  return weight ? error / weight : 0;
+}
+
+// Fit the port bandwidths and kernel efficiencies of a json model to measured
+// op cycles, by coordinate descent over power-of-two scalings of each field.
+// The scalings tried for a field are simulated in parallel.
+LogicalResult calibrateModel(
+    MLIRContext *context, llvm::json::Value &model,
+    const std::map<std::string, MeasuredOp> &measured,
+    llvm::function_ref<xilinx::air::AIRRunnerResults(llvm::json::Value &)>
+        simulate) {
+  auto initial = simulate(model);
+  unsigned matched = 0;
+  for (auto &op : initial.ops)
+    matched += measured.count(op.name);
+  if (!matched) {
+    llvm::errs() << "no measured op was simulated\n";
+    return failure();
+  }
+  for (auto &entry : measured) {
+    if (llvm::none_of(initial.ops,
+                      [&](auto &op) { return op.name == entry.first; }))
+      llvm::errs() << "warning: measured op " << entry.first
+                   << " was not simulated\n";
+  }
+
+  struct Candidate {
+    int step;
+    double value;
+    llvm::json::Value model;
+    double error;
+  };
+  double error = getCalibrationError(initial, measured);
+  auto params = getCalibrationParams(model);
+  double step = 1;
+  for (unsigned round = 0; round < calibration_rounds; round++, step /= 2) {
+    for (auto &param : params) {
+      double value = *getModelField(model, param.keys)->getAsNumber();
+      // Try the smallest changes first, so that ties keep them
+      std::vector<Candidate> candidates;
+      for (int k = 1; k <= calibration_steps; k++) {
+        for (int sign : {-1, 1}) {
+          double v = value * std::exp2(sign * k * step);
+          if (param.max_value)
+            v = std::min(v, *param.max_value);
+          if (v != value)
+            candidates.push_back({sign * k, v, model, 0});
+        }
+      }
+      parallelForEach(context, candidates, [&](Candidate &candidate) {
+        *getModelField(candidate.model, param.keys) = candidate.value;
+        candidate.error =
+            getCalibrationError(simulate(candidate.model), measured);
+      });
+      for (auto &candidate : candidates) {
+        if (candidate.error < error) {
+          error = candidate.error;
+          value = candidate.value;
+        }
+      }
+      *getModelField(model, param.keys) = value;
+    }
+    LLVM_DEBUG(llvm::dbgs() << "calibration round " << round << ": error "
+                            << error << "\n");
+  }
+  return success();
+}
+
 LogicalResult run(int argc, char **argv, llvm::StringRef toolName) {
 
   static llvm::cl::opt<std::string> inputFilename(
@@ -61,8 +439,88 @@ LogicalResult run(int argc, char **argv, llvm::StringRef toolName) {
                                        llvm::cl::value_desc("bool"),
                                        llvm::cl::init(false));
 
+  static llvm::cl::opt<bool> clFullSimulation(
+      "full-sim",
+      llvm::cl::desc("simulate every air.launch iteration instead of "
+                     "extrapolating once a steady state is reached"),
+      llvm::cl::init(false));
+
+  static llvm::cl::opt<bool> clFoldCores(
+      "fold-cores",
+      llvm::cl::desc("simulate one core per class of symmetric cores in each "
+                     "herd, when simulating cores"),
+      llvm::cl::init(false));
+
+  static llvm::cl::opt<bool> clParallelSegments(
+      "parallel-segments",
+      llvm::cl::desc("simulate independent air.segment subtrees of a launch "
+                     "in parallel"),
+      llvm::cl::init(false));
+
+  static llvm::cl::opt<std::string> clTraceFormat(
+      "trace-format",
+      llvm::cl::desc("format of the output trace (pick from json, compact and "
+                     "perfetto)"),
+      llvm::cl::value_desc("string"), llvm::cl::init("json"));
+
+  static llvm::cl::opt<std::string> clTraceLevel(
+      "trace-level",
+      llvm::cl::desc("events written to the output trace (pick from none, "
+                     "hierarchy and all)"),
+      llvm::cl::value_desc("string"), llvm::cl::init("all"));
+
+  static llvm::cl::list<std::string> clSweepModels(
+      "sweep-model",
+      llvm::cl::desc("json model to evaluate in a design-space sweep (may be "
+                     "repeated)"),
+      llvm::cl::value_desc("filename"), llvm::cl::CommaSeparated);
+
+  static llvm::cl::list<std::string> clSweepParams(
+      "sweep-param",
+      llvm::cl::desc("sweep a json model field over a json array of values, "
+                     "e.g. 'dus.count=[[4,4],[8,4]]' (may be repeated)"),
+      llvm::cl::value_desc("path=values"));
+
+  static llvm::cl::opt<std::string> clSweepFormat(
+      "sweep-format",
+      llvm::cl::desc("format of the sweep summary (pick from csv and json)"),
+      llvm::cl::value_desc("string"), llvm::cl::init("csv"));
+
+  static llvm::cl::opt<std::string> clReportFormat(
+      "report",
+      llvm::cl::desc("write a resource utilization, channel stall, data "
+                     "movement and critical path report (pick from json)"),
+      llvm::cl::value_desc("string"), llvm::cl::init(""));
+
+  static llvm::cl::opt<std::string> clReportFilename(
+      "report-file", llvm::cl::desc("Report output filename"),
+      llvm::cl::value_desc("filename"), llvm::cl::init("-"));
+
+  static llvm::cl::list<std::string> clCalibrate(
+      "calibrate",
+      llvm::cl::desc("fit the port bandwidths and kernel efficiencies of the "
+                     "json model to the op cycles measured in a csv log (may "
+                     "be repeated), writing the fitted model to the output "
+                     "file"),
+      llvm::cl::value_desc("filename"), llvm::cl::CommaSeparated);
+
+  static llvm::cl::opt<std::string> clOpCyclesFilename(
+      "op-cycles-file",
+      llvm::cl::desc("write the simulated cycles of each op as a csv log"),
+      llvm::cl::value_desc("filename"), llvm::cl::init(""));
+
   llvm::InitLLVM y(argc, argv);
-  llvm::cl::ParseCommandLineOptions(argc, argv, toolName);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv,
+      (toolName + "\n\n"
+                  "Each air.launch runs on one of the \"num_devices\" devices "
+                  "of the json model\n"
+                  "once the launches it depends on have ended. Launches "
+                  "assigned to the same\n"
+                  "device run one after the other, even when the device has "
+                  "the resources to\n"
+                  "run them concurrently.\n")
+          .str());
 
   verbose = clVerbose;
   sim_granularity = clSimGranularity;
@@ -76,12 +534,57 @@ LogicalResult run(int argc, char **argv, llvm::StringRef toolName) {
     return failure();
   }
 
-  auto json_file = openInputFile(jsonFileName, &errorMessage);
-  if (!json_file) {
-    llvm::errs() << errorMessage << "\n";
+  // In a sweep, the json models to evaluate are the listed models, or the model
+  // given by -m, each expanded over the sweep parameter grid
+  bool sweep = !clSweepModels.empty() || !clSweepParams.empty();
+  if (sweep && clSweepFormat != "csv" && clSweepFormat != "json") {
+    llvm::errs() << "unknown sweep summary format " << clSweepFormat << "\n";
     return failure();
   }
 
+  if (clTraceFormat != "json" && clTraceFormat != "compact" &&
+      clTraceFormat != "perfetto") {
+    llvm::errs() << "unknown trace format " << clTraceFormat << "\n";
+    return failure();
+  }
+  if (clTraceLevel != "none" && clTraceLevel != "hierarchy" &&
+      clTraceLevel != "all") {
+    llvm::errs() << "unknown trace level " << clTraceLevel << "\n";
+    return failure();
+  }
+
+  if (!clReportFormat.empty() && clReportFormat != "json") {
+    llvm::errs() << "unknown report format " << clReportFormat << "\n";
+    return failure();
+  }
+  if (sweep && !clReportFormat.empty()) {
+    llvm::errs() << "reports are not written in a sweep\n";
+    return failure();
+  }
+
+  bool calibrate = !clCalibrate.empty();
+  if (calibrate && sweep) {
+    llvm::errs() << "a model cannot be calibrated in a sweep\n";
+    return failure();
+  }
+  if ((sweep || calibrate) && !clOpCyclesFilename.empty()) {
+    llvm::errs() << "op cycles are only written by a simulation\n";
+    return failure();
+  }
+  std::map<std::string, MeasuredOp> measured_ops;
+  for (auto &log : clCalibrate)
+    if (failed(parseCalibrationLog(log, measured_ops)))
+      return failure();
+
+  std::unique_ptr<llvm::MemoryBuffer> json_file;
+  if (!sweep) {
+    json_file = openInputFile(jsonFileName, &errorMessage);
+    if (!json_file) {
+      llvm::errs() << errorMessage << "\n";
+      return failure();
+    }
+  }
+
   auto output = openOutputFile(outputFilename, &errorMessage);
   if (!output) {
     llvm::errs() << errorMessage << "\n";
@@ -112,6 +615,63 @@ LogicalResult run(int argc, char **argv, llvm::StringRef toolName) {
       return failure();
     }
 
+    if (sweep) {
+      auto toplevel = module->lookupSymbol<func::FuncOp>(topLevelFunction);
+      if (!toplevel)
+        llvm_unreachable("Function not supported.\n");
+
+      std::vector<std::string> model_files(clSweepModels.begin(),
+                                           clSweepModels.end());
+      if (model_files.empty())
+        model_files.push_back(jsonFileName);
+      std::vector<std::string> params(clSweepParams.begin(),
+                                      clSweepParams.end());
+      std::vector<SweepVariant> variants;
+      if (failed(buildSweepVariants(model_files, params, variants)))
+        return failure();
+
+      // Parse and canonicalize the dependency graphs once, then simulate every
+      // variant against them in parallel. Traces are not written in a sweep.
+      xilinx::air::AIRRunnerProgram program(toplevel, sim_granularity,
+                                            clFoldCores);
+      parallelForEach(&context, variants, [&](SweepVariant &variant) {
+        xilinx::air::AIRRunner runner(
+            llvm::nulls(), variant.model, sim_granularity, false,
+            clFullSimulation, clParallelSegments, "json", "none",
+            clFoldCores);
+        runner.scheduleFunction(program);
+        variant.results = runner.getResults();
+      });
+
+      writeSweepSummary(os, params, variants, clSweepFormat);
+      return success();
+    }
+
+    if (calibrate) {
+      auto toplevel = module->lookupSymbol<func::FuncOp>(topLevelFunction);
+      if (!toplevel)
+        llvm_unreachable("Function not supported.\n");
+
+      llvm::json::Value model = nullptr;
+      if (failed(parseModelFile(jsonFileName, model)))
+        return failure();
+
+      xilinx::air::AIRRunnerProgram program(toplevel, sim_granularity,
+                                            clFoldCores);
+      auto simulate = [&](llvm::json::Value &candidate) {
+        xilinx::air::AIRRunner runner(
+            llvm::nulls(), candidate, sim_granularity, false,
+            clFullSimulation, clParallelSegments, "json", "none",
+            clFoldCores);
+        runner.scheduleFunction(program);
+        return runner.getResults();
+      };
+      if (failed(calibrateModel(&context, model, measured_ops, simulate)))
+        return failure();
+      os << llvm::formatv("{0:2}", model) << "\n";
+      return success();
+    }
+
     // We need three things in a function-type independent way.
     // The type signature of the function.
     FunctionType ftype;
@@ -124,7 +684,9 @@ LogicalResult run(int argc, char **argv, llvm::StringRef toolName) {
     if (!jsonModel)
       llvm_unreachable("failed to parse model json\n");
 
-    xilinx::air::AIRRunner runner(os, *jsonModel, sim_granularity, clVerbose);
+    xilinx::air::AIRRunner runner(os, *jsonModel, sim_granularity, clVerbose,
+                                  clFullSimulation, clParallelSegments,
+                                  clTraceFormat, clTraceLevel, clFoldCores);
 
     // The number of inputs to the function in the IR.
     unsigned numInputs = 0;
@@ -154,6 +716,29 @@ LogicalResult run(int argc, char **argv, llvm::StringRef toolName) {
       runner.scheduleFunction(toplevel);
     }
     runner.emitTraceEnd(os);
+
+    if (!clReportFormat.empty()) {
+      // The report may share stdout with the trace
+      os.flush();
+      auto report = openOutputFile(clReportFilename, &errorMessage);
+      if (!report) {
+        llvm::errs() << errorMessage << "\n";
+        return failure();
+      }
+      xilinx::air::writeRunnerReport(report->os(), runner.getResults());
+      report->keep();
+    }
+
+    if (!clOpCyclesFilename.empty()) {
+      os.flush();
+      auto op_cycles = openOutputFile(clOpCyclesFilename, &errorMessage);
+      if (!op_cycles) {
+        llvm::errs() << errorMessage << "\n";
+        return failure();
+      }
+      writeOpCycles(op_cycles->os(), runner.getResults());
+      op_cycles->keep();
+    }
     return success();
   };
   if (failed(processBuffer(std::move(input), output->os())))
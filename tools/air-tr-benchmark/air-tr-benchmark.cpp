@@ -0,0 +1,287 @@
+//===- air-tr-benchmark.cpp -------------------------------------*- C++ -*-===//
+//
+// Copyright (C) 2023, Advanced Micro Devices, Inc. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+//===----------------------------------------------------------------------===//
+
+// Time and memory of the transitive reduction of synthetic async token graphs,
+// with xilinx::air::transitiveReduction and boost::transitive_reduction. Each
+// measurement runs in a forked process, so that its peak resident memory is
+// not hidden by earlier ones. With --verify, the edges kept by both are
+// compared instead, on random DAGs whose vertices are shuffled.
+
+#include "air/Util/TransitiveReduction.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define BOOST_NO_EXCEPTIONS
+#include <boost/throw_exception.hpp>
+void boost::throw_exception(std::exception const &e) {
+  llvm_unreachable("boost exception");
+}
+#if BOOST_VERSION >= 107300
+void boost::throw_exception(std::exception const &e,
+                            boost::source_location const &) {
+  llvm_unreachable("boost exception");
+}
+#endif
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/transitive_reduction.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace llvm;
+
+static cl::list<unsigned>
+    clVertices("vertices", cl::desc("Number of vertices of each graph"),
+               cl::CommaSeparated);
+
+static cl::opt<unsigned>
+    clDegree("degree", cl::desc("Dependencies of each vertex"), cl::init(4));
+
+static cl::opt<unsigned> clWindow(
+    "window",
+    cl::desc("Dependencies are drawn among the previous <window> vertices"),
+    cl::init(64));
+
+static cl::opt<unsigned> clBudget(
+    "budget-mb", cl::desc("Memory budget of the reachability bitsets, in MiB"),
+    cl::init(xilinx::air::defaultTransitiveReductionBudget >> 20));
+
+static cl::opt<unsigned> clBudgetBytes(
+    "budget-bytes",
+    cl::desc("Memory budget of the reachability bitsets, in bytes, overriding "
+             "--budget-mb. Small budgets split the graph into many chunks."),
+    cl::init(0));
+
+static cl::opt<unsigned>
+    clBoostMaxVertices("boost-max-vertices",
+                       cl::desc("Largest graph to reduce with "
+                                "boost::transitive_reduction"),
+                       cl::init(20000));
+
+static cl::opt<unsigned> clSeed("seed", cl::desc("Random seed"), cl::init(1));
+
+static cl::opt<bool>
+    clVerify("verify",
+             cl::desc("Check that the edges kept match those of "
+                      "boost::transitive_reduction instead of timing"),
+             cl::init(false));
+
+static cl::opt<unsigned>
+    clVerifyGraphs("verify-graphs",
+                   cl::desc("Random graphs of each size to verify"),
+                   cl::init(8));
+
+namespace {
+
+typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS>
+    Graph;
+
+// Each vertex depends on up to `degree` vertices among the `window` before it,
+// and on the vertex right before it, as ops of an unrolled loop body do
+Graph createGraph(unsigned num_vertices) {
+  Graph g(num_vertices);
+  std::mt19937 rng(clSeed);
+  for (unsigned v = 1; v < num_vertices; v++) {
+    add_edge(v - 1, v, g);
+    unsigned window = std::min(v, (unsigned)clWindow);
+    std::uniform_int_distribution<unsigned> dist(v - window, v - 1);
+    for (unsigned d = 1; d < clDegree; d++)
+      add_edge(dist(rng), v, g);
+  }
+  return g;
+}
+
+// A random DAG like createGraph's, without the chain through all vertices, so
+// that it may have several sources and components. Vertices are shuffled so
+// that the topological order differs from the vertex order, and edges,
+// including repeated ones, are added in a random order.
+Graph createShuffledGraph(unsigned num_vertices, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<unsigned> label(num_vertices);
+  std::iota(label.begin(), label.end(), 0u);
+  std::shuffle(label.begin(), label.end(), rng);
+  std::vector<std::pair<unsigned, unsigned>> edges;
+  for (unsigned v = 1; v < num_vertices; v++) {
+    unsigned window = std::min(v, (unsigned)clWindow);
+    std::uniform_int_distribution<unsigned> dist(v - window, v - 1);
+    std::uniform_int_distribution<unsigned> degree(0, clDegree);
+    for (unsigned d = degree(rng); d > 0; d--)
+      edges.push_back({label[dist(rng)], label[v]});
+  }
+  std::shuffle(edges.begin(), edges.end(), rng);
+  Graph g(num_vertices);
+  for (auto &e : edges)
+    add_edge(e.first, e.second, g);
+  return g;
+}
+
+size_t getBudget() {
+  return clBudgetBytes ? (size_t)clBudgetBytes : (size_t)clBudget << 20;
+}
+
+// Targets of the edges out of each vertex of `g` kept in `tr`, in the order
+// they were added
+std::vector<std::vector<Graph::vertex_descriptor>> getKeptEdges(
+    const Graph &g, const Graph &tr,
+    std::map<Graph::vertex_descriptor, Graph::vertex_descriptor> &g_to_tr) {
+  std::vector<Graph::vertex_descriptor> tr_to_g(num_vertices(tr));
+  for (auto &entry : g_to_tr)
+    tr_to_g[entry.second] = entry.first;
+  std::vector<std::vector<Graph::vertex_descriptor>> kept(num_vertices(g));
+  for (auto v : boost::make_iterator_range(vertices(tr)))
+    for (auto e : boost::make_iterator_range(out_edges(v, tr)))
+      kept[tr_to_g[v]].push_back(tr_to_g[target(e, tr)]);
+  return kept;
+}
+
+// Reduce random graphs of `num_vertices` vertices with both implementations,
+// and compare the edges they keep
+bool verify(unsigned num_vertices) {
+  uint64_t edges = 0, kept_edges = 0;
+  for (unsigned i = 0; i < clVerifyGraphs; i++) {
+    Graph g = createShuffledGraph(num_vertices, clSeed + i);
+    edges += num_edges(g);
+
+    Graph air_tr, boost_tr;
+    std::map<Graph::vertex_descriptor, Graph::vertex_descriptor> air_g_to_tr,
+        boost_g_to_tr;
+    xilinx::air::transitiveReduction(g, air_tr, air_g_to_tr, getBudget());
+    std::vector<size_t> id_map(num_vertices);
+    std::iota(id_map.begin(), id_map.end(), 0u);
+    boost::transitive_reduction(g, boost_tr,
+                                boost::make_assoc_property_map(boost_g_to_tr),
+                                id_map.data());
+    kept_edges += num_edges(air_tr);
+
+    if (getKeptEdges(g, air_tr, air_g_to_tr) !=
+        getKeptEdges(g, boost_tr, boost_g_to_tr)) {
+      errs() << "edges kept differ from boost on " << num_vertices
+             << " vertices with seed " << clSeed + i << "\n";
+      return false;
+    }
+  }
+  outs() << formatv("{0,10} {1,8} {2,10} {3,10} {4,8}\n", num_vertices,
+                    clVerifyGraphs, edges, kept_edges, "match");
+  return true;
+}
+
+struct measurement {
+  uint64_t edges = 0;
+  uint64_t kept_edges = 0;
+  double seconds = 0;
+  // Peak resident memory grown by the reduction, in KiB
+  long memory_kb = 0;
+};
+
+long getPeakMemoryKB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+measurement measure(unsigned num_vertices, bool use_boost) {
+  measurement result;
+  Graph g = createGraph(num_vertices);
+  result.edges = num_edges(g);
+  long memory_before = getPeakMemoryKB();
+  auto start = std::chrono::steady_clock::now();
+  Graph tr;
+  std::map<Graph::vertex_descriptor, Graph::vertex_descriptor> g_to_tr;
+  if (use_boost) {
+    std::vector<size_t> id_map(num_vertices);
+    std::iota(id_map.begin(), id_map.end(), 0u);
+    boost::transitive_reduction(g, tr, boost::make_assoc_property_map(g_to_tr),
+                                id_map.data());
+  } else {
+    xilinx::air::transitiveReduction(g, tr, g_to_tr, getBudget());
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  result.memory_kb = getPeakMemoryKB() - memory_before;
+  result.kept_edges = num_edges(tr);
+  return result;
+}
+
+// Run a measurement in a child process
+bool measureInChild(unsigned num_vertices, bool use_boost,
+                    measurement &result) {
+  int fds[2];
+  if (pipe(fds))
+    return false;
+  pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0) {
+    close(fds[0]);
+    measurement child_result = measure(num_vertices, use_boost);
+    bool written = write(fds[1], &child_result, sizeof(child_result)) ==
+                   sizeof(child_result);
+    _exit(written ? 0 : 1);
+  }
+  close(fds[1]);
+  bool read_ok = read(fds[0], &result, sizeof(result)) == sizeof(result);
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return read_ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  InitLLVM y(argc, argv);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "AIR dependency graph transitive reduction "
+                              "benchmark\n");
+
+  std::vector<unsigned> sizes(clVertices.begin(), clVertices.end());
+  if (clVerify) {
+    if (sizes.empty())
+      sizes = {100, 1000, 5000};
+    outs() << formatv("{0,10} {1,8} {2,10} {3,10} {4,8}\n", "vertices",
+                      "graphs", "edges", "kept", "result");
+    for (unsigned size : sizes)
+      if (!verify(size))
+        return 1;
+    return 0;
+  }
+  if (sizes.empty())
+    sizes = {10000, 100000, 1000000};
+
+  outs() << formatv("{0,-8} {1,10} {2,10} {3,10} {4,10} {5,12}\n", "impl",
+                    "vertices", "edges", "kept", "seconds", "memory_kb");
+  for (unsigned size : sizes) {
+    for (bool use_boost : {false, true}) {
+      if (use_boost && size > clBoostMaxVertices)
+        continue;
+      measurement result;
+      if (!measureInChild(size, use_boost, result)) {
+        errs() << "measurement of " << size << " vertices failed\n";
+        return 1;
+      }
+      outs() << formatv("{0,-8} {1,10} {2,10} {3,10} {4,10:f3} {5,12}\n",
+                        use_boost ? "boost" : "air", size, result.edges,
+                        result.kept_edges, result.seconds, result.memory_kb);
+    }
+  }
+  return 0;
+}